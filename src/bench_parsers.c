@@ -0,0 +1,345 @@
+/**
+ * @file bench_parsers.c  feed parser benchmark
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Standalone benchmark for feed_parse(). It never initializes GTK,
+   the DB or the network and only runs the XML, date, metadata and
+   feed parser code paths on the given corpus files. Files ending in
+   ".json" are Google Reader API stream contents and are run through
+   json_api_get_items() as the online sources do (format "json-api").
+
+   Output is one tab separated line per feed format:
+
+     format files bytes items items/s bytes/s peak_rss_kb
+
+   preceded by a header line starting with '#'. The format is kept
+   stable so runs can be compared by scripts. Each file is parsed in
+   a child process, so peak_rss_kb is the largest peak RSS of the
+   files of a format and not inflated by the files parsed before.
+   Allocations are best counted by running it under valgrind
+   ("make bench-parsers-memcheck"). */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "debug.h"
+#include "feed.h"
+#include "feed_parser.h"
+#include "item.h"
+#include "fl_sources/json_api_mapper.h"
+#include "node.h"
+#include "subscription.h"
+#include "xml.h"
+
+#define BENCH_DEFAULT_ITERATIONS	100
+
+typedef struct benchResult {
+	gchar		*format;	/**< feed format label (owned by the result hash) */
+	guint		files;		/**< number of corpus files */
+	guint64		bytes;		/**< total bytes parsed */
+	guint64		items;		/**< total items parsed */
+	gint64		usecs;		/**< total parsing time */
+	glong		maxrss;		/**< largest peak RSS of a single file (in kB) */
+} *benchResultPtr;
+
+/* What the child process parsing a single file reports back */
+typedef struct benchFileResult {
+	gchar		format[32];	/**< feed format label (empty on error) */
+	guint64		bytes;		/**< bytes parsed in all iterations */
+	guint64		items;		/**< items parsed in all iterations */
+	gint64		usecs;		/**< parsing time of all iterations */
+	glong		maxrss;		/**< peak RSS of the child (in kB) */
+} benchFileResult;
+
+/* main.c is not linked, the UI library still refers to this */
+void
+liferea_shutdown (void)
+{
+	exit (0);
+}
+
+/* RSS covers several versions, so label it more specifically */
+static gchar *
+bench_get_format (feedParserCtxtPtr ctxt)
+{
+	const gchar	*type = feed_type_fhp_to_str (ctxt->feed->fhp);
+	const gchar	*version;
+
+	if (!type)
+		return g_strdup ("unknown");
+
+	if (!g_str_equal (type, "rss"))
+		return g_strdup (type);
+
+	if (strstr (ctxt->data, "<rdf:RDF") || strstr (ctxt->data, "<RDF"))
+		return g_strdup ("rss-1.0");
+
+	version = strstr (ctxt->data, "<rss version=");
+	if (version) {
+		version += strlen ("<rss version=") + 1;
+		return g_strdup_printf ("rss-%.*s", (int)strcspn (version, "\"'"), version);
+	}
+
+	return g_strdup ("rss");
+}
+
+/* Parses the data once and returns the number of items (or -1 on error) */
+static gint
+bench_parse_once (gchar *data, gsize length, const gchar *source, gchar **format)
+{
+	feedParserCtxtPtr	ctxt;
+	subscriptionPtr		subscription;
+	nodePtr			node;
+	gint			items = -1;
+	GList			*iter;
+
+	/* Not using subscription_new() as it would schedule feed list saves */
+	subscription = g_new0 (struct subscription, 1);
+	subscription->source = g_strdup (source);
+
+	/* The node owns feed and subscription, so node_free() frees both */
+	node = node_new (feed_get_node_type ());
+	node_set_data (node, feed_new ());
+	node->subscription = subscription;
+	subscription->node = node;
+
+	ctxt = feed_create_parser_ctxt ();
+	ctxt->subscription = subscription;
+	ctxt->feed = (feedPtr)node->data;
+	ctxt->data = data;
+	ctxt->dataLength = length;
+
+	if (feed_parse (ctxt)) {
+		items = g_list_length (ctxt->items);
+		if (format && !*format)
+			*format = bench_get_format (ctxt);
+	}
+
+	for (iter = ctxt->items; iter; iter = g_list_next (iter))
+		item_unload ((itemPtr)iter->data);
+	g_list_free (ctxt->items);
+
+	feed_free_parser_ctxt (ctxt);
+	node_free (node);
+
+	return items;
+}
+
+/* Maps a Google Reader API stream like the online sources do
+   and returns the number of items (or -1 on error) */
+static gint
+bench_json_once (gchar *data, gsize length, const gchar *source, gchar **format)
+{
+	jsonApiMapping	mapping;
+	GList		*items, *iter;
+	gint		count;
+
+	mapping.id		= "id";
+	mapping.title		= "title";
+	mapping.link		= NULL;
+	mapping.description	= "summary/content";
+	mapping.read		= NULL;
+	mapping.updated		= "published";
+	mapping.author		= "author";
+	mapping.flag		= NULL;
+	mapping.xhtml		= TRUE;
+	mapping.negateRead	= FALSE;
+
+	items = json_api_get_items (data, "items", &mapping, NULL);
+	if (!items)
+		return -1;
+
+	count = g_list_length (items);
+	if (format && !*format)
+		*format = g_strdup ("json-api");
+
+	for (iter = items; iter; iter = g_list_next (iter))
+		item_unload ((itemPtr)iter->data);
+	g_list_free (items);
+
+	return count;
+}
+
+typedef gint (*benchParseFunc)(gchar *data, gsize length, const gchar *source, gchar **format);
+
+/* Runs in the child process, the result is written to the given pipe */
+static void
+bench_parse_file (const gchar *filename, guint iterations, gint fd)
+{
+	benchFileResult	result;
+	benchParseFunc	parse = bench_parse_once;
+	struct rusage	usage;
+	gchar		*data, *source, *format = NULL;
+	gsize		length;
+	gint64		start;
+	GError		*error = NULL;
+	guint		i;
+
+	memset (&result, 0, sizeof (result));
+
+	if (!g_file_get_contents (filename, &data, &length, &error)) {
+		g_printerr ("%s: %s\n", filename, error->message);
+		g_error_free (error);
+		return;
+	}
+
+	source = g_strdup_printf ("file://%s", filename);
+	if (g_str_has_suffix (filename, ".json"))
+		parse = bench_json_once;
+
+	/* warm up and detect the format */
+	if (parse (data, length, source, &format) < 0) {
+		g_printerr ("%s: could not parse feed\n", filename);
+	} else {
+		start = g_get_monotonic_time ();
+		for (i = 0; i < iterations; i++)
+			result.items += parse (data, length, source, NULL);
+		result.usecs = g_get_monotonic_time () - start;
+		result.bytes = (guint64)length * iterations;
+
+		getrusage (RUSAGE_SELF, &usage);
+		result.maxrss = usage.ru_maxrss;
+		g_strlcpy (result.format, format, sizeof (result.format));
+	}
+
+	if (write (fd, &result, sizeof (result)) != sizeof (result))
+		g_printerr ("%s: could not report results\n", filename);
+
+	g_free (format);
+	g_free (source);
+	g_free (data);
+}
+
+static void
+bench_run_file (const gchar *filename, guint iterations, GHashTable *results)
+{
+	benchFileResult	fileResult;
+	benchResultPtr	result;
+	gint		fds[2];
+	pid_t		pid;
+	gssize		len;
+
+	if (pipe (fds) < 0) {
+		g_printerr ("%s: could not create pipe\n", filename);
+		return;
+	}
+
+	fflush (stdout);
+	pid = fork ();
+	if (pid < 0) {
+		g_printerr ("%s: could not fork\n", filename);
+		close (fds[0]);
+		close (fds[1]);
+		return;
+	}
+
+	if (pid == 0) {
+		close (fds[0]);
+		bench_parse_file (filename, iterations, fds[1]);
+		_exit (0);
+	}
+
+	close (fds[1]);
+	len = read (fds[0], &fileResult, sizeof (fileResult));
+	close (fds[0]);
+	waitpid (pid, NULL, 0);
+
+	if (len != sizeof (fileResult) || !fileResult.format[0])
+		return;
+
+	result = g_hash_table_lookup (results, fileResult.format);
+	if (!result) {
+		result = g_new0 (struct benchResult, 1);
+		result->format = g_strdup (fileResult.format);
+		g_hash_table_insert (results, result->format, result);
+	}
+
+	result->files++;
+	result->bytes += fileResult.bytes;
+	result->usecs += fileResult.usecs;
+	result->items += fileResult.items;
+	result->maxrss = MAX (result->maxrss, fileResult.maxrss);
+}
+
+static gint
+bench_result_cmp (gconstpointer a, gconstpointer b)
+{
+	return strcmp (((benchResultPtr)a)->format, ((benchResultPtr)b)->format);
+}
+
+static void
+bench_print_results (GHashTable *results)
+{
+	GList		*list, *iter;
+
+	g_print ("# format\tfiles\tbytes\titems\titems/s\tbytes/s\tpeak_rss_kb\n");
+
+	list = g_list_sort (g_hash_table_get_values (results), bench_result_cmp);
+	for (iter = list; iter; iter = g_list_next (iter)) {
+		benchResultPtr	result = (benchResultPtr)iter->data;
+		gdouble		secs = MAX (result->usecs, 1) / (gdouble)G_USEC_PER_SEC;
+
+		g_print ("%s\t%u\t%" G_GUINT64_FORMAT "\t%" G_GUINT64_FORMAT "\t%.0f\t%.0f\t%ld\n",
+		         result->format,
+		         result->files,
+		         result->bytes,
+		         result->items,
+		         result->items / secs,
+		         result->bytes / secs,
+		         result->maxrss);
+	}
+	g_list_free (list);
+}
+
+int
+main (int argc, char *argv[])
+{
+	GHashTable	*results;
+	guint		iterations = BENCH_DEFAULT_ITERATIONS;
+	gint		i = 1;
+
+	if (argc > 2 && g_str_equal (argv[1], "-n")) {
+		iterations = (guint)common_parse_long (argv[2], BENCH_DEFAULT_ITERATIONS);
+		i = 3;
+	}
+
+	if (i >= argc) {
+		g_printerr ("Usage: %s [-n iterations] FILE...\n", argv[0]);
+		return 1;
+	}
+
+	xml_init ();
+
+	results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	for (; i < argc; i++)
+		bench_run_file (argv[i], iterations, results);
+
+	bench_print_results (results);
+	g_hash_table_destroy (results);
+
+	return 0;
+}
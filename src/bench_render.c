@@ -0,0 +1,247 @@
+/**
+ * @file bench_render.c  item renderer parity check and benchmark
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Standalone check and benchmark for the item renderers. It parses
+   the given corpus feeds without DB, GTK or network, then
+
+     1. renders every item with both item_render_xslt() and
+        item_render_native() for all view modes and fails (exit
+        code 1) if the output differs, and
+     2. measures the rendering throughput of both renderers.
+
+   Output is one tab separated line per renderer:
+
+     renderer items items/s
+
+   preceded by a header line starting with '#' and followed by a
+   '# speedup' line. The format is kept stable so runs can be compared
+   by scripts. Run it in the C locale, the native renderer does not
+   add the xml:lang attribute of translated labels. */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "feed.h"
+#include "feed_parser.h"
+#include "item.h"
+#include "item_render.h"
+#include "metadata.h"
+#include "node.h"
+#include "render.h"
+#include "subscription.h"
+#include "xml.h"
+
+#define BENCH_DEFAULT_ITERATIONS	100
+
+typedef gchar * (*benchRenderFunc)(itemPtr item, nodePtr node, itemRenderParamsPtr params);
+
+/* the view modes: 2 pane, 3 pane, summary and merged item sets */
+static struct itemRenderParams benchParams[] = {
+	{ "http://localhost/", FALSE, FALSE, FALSE, "ltr", "ltr" },
+	{ "http://localhost/", FALSE, FALSE, TRUE,  "ltr", "ltr" },
+	{ "http://localhost/", TRUE,  FALSE, FALSE, "ltr", "ltr" },
+	{ NULL,                FALSE, TRUE,  FALSE, "ltr", "ltr" }
+};
+
+/* main.c is not linked, the UI library still refers to this */
+void
+liferea_shutdown (void)
+{
+	exit (0);
+}
+
+/* Parses a corpus file into a feed node and returns its items. The
+   node stays registered until the program exits. */
+static GList *
+bench_load_file (const gchar *filename, nodePtr *node)
+{
+	feedParserCtxtPtr	ctxt;
+	subscriptionPtr		subscription;
+	GList			*items = NULL, *iter;
+	gchar			*data;
+	gsize			length;
+	GError			*error = NULL;
+
+	if (!g_file_get_contents (filename, &data, &length, &error)) {
+		g_printerr ("%s: %s\n", filename, error->message);
+		g_error_free (error);
+		return NULL;
+	}
+
+	/* Not using subscription_new() as it would schedule feed list saves */
+	subscription = g_new0 (struct subscription, 1);
+	subscription->source = g_strdup_printf ("file://%s", filename);
+
+	/* The node owns feed and subscription, so node_free() frees both */
+	*node = node_new (feed_get_node_type ());
+	node_set_data (*node, feed_new ());
+	(*node)->subscription = subscription;
+	subscription->node = *node;
+
+	ctxt = feed_create_parser_ctxt ();
+	ctxt->subscription = subscription;
+	ctxt->feed = (feedPtr)(*node)->data;
+	ctxt->data = data;
+	ctxt->dataLength = length;
+
+	if (!feed_parse (ctxt)) {
+		g_printerr ("%s: could not parse feed\n", filename);
+		node_free (*node);
+		*node = NULL;
+	} else {
+		node_set_title (*node, ctxt->title?ctxt->title:filename);
+
+		/* There is no DB, so no item ids and no duplicates */
+		for (iter = ctxt->items; iter; iter = g_list_next (iter)) {
+			itemPtr item = (itemPtr)iter->data;
+			item->nodeId = g_strdup ((*node)->id);
+			item->parentNodeId = g_strdup ((*node)->id);
+			item->validGuid = FALSE;
+		}
+		items = ctxt->items;
+		ctxt->items = NULL;
+	}
+
+	feed_free_parser_ctxt (ctxt);
+	g_free (data);
+
+	return items;
+}
+
+/* Returns the number of items rendered differently */
+static guint
+bench_check_parity (GList *items, nodePtr node, const gchar *filename)
+{
+	GList	*iter;
+	guint	i, mismatches = 0;
+
+	for (iter = items; iter; iter = g_list_next (iter)) {
+		itemPtr item = (itemPtr)iter->data;
+
+		for (i = 0; i < G_N_ELEMENTS (benchParams); i++) {
+			gchar *xslt = item_render_xslt (item, node, &benchParams[i]);
+			gchar *native = item_render_native (item, node, &benchParams[i]);
+
+			if (g_strcmp0 (xslt, native)) {
+				g_printerr ("%s: item \"%s\" differs in view mode %u\n--- xslt\n%s\n--- native\n%s\n",
+				            filename, item_get_title (item), i, xslt, native);
+				mismatches++;
+			}
+
+			g_free (xslt);
+			g_free (native);
+		}
+	}
+
+	return mismatches;
+}
+
+/* Returns the time needed to render all items in all view modes */
+static gint64
+bench_run (benchRenderFunc render, GList *items, guint iterations)
+{
+	GList	*iter;
+	gint64	start;
+	guint	i, j;
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < iterations; i++) {
+		for (iter = items; iter; iter = g_list_next (iter)) {
+			itemPtr item = (itemPtr)iter->data;
+			nodePtr node = node_from_id (item->nodeId);
+
+			for (j = 0; j < G_N_ELEMENTS (benchParams); j++)
+				g_free ((*render) (item, node, &benchParams[j]));
+		}
+	}
+
+	return g_get_monotonic_time () - start;
+}
+
+static void
+bench_print_result (const gchar *renderer, guint64 renderings, gint64 usecs)
+{
+	gdouble secs = MAX (usecs, 1) / (gdouble)G_USEC_PER_SEC;
+
+	g_print ("%s\t%" G_GUINT64_FORMAT "\t%.0f\n", renderer, renderings, renderings / secs);
+}
+
+int
+main (int argc, char *argv[])
+{
+	GList		*items = NULL, *fileItems, *iter;
+	guint		iterations = BENCH_DEFAULT_ITERATIONS;
+	guint		mismatches = 0;
+	guint64		renderings;
+	gint64		xsltUsecs, nativeUsecs;
+	nodePtr		node = NULL;
+	gint		i = 1;
+
+	while (i + 1 < argc && argv[i][0] == '-') {
+		if (g_str_equal (argv[i], "-n"))
+			iterations = (guint)common_parse_long (argv[i + 1], BENCH_DEFAULT_ITERATIONS);
+		else if (g_str_equal (argv[i], "-x"))
+			render_set_xslt_dir (argv[i + 1]);
+		else
+			break;
+		i += 2;
+	}
+
+	if (i >= argc) {
+		g_printerr ("Usage: %s [-n iterations] [-x xslt directory] FILE...\n", argv[0]);
+		return 1;
+	}
+
+	xml_init ();
+
+	for (; i < argc; i++) {
+		fileItems = bench_load_file (argv[i], &node);
+		if (!fileItems)
+			continue;
+
+		mismatches += bench_check_parity (fileItems, node, argv[i]);
+		items = g_list_concat (items, fileItems);
+	}
+
+	if (mismatches) {
+		g_printerr ("%u renderings differ\n", mismatches);
+		return 1;
+	}
+
+	renderings = (guint64)g_list_length (items) * G_N_ELEMENTS (benchParams) * iterations;
+	xsltUsecs = bench_run (item_render_xslt, items, iterations);
+	nativeUsecs = bench_run (item_render_native, items, iterations);
+
+	g_print ("# renderer\titems\titems/s\n");
+	bench_print_result ("xslt", renderings, xsltUsecs);
+	bench_print_result ("native", renderings, nativeUsecs);
+	g_print ("# speedup\t%.1f\n", MAX (xsltUsecs, 1) / (gdouble)MAX (nativeUsecs, 1));
+
+	for (iter = items; iter; iter = g_list_next (iter))
+		item_unload ((itemPtr)iter->data);
+	g_list_free (items);
+
+	return 0;
+}
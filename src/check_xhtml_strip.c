@@ -0,0 +1,155 @@
+/**
+ * @file check_xhtml_strip.c  HTML stripper equivalence check
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Checks the single pass xhtml_strip() against the GRegex strippers
+   it replaced. For most descriptions both must produce the very same
+   output. Where the scanner intentionally differs (it also catches
+   scripts with attributes, all event handlers and unterminated tags)
+   the expected output is given explicitly.
+
+   Prints one line per failed case and exits with 1 on failures. */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdlib.h>
+
+#include "xml.h"
+
+typedef struct stripCase {
+	guint		flags;
+	const gchar	*html;
+	const gchar	*expected;	/**< NULL if equal to the regex output */
+} stripCase;
+
+#define STRIP_ALL	(XHTML_STRIP_DHTML | XHTML_STRIP_UNSUPPORTED)
+
+static const stripCase cases[] = {
+	/* same output as the regex strippers */
+	{ STRIP_ALL, "<p>Hello <a href=\"http://example.com/\">world</a>!</p>", NULL },
+	{ STRIP_ALL, "<p><img src=\"http://example.com/a.png\" alt=\"a > b\" width=\"10\"/></p>", NULL },
+	{ STRIP_ALL, "before<script>alert(1)</script>after", NULL },
+	{ STRIP_ALL, "<SCRIPT>x()</SCRIPT><p>text</p><script >y()</script >", NULL },
+	{ STRIP_ALL, "<img src=\"a.png\" onload=\"track()\">", NULL },
+	{ STRIP_ALL, "<img src='a.png' onload='track()'/>", NULL },
+	{ STRIP_ALL, "<p>video:</p><iframe src=\"http://example.com/embed\" width=\"560\"></iframe><p>end</p>", NULL },
+	{ STRIP_ALL, "soft<wbr>hyphen<wbr/>s", NULL },
+	{ STRIP_ALL, "<body><p>inner</p></body>", NULL },
+	{ STRIP_ALL, "a < b and c > d", NULL },
+	{ STRIP_ALL, "1 &lt; 2 &amp;&amp; <!-- comment --> <br/>", NULL },
+	{ STRIP_ALL, "<table><tr><td style=\"color: red\">cell</td></tr></table>", NULL },
+	{ STRIP_ALL, "<style>p { margin: 0 }</style><p>styled</p>", NULL },
+	{ STRIP_ALL, "<pre>if (a<b) return;</pre>", NULL },
+	{ STRIP_ALL, "<a href=\"x\">unterminated \"quote</a>", NULL },
+	{ XHTML_STRIP_DHTML, "<wbr><body>kept without the unsupported flag</body>", NULL },
+	{ XHTML_STRIP_UNSUPPORTED, "<script>kept()</script><wbr>without the dhtml flag", NULL },
+
+	/* intended differences */
+	{ STRIP_ALL, "<script type=\"text/javascript\">alert(1)</script>", "" },
+	{ STRIP_ALL, "<div onclick=\"steal()\" onmouseover='x()'>text</div>", "<div>text</div>" },
+	{ STRIP_ALL, "<meta>x</meta>", "x" },
+	{ STRIP_ALL, "<script>alert(1)", "" },
+	{ STRIP_ALL, "<b'<script>alert(1)</script>", "&lt;b'&lt;script>alert(1)&lt;/script>" },
+	{ STRIP_ALL, "<img x' onerror=alert(1) >", "&lt;img x' onerror=alert(1) >" },
+	{ STRIP_ALL, "<a'<a'<a'<b>x</b>", "&lt;a'&lt;a'&lt;a'&lt;b>x&lt;/b>" }
+};
+
+/* The GRegex based strippers as they were before xhtml_strip() */
+
+static const gchar *dhtmlPatterns[] = {
+	"\\s+onload='[^']+'",
+	"\\s+onload=\"[^\"]+\"",
+	"<\\s*script\\s*>.*</\\s*script\\s*>",
+	"<\\s*meta\\s*>.*</\\s*meta\\s*>",
+	"<\\s*iframe[^>]*\\s*>.*</\\s*iframe\\s*>",
+	NULL
+};
+
+static const gchar *unsupportedPatterns[] = {
+	"<\\s*/?wbr[^>]*/?\\s*>",
+	"<\\s*/?body[^>]*/?\\s*>",
+	NULL
+};
+
+static gchar *
+regex_strip (gchar *html, const gchar **patterns)
+{
+	for (; *patterns; patterns++) {
+		GRegex	*expr;
+		gchar	*tmp = html;
+
+		expr = g_regex_new (*patterns, G_REGEX_CASELESS | G_REGEX_UNGREEDY | G_REGEX_DOTALL, 0, NULL);
+		g_assert (expr);
+		html = g_regex_replace (expr, tmp, -1, 0, "", 0, NULL);
+		g_regex_unref (expr);
+		g_free (tmp);
+	}
+
+	return html;
+}
+
+static gchar *
+regex_strip_all (const gchar *html, guint flags)
+{
+	gchar *result = g_strdup (html);
+
+	if (flags & XHTML_STRIP_DHTML)
+		result = regex_strip (result, dhtmlPatterns);
+	if (flags & XHTML_STRIP_UNSUPPORTED)
+		result = regex_strip (result, unsupportedPatterns);
+
+	return result;
+}
+
+/* main.c is not linked, the UI library still refers to this */
+void
+liferea_shutdown (void)
+{
+	exit (0);
+}
+
+int
+main (int argc, char *argv[])
+{
+	guint	i, failures = 0;
+
+	for (i = 0; i < G_N_ELEMENTS (cases); i++) {
+		gchar *expected, *result;
+
+		if (cases[i].expected)
+			expected = g_strdup (cases[i].expected);
+		else
+			expected = regex_strip_all (cases[i].html, cases[i].flags);
+
+		result = xhtml_strip (cases[i].html, cases[i].flags);
+		if (!g_str_equal (expected, result)) {
+			g_printerr ("FAIL %s\n  expected: %s\n  result:   %s\n", cases[i].html, expected, result);
+			failures++;
+		}
+
+		g_free (expected);
+		g_free (result);
+	}
+
+	g_print ("%u of %u xhtml_strip cases passed\n", i - failures, i);
+
+	return failures?1:0;
+}
@@ -235,6 +235,21 @@ comments_refresh (itemPtr item)
 	}
 }
 
+gboolean
+comments_get_state (const gchar *id, gboolean *updating, const gchar **error)
+{
+	commentFeedPtr	commentFeed;
+
+	commentFeed = comment_feed_from_id (id);
+	if (!commentFeed)
+		return FALSE;
+
+	*updating = (commentFeed->updateJob != NULL);
+	*error = commentFeed->error;
+
+	return TRUE;
+}
+
 void
 comments_to_xml (xmlNodePtr parentNode, const gchar *id)
 {
@@ -46,4 +46,15 @@ void comments_refresh (itemPtr item);
  */
 void comments_to_xml (xmlNodePtr parentNode, const gchar *id);
 
+/**
+ * Returns the update state of the given comment feed id.
+ *
+ * @param id		the comment feed id
+ * @param updating	returns TRUE if an update is running
+ * @param error		returns the last update error (or NULL)
+ *
+ * @returns FALSE if there is no such comment feed
+ */
+gboolean comments_get_state (const gchar *id, gboolean *updating, const gchar **error);
+
 #endif
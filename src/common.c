@@ -73,6 +73,7 @@ common_init_paths (void)
 	common_check_dir (g_strdup (lifereaCachePath));
 	common_check_dir (g_build_filename (lifereaCachePath, "feeds", NULL));
 	common_check_dir (g_build_filename (lifereaCachePath, "favicons", NULL));
+	common_check_dir (g_build_filename (lifereaCachePath, "images", NULL));
 	common_check_dir (g_build_filename (lifereaCachePath, "plugins", NULL));
 
 	common_check_dir (g_build_filename (g_get_user_config_dir(), "liferea", NULL));
@@ -38,6 +38,9 @@
 #define DEFAULT_FONT			"document-font-name"
 #define USER_FONT			"browser-font"
 #define DISABLE_JAVASCRIPT		"disable-javascript"
+#define NATIVE_ITEM_RENDERER		"native-item-renderer"
+#define IMAGE_CACHE			"image-cache"
+#define PREFETCH_IMAGES			"prefetch-images"
 #define SOCIAL_BM_SITE			"social-bm-site"
 #define ENABLE_PLUGINS			"enable-plugins"
 
@@ -52,6 +55,7 @@
 /* folder handling settings */
 #define FOLDER_DISPLAY_MODE		"folder-display-mode"
 #define FOLDER_DISPLAY_HIDE_READ	"folder-display-hide-read"
+#define FOLDER_DISPLAY_LIMIT		"folder-display-limit"
 #define REDUCED_FEEDLIST		"reduced-feedlist"
 
 /* GUI settings and persistency values */
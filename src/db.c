@@ -18,6 +18,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <locale.h>
 #include <sqlite3.h>
 #include <stdlib.h>
 #include <string.h>
@@ -37,6 +38,9 @@
 static sqlite3	*db = NULL;
 gboolean searchFolderRebuild = FALSE;
 
+/** TRUE if the node_ancestors table matches the node table */
+static gboolean nodeAncestorsValid = FALSE;
+
 /** hash of all prepared statements */
 static GHashTable *statements = NULL;
 
@@ -228,6 +232,59 @@ db_vacuum (void)
 	}
 }
 
+/* SQL function collate_key(text) returning the locale dependent
+   collation key of a text, so titles can be sorted in SQL */
+static void
+db_collate_key_func (sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+	const gchar	*text;
+	gchar		*key;
+
+	text = (const gchar *)sqlite3_value_text (argv[0]);
+	if (!text) {
+		sqlite3_result_null (context);
+		return;
+	}
+
+	key = g_utf8_collate_key (text, -1);
+	sqlite3_result_blob (context, key, strlen (key), g_free);
+}
+
+/* Recalculates the stored title collation keys when the
+   collation locale changed since they were calculated */
+static void
+db_title_keys_update (void)
+{
+	sqlite3_stmt	*stmt;
+	const gchar	*locale;
+	gchar		*sql;
+	gboolean	changed;
+
+	locale = setlocale (LC_COLLATE, NULL);
+	if (!locale)
+		locale = "C";
+
+	db_prepare_stmt (&stmt, "SELECT value FROM info WHERE name = 'collateLocale'");
+	changed = (SQLITE_ROW != sqlite3_step (stmt)) ||
+	          !g_str_equal (locale, (const gchar *)sqlite3_column_text (stmt, 0));
+	sqlite3_finalize (stmt);
+
+	if (!changed)
+		return;
+
+	debug1 (DEBUG_DB, "calculating title collation keys for locale \"%s\"", locale);
+	debug_start_measurement (DEBUG_DB);
+
+	sql = sqlite3_mprintf ("BEGIN; "
+	                       "UPDATE items SET title_key = collate_key(title); "
+	                       "REPLACE INTO info (name, value) VALUES ('collateLocale',%Q); "
+	                       "END;", locale);
+	db_exec (sql);
+	sqlite3_free (sql);
+
+	debug_end_measurement (DEBUG_DB, "title collation keys");
+}
+
 static void
 db_open (void)
 {
@@ -243,12 +300,16 @@ db_open (void)
 
 	sqlite3_extended_result_codes (db, TRUE);
 
+	res = sqlite3_create_function (db, "collate_key", 1, SQLITE_UTF8, NULL, db_collate_key_func, NULL, NULL);
+	if (SQLITE_OK != res)
+		g_error ("Registering SQL function collate_key failed (error code %d: %s)", res, sqlite3_errmsg (db));
+
 	db_exec("PRAGMA journal_mode=WAL");
 	db_exec("PRAGMA page_size=32768");
 	db_exec("PRAGMA synchronous=NORMAL");
 }
 
-#define SCHEMA_TARGET_VERSION 10
+#define SCHEMA_TARGET_VERSION 11
 
 /* opening or creation of database */
 void
@@ -433,6 +494,15 @@ db_init (void)
 
 			searchFolderRebuild = TRUE;
 		}
+
+		if (db_get_schema_version () == 10) {
+			/* Title collation keys for sorting the item list in SQL,
+			   they are filled by db_title_keys_update() */
+			db_exec ("BEGIN; "
+			         "ALTER TABLE items ADD COLUMN title_key BLOB; "
+			         "REPLACE INTO info (name, value) VALUES ('schemaVersion',11); "
+			         "END;");
+		}
 	}
 
 	if (SCHEMA_TARGET_VERSION != db_get_schema_version ())
@@ -465,6 +535,7 @@ db_init (void)
         	 "   date		INTEGER,"
         	 "   comment_feed_id	TEXT,"
 		 "   comment            INTEGER,"
+		 "   title_key		BLOB,"
 		 "   PRIMARY KEY (item_id)"
         	 ");");
 
@@ -474,6 +545,11 @@ db_init (void)
 	db_exec ("CREATE INDEX items_idx4 ON items (item_id);");
 	db_exec ("CREATE INDEX items_idx5 ON items (parent_item_id);");
 	db_exec ("CREATE INDEX items_idx6 ON items (parent_node_id);");
+	db_exec ("CREATE INDEX items_idx7 ON items (node_id, source_id);");
+	db_exec ("CREATE INDEX items_idx8 ON items (node_id, date, item_id);");
+	/* title sorting only covers listed ids, an index on title_key
+	   was never used but slowed down every item update */
+	db_exec ("DROP INDEX IF EXISTS items_idx9;");
 		
 	db_exec ("CREATE TABLE metadata ("
         	 "   item_id		INTEGER,"
@@ -526,8 +602,57 @@ db_init (void)
 		 "   PRIMARY KEY (node_id, item_id)"
 		 ");");
 
+	db_exec ("CREATE TABLE pending_actions ("
+	         "   action_id		INTEGER,"
+	         "   node_id		STRING,"
+	         "   type		INTEGER,"
+	         "   guid		TEXT,"
+	         "   feed_url		TEXT,"
+	         "   PRIMARY KEY (action_id)"
+	         ");");
+
+	db_exec ("CREATE INDEX pending_actions_idx ON pending_actions (node_id);");
+
+	db_exec ("CREATE TABLE html_cache ("
+	         "   item_id		INTEGER,"
+	         "   digest		TEXT,"
+	         "   html		TEXT,"
+	         "   used		INTEGER,"
+	         "   PRIMARY KEY (item_id, digest)"
+	         ");");
+
+	db_exec ("CREATE INDEX html_cache_idx ON html_cache (used);");
+
 	db_end_transaction ();
 	debug_end_measurement (DEBUG_DB, "table setup");
+
+	db_title_keys_update ();
+
+	/* Connection local scratch table for db_itemset_get_state_changes(),
+	   one row per remote item with read and marked as 0/1 and marked
+	   NULL if the source does not sync the flag state */
+	db_exec ("CREATE TEMP TABLE remote_states ("
+	         "   nr			INTEGER,"
+	         "   source_id		TEXT,"
+	         "   read		INTEGER,"
+	         "   marked		INTEGER,"
+	         "   PRIMARY KEY (nr)"
+	         ");");
+
+	/* Connection local scratch table for db_item_list_sort() */
+	db_exec ("CREATE TEMP TABLE item_list ("
+	         "   item_id		INTEGER,"
+	         "   PRIMARY KEY (item_id)"
+	         ");");
+
+	/* Connection local transitive closure of the node hierarchy for
+	   db_folder_load(), rebuilt from the node table when it changes */
+	db_exec ("CREATE TEMP TABLE node_ancestors ("
+	         "   node_id		TEXT,"
+	         "   ancestor_id	TEXT,"
+	         "   PRIMARY KEY (node_id, ancestor_id)"
+	         ");");
+	db_exec ("CREATE INDEX temp.node_ancestors_idx ON node_ancestors (ancestor_id);");
 		
 	/* 2. Removing old triggers */
 	db_exec ("DROP TRIGGER item_insert;");
@@ -567,6 +692,10 @@ db_init (void)
 	db_exec ("DELETE FROM subscription_metadata WHERE node_id NOT IN "
           	 "(SELECT node_id FROM node);");
 
+	debug0 (DEBUG_DB, "Checking for rendered HTML without item...\n");
+	db_exec ("DELETE FROM html_cache WHERE item_id NOT IN "
+	         "(SELECT item_id FROM items);");
+
 	debug0 (DEBUG_DB, "DB cleanup finished. Continuing startup.");
 		
 	/* 4. Creating triggers (after cleanup so it is not slowed down by triggers) */
@@ -576,6 +705,7 @@ db_init (void)
         	 "BEGIN "
 		 "   DELETE FROM metadata WHERE item_id = old.item_id; "
 		 "   DELETE FROM search_folder_items WHERE item_id = old.item_id; "
+		 "   DELETE FROM html_cache WHERE item_id = old.item_id; "
         	 "END;");
 		
 	db_exec ("CREATE TRIGGER subscription_removal DELETE ON subscription "
@@ -588,8 +718,9 @@ db_init (void)
 	/* Note: view counting triggers are set up in the view preparation code (see db_view_create()) */		
 	/* prepare statements */
 	
+	/* newest first, the default item list order */
 	db_new_statement ("itemsetLoadStmt",
-	                  "SELECT item_id FROM items WHERE node_id = ?");
+	                  "SELECT item_id FROM items WHERE node_id = ? ORDER BY date DESC, item_id DESC");
 
 	db_new_statement ("itemsetLoadOffsetStmt",
 			  "SELECT item_id FROM items WHERE comment = 0 LIMIT ? OFFSET ?");
@@ -601,6 +732,21 @@ db_init (void)
 	db_new_statement ("itemsetItemCountStmt",
 	                  "SELECT COUNT(item_id) FROM items "
 		          "WHERE node_id = ?");
+
+	db_new_statement ("itemsetFlagCountStmt",
+	                  "SELECT COUNT(item_id) FROM items "
+		          "WHERE marked = 1 AND node_id = ?");
+
+	db_new_statement ("itemsetOldestStmt",
+	                  "SELECT item_id FROM items "
+	                  "WHERE node_id = ? AND marked = 0 AND item_id != ? "
+	                  "ORDER BY date, item_id LIMIT ?");
+
+	db_new_statement ("itemsetRemoveOldestStmt",
+	                  "DELETE FROM items WHERE item_id IN "
+	                  "(SELECT item_id FROM items WHERE node_id = ? AND marked = 0 AND item_id != ? ORDER BY date, item_id LIMIT ?) "
+	                  "OR (comment = 1 AND parent_item_id IN "
+	                  "(SELECT item_id FROM items WHERE node_id = ? AND marked = 0 AND item_id != ? ORDER BY date, item_id LIMIT ?))");
 		       
 	db_new_statement ("itemsetRemoveStmt",
 	                  "DELETE FROM items WHERE item_id = ? OR (comment = 1 AND parent_item_id = ?)");
@@ -611,6 +757,20 @@ db_init (void)
 	db_new_statement ("itemsetMarkAllPopupStmt",
 	                  "UPDATE items SET popup = 0 WHERE node_id = ?");
 
+	db_new_statement ("itemsetUnreadFindStmt",
+	                  "SELECT item_id FROM items WHERE node_id = ? AND read = 0");
+
+	db_new_statement ("itemsetUnreadDuplicatesFindStmt",
+	                  "SELECT item_id FROM items WHERE read = 0 AND node_id != ? AND source_id IN "
+	                  "(SELECT source_id FROM items WHERE node_id = ? AND read = 0 AND valid_guid = 1)");
+
+	db_new_statement ("itemsetDuplicatesMarkReadStmt",
+	                  "UPDATE items SET read = 1, updated = 0 WHERE read = 0 AND node_id != ? AND source_id IN "
+	                  "(SELECT source_id FROM items WHERE node_id = ? AND read = 0 AND valid_guid = 1)");
+
+	db_new_statement ("itemsetMarkAllReadStmt",
+	                  "UPDATE items SET read = 1, updated = 0 WHERE node_id = ? AND read = 0");
+
 	db_new_statement ("itemLoadStmt",
 	                  "SELECT "
 	                  "title,"
@@ -630,6 +790,26 @@ db_init (void)
 		          "node_id, "
 			  "parent_node_id "
 	                  " FROM items WHERE item_id = ?");      
+
+	db_new_statement ("itemsetLoadItemsStmt",
+	                  "SELECT "
+	                  "title,"
+	                  "read,"
+	                  "updated,"
+	                  "popup,"
+	                  "marked,"
+	                  "source,"
+	                  "source_id,"
+	                  "valid_guid,"
+	                  "description,"
+	                  "date,"
+		          "comment_feed_id,"
+		          "comment,"
+		          "item_id,"
+			  "parent_item_id, "
+		          "node_id, "
+			  "parent_node_id "
+	                  " FROM items WHERE node_id = ?");
 	
 	db_new_statement ("itemUpdateStmt",
 	                  "REPLACE INTO items ("
@@ -648,8 +828,9 @@ db_init (void)
 	                  "item_id,"
 	                  "parent_item_id,"
 	                  "node_id,"
-	                  "parent_node_id"
-	                  ") values (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)");
+	                  "parent_node_id,"
+	                  "title_key"
+	                  ") values (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,collate_key(?1))");
 			
 	db_new_statement ("itemStateUpdateStmt",
 			  "UPDATE items SET read=?, marked=?, updated=? "
@@ -662,8 +843,13 @@ db_init (void)
 	                  "SELECT node_id FROM items WHERE item_id IN "
 			  "(SELECT item_id FROM items WHERE source_id = ?)");
 		       
+	db_new_statement ("duplicatesChangedFindStmt",
+	                  "SELECT item_id, node_id FROM items "
+	                  "WHERE source_id = ? AND item_id != ? AND (read != ? OR updated = 1)");
+
 	db_new_statement ("duplicatesMarkReadStmt",
- 	                  "UPDATE items SET read = 1, updated = 0 WHERE source_id = ?");
+ 	                  "UPDATE items SET read = ?, updated = 0 "
+	                  "WHERE source_id = ? AND item_id != ? AND (read != ? OR updated = 1)");
 						
 	db_new_statement ("metadataLoadStmt",
 	                  "SELECT key,value,nr FROM metadata WHERE item_id = ? ORDER BY nr");
@@ -714,7 +900,10 @@ db_init (void)
 	                  "DELETE FROM search_folder_items WHERE node_id =? AND item_id = ?;");
 	                  
 	db_new_statement ("searchFolderLoadStmt",
-	                  "SELECT item_id FROM search_folder_items WHERE node_id = ?;");
+	                  "SELECT search_folder_items.item_id FROM search_folder_items "
+	                  "INNER JOIN items ON items.item_id = search_folder_items.item_id "
+	                  "WHERE search_folder_items.node_id = ? "
+	                  "ORDER BY items.date DESC, items.item_id DESC;");
 
 	db_new_statement ("searchFolderCountStmt",
 	                  "SELECT count(item_id) FROM search_folder_items WHERE node_id = ?;");
@@ -724,6 +913,110 @@ db_init (void)
 
 	db_new_statement ("nodeRemoveStmt",
 	                  "DELETE FROM node WHERE node_id = ?;");
+
+	db_new_statement ("nodeAncestorsClearStmt",
+	                  "DELETE FROM node_ancestors;");
+
+	db_new_statement ("nodeAncestorsInitStmt",
+	                  "INSERT INTO node_ancestors (node_id, ancestor_id) SELECT node_id, node_id FROM node;");
+
+	db_new_statement ("nodeAncestorsExpandStmt",
+	                  "INSERT OR IGNORE INTO node_ancestors (node_id, ancestor_id) "
+	                  "SELECT node_ancestors.node_id, node.parent_id FROM node_ancestors "
+	                  "INNER JOIN node ON node.node_id = node_ancestors.ancestor_id "
+	                  "WHERE node.parent_id IS NOT NULL;");
+
+	db_new_statement ("folderLoadStmt",
+	                  "SELECT items.item_id FROM node_ancestors "
+	                  "INNER JOIN items ON items.node_id = node_ancestors.node_id "
+	                  "WHERE node_ancestors.ancestor_id = ? "
+	                  "ORDER BY items.date DESC, items.item_id DESC LIMIT ?;");
+
+	db_new_statement ("folderLoadUnreadStmt",
+	                  "SELECT items.item_id FROM node_ancestors "
+	                  "INNER JOIN items ON items.node_id = node_ancestors.node_id "
+	                  "WHERE node_ancestors.ancestor_id = ? AND items.read = 0 "
+	                  "ORDER BY items.date DESC, items.item_id DESC LIMIT ?;");
+
+	db_new_statement ("pendingActionInsertStmt",
+	                  "INSERT INTO pending_actions (node_id,type,guid,feed_url) VALUES (?,?,?,?);");
+
+	db_new_statement ("pendingActionRemoveStmt",
+	                  "DELETE FROM pending_actions WHERE action_id = ?;");
+
+	db_new_statement ("pendingActionsLoadStmt",
+	                  "SELECT action_id,type,guid,feed_url FROM pending_actions WHERE node_id = ? ORDER BY action_id;");
+
+	db_new_statement ("pendingActionsRemoveAllStmt",
+	                  "DELETE FROM pending_actions WHERE node_id = ?;");
+
+	db_new_statement ("htmlCacheLoadStmt",
+	                  "SELECT html FROM html_cache WHERE item_id = ? AND digest = ?;");
+
+	db_new_statement ("htmlCacheTouchStmt",
+	                  "UPDATE html_cache SET used = ? WHERE item_id = ? AND digest = ? AND used < ?;");
+
+	db_new_statement ("htmlCacheStoreStmt",
+	                  "REPLACE INTO html_cache (item_id,digest,html,used) VALUES (?,?,?,?);");
+
+	db_new_statement ("htmlCacheRemoveStmt",
+	                  "DELETE FROM html_cache WHERE item_id = ?;");
+
+	db_new_statement ("htmlCacheSizeStmt",
+	                  "SELECT TOTAL(LENGTH(CAST(html AS BLOB))), COUNT(*) FROM html_cache;");
+
+	db_new_statement ("htmlCacheEvictStmt",
+	                  "DELETE FROM html_cache WHERE ROWID IN "
+	                  "(SELECT ROWID FROM html_cache ORDER BY used LIMIT ?);");
+
+	db_new_statement ("remoteStatesClearStmt",
+	                  "DELETE FROM remote_states;");
+
+	db_new_statement ("remoteStatesInsertStmt",
+	                  "INSERT INTO remote_states (nr,source_id,read,marked) VALUES (?,?,?,?);");
+
+	db_new_statement ("remoteStatesCompareStmt",
+	                  "SELECT remote_states.nr, items.item_id FROM remote_states "
+	                  "INNER JOIN items ON items.node_id = ? AND items.source_id = remote_states.source_id "
+	                  "WHERE items.read != remote_states.read "
+	                  "OR (remote_states.marked IS NOT NULL AND items.marked != remote_states.marked);");
+
+	db_new_statement ("itemListLoadStmt",
+	                  "SELECT item_id, title, read, marked, date, node_id, "
+	                  "EXISTS (SELECT 1 FROM metadata WHERE metadata.item_id = items.item_id AND key = 'enclosure') "
+	                  "FROM items WHERE item_id = ?;");
+
+	db_new_statement ("itemListClearStmt",
+	                  "DELETE FROM item_list;");
+
+	db_new_statement ("itemListInsertStmt",
+	                  "INSERT OR IGNORE INTO item_list (item_id) VALUES (?);");
+
+	/* The sort orders match the former GtkTreeStore sort functions
+	   in ascending order: oldest first, titles A-Z, by feed and
+	   by state (unread and flagged last), ties are ordered by date
+	   and item id in the same direction. Descending order is the
+	   exact reverse. They must match item_list_model_compare_keys()
+	   too. */
+	db_new_statement ("itemListSortByTimeStmt",
+	                  "SELECT items.item_id FROM item_list "
+	                  "INNER JOIN items ON items.item_id = item_list.item_id "
+	                  "ORDER BY items.date, items.item_id;");
+
+	db_new_statement ("itemListSortByTitleStmt",
+	                  "SELECT items.item_id FROM item_list "
+	                  "INNER JOIN items ON items.item_id = item_list.item_id "
+	                  "ORDER BY items.title_key, items.date, items.item_id;");
+
+	db_new_statement ("itemListSortByParentStmt",
+	                  "SELECT items.item_id FROM item_list "
+	                  "INNER JOIN items ON items.item_id = item_list.item_id "
+	                  "ORDER BY items.node_id, items.date, items.item_id;");
+
+	db_new_statement ("itemListSortByStateStmt",
+	                  "SELECT items.item_id FROM item_list "
+	                  "INNER JOIN items ON items.item_id = item_list.item_id "
+	                  "ORDER BY items.marked * 2 + (items.read = 0), items.date, items.item_id;");
 			  
 	g_assert (sqlite3_get_autocommit (db));
 	
@@ -821,7 +1114,7 @@ db_item_metadata_update(itemPtr item)
 /* Item structure loading methods */
 
 static itemPtr
-db_load_item_from_columns (sqlite3_stmt *stmt) 
+db_load_item_from_columns (sqlite3_stmt *stmt, gboolean withMetadata) 
 {
 	const gchar	*tmp;
 
@@ -853,7 +1146,8 @@ db_load_item_from_columns (sqlite3_stmt *stmt)
 	else
 		item->description = g_strdup ("");
 
-	item->metadata = db_item_metadata_load (item);
+	if (withMetadata)
+		item->metadata = db_item_metadata_load (item);
 
 	return item;
 }
@@ -872,8 +1166,9 @@ db_itemset_load (const gchar *id)
 	sqlite3_bind_text (stmt, 1, id, -1, SQLITE_TRANSIENT);
 
 	while (sqlite3_step (stmt) == SQLITE_ROW) {
-		itemSet->ids = g_list_append (itemSet->ids, GUINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
+		itemSet->ids = g_list_prepend (itemSet->ids, GUINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
 	}
+	itemSet->ids = g_list_reverse (itemSet->ids);
 
 	sqlite3_finalize (stmt);
 
@@ -882,6 +1177,27 @@ db_itemset_load (const gchar *id)
 	return itemSet;
 }
 
+GList *
+db_itemset_load_items_for_merge (const gchar *id)
+{
+	sqlite3_stmt	*stmt;
+	GList		*items = NULL;
+
+	debug_start_measurement (DEBUG_DB);
+
+	stmt = db_get_statement ("itemsetLoadItemsStmt");
+	sqlite3_bind_text (stmt, 1, id, -1, SQLITE_TRANSIENT);
+
+	while (sqlite3_step (stmt) == SQLITE_ROW)
+		items = g_list_prepend (items, db_load_item_from_columns (stmt, FALSE));
+
+	sqlite3_finalize (stmt);
+
+	debug_end_measurement (DEBUG_DB, "loading items for merge");
+
+	return g_list_reverse (items);
+}
+
 itemPtr
 db_item_load (gulong id) 
 {
@@ -895,7 +1211,7 @@ db_item_load (gulong id)
 	sqlite3_bind_int (stmt, 1, id);
 
 	if (sqlite3_step (stmt) == SQLITE_ROW) {
-		item = db_load_item_from_columns (stmt);
+		item = db_load_item_from_columns (stmt, TRUE);
 		sqlite3_step (stmt);
 	} else {
 		debug1 (DEBUG_DB, "Could not load item with id %lu!", id);
@@ -908,6 +1224,114 @@ db_item_load (gulong id)
 	return item;
 }
 
+GSList *
+db_item_list_load (const gulong *ids, guint count)
+{
+	sqlite3_stmt	*stmt;
+	GSList		*items = NULL;
+	itemPtr		item;
+	guint		i;
+
+	debug_start_measurement (DEBUG_DB);
+
+	stmt = db_get_statement ("itemListLoadStmt");
+	for (i = 0; i < count; i++) {
+		sqlite3_reset (stmt);
+		sqlite3_bind_int (stmt, 1, ids[i]);
+		if (SQLITE_ROW != sqlite3_step (stmt))
+			continue;
+
+		item = item_new ();
+		item->id		= sqlite3_column_int (stmt, 0);
+		item->title		= g_strdup (sqlite3_column_text (stmt, 1));
+		item->readStatus	= sqlite3_column_int (stmt, 2)?TRUE:FALSE;
+		item->flagStatus	= sqlite3_column_int (stmt, 3)?TRUE:FALSE;
+		item->time		= sqlite3_column_int (stmt, 4);
+		item->nodeId		= g_strdup (sqlite3_column_text (stmt, 5));
+		item->hasEnclosure	= sqlite3_column_int (stmt, 6)?TRUE:FALSE;
+		items = g_slist_prepend (items, item);
+	}
+	sqlite3_finalize (stmt);
+
+	debug_end_measurement (DEBUG_DB, "item list load");
+
+	return g_slist_reverse (items);
+}
+
+void
+db_item_list_sort (gulong *ids, guint count, nodeViewSortType sortType, gboolean reversed)
+{
+	sqlite3_stmt	*stmt;
+	GHashTable	*sorted;
+	gulong		*result;
+	const gchar	*name;
+	guint		i, n = 0;
+
+	switch (sortType) {
+		case NODE_VIEW_SORT_BY_TITLE:
+			name = "itemListSortByTitleStmt";
+			break;
+		case NODE_VIEW_SORT_BY_PARENT:
+			name = "itemListSortByParentStmt";
+			break;
+		case NODE_VIEW_SORT_BY_STATE:
+			name = "itemListSortByStateStmt";
+			break;
+		case NODE_VIEW_SORT_BY_TIME:
+		default:
+			name = "itemListSortByTimeStmt";
+			break;
+	}
+
+	debug_start_measurement (DEBUG_DB);
+
+	result = g_new (gulong, count);
+	sorted = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	db_begin_transaction ();
+
+	stmt = db_get_statement ("itemListClearStmt");
+	sqlite3_step (stmt);
+	sqlite3_finalize (stmt);
+
+	stmt = db_get_statement ("itemListInsertStmt");
+	for (i = 0; i < count; i++) {
+		sqlite3_reset (stmt);
+		sqlite3_bind_int (stmt, 1, ids[i]);
+		if (SQLITE_DONE != sqlite3_step (stmt))
+			g_warning ("db_item_list_sort: inserting item failed (%s)", sqlite3_errmsg (db));
+	}
+	sqlite3_finalize (stmt);
+
+	stmt = db_get_statement (name);
+	while (sqlite3_step (stmt) == SQLITE_ROW && n < count) {
+		result[n] = sqlite3_column_int (stmt, 0);
+		g_hash_table_insert (sorted, GUINT_TO_POINTER (result[n]), GUINT_TO_POINTER (1));
+		n++;
+	}
+	sqlite3_finalize (stmt);
+
+	stmt = db_get_statement ("itemListClearStmt");
+	sqlite3_step (stmt);
+	sqlite3_finalize (stmt);
+
+	db_end_transaction ();
+
+	/* items not found in the DB keep their relative order at the end */
+	for (i = 0; i < count && n < count; i++) {
+		if (!g_hash_table_lookup (sorted, GUINT_TO_POINTER (ids[i])))
+			result[n++] = ids[i];
+	}
+
+	for (i = 0; i < n; i++)
+		ids[i] = reversed ? result[n - 1 - i] : result[i];
+
+	g_hash_table_destroy (sorted);
+	g_free (result);
+
+	debug_end_measurement (DEBUG_DB, "item list sort");
+}
+
 /* Item modification methods */
 
 static int
@@ -1046,6 +1470,14 @@ db_item_update (itemPtr item)
 
 	sqlite3_finalize (stmt);
 
+	/* Any rendering of the old content is stale now */
+	stmt = db_get_statement ("htmlCacheRemoveStmt");
+	sqlite3_bind_int (stmt, 1, item->id);
+	res = sqlite3_step (stmt);
+	if (SQLITE_DONE != res)
+		g_warning ("removing rendered HTML of item %lu failed (%s)", item->id, sqlite3_errmsg (db));
+	sqlite3_finalize (stmt);
+
 	db_item_metadata_update (item);
 	db_item_search_folders_update (item);
 
@@ -1102,6 +1534,55 @@ db_item_remove (gulong id)
 	sqlite3_finalize (stmt);
 }
 
+GSList *
+db_item_duplicates_set_read_state (const gchar *guid, gulong id, gboolean newState, GSList **nodeIds)
+{
+	GSList		*duplicates = NULL;
+	sqlite3_stmt	*stmt;
+	gint		res;
+
+	*nodeIds = NULL;
+
+	debug_start_measurement (DEBUG_DB);
+
+	db_begin_transaction ();
+
+	stmt = db_get_statement ("duplicatesChangedFindStmt");
+	sqlite3_bind_text (stmt, 1, guid, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int  (stmt, 2, id);
+	sqlite3_bind_int  (stmt, 3, newState?1:0);
+
+	while (sqlite3_step (stmt) == SQLITE_ROW) {
+		const gchar *nodeId = (const gchar *)sqlite3_column_text (stmt, 1);
+
+		duplicates = g_slist_prepend (duplicates, GUINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
+		if (!g_slist_find_custom (*nodeIds, nodeId, (GCompareFunc)g_strcmp0))
+			*nodeIds = g_slist_prepend (*nodeIds, g_strdup (nodeId));
+	}
+
+	sqlite3_finalize (stmt);
+
+	if (duplicates) {
+		stmt = db_get_statement ("duplicatesMarkReadStmt");
+		sqlite3_bind_int  (stmt, 1, newState?1:0);
+		sqlite3_bind_text (stmt, 2, guid, -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int  (stmt, 3, id);
+		sqlite3_bind_int  (stmt, 4, newState?1:0);
+		res = sqlite3_step (stmt);
+
+		if (SQLITE_DONE != res)
+			g_warning ("duplicate read state update failed (error code=%d, %s)", res, sqlite3_errmsg (db));
+
+		sqlite3_finalize (stmt);
+	}
+
+	db_end_transaction ();
+
+	debug_end_measurement (DEBUG_DB, "duplicate read state update");
+
+	return duplicates;
+}
+
 GSList * 
 db_item_get_duplicates (const gchar *guid) 
 {
@@ -1156,6 +1637,76 @@ db_item_get_duplicate_nodes (const gchar *guid)
 	return duplicates;
 }
 
+GSList *
+db_itemset_get_state_changes (const gchar *id, GSList *states)
+{
+	GSList		*changes = NULL, *iter;
+	GPtrArray	*byNr;
+	sqlite3_stmt	*stmt;
+	gint		res;
+
+	if (!states)
+		return NULL;
+
+	debug_start_measurement (DEBUG_DB);
+
+	byNr = g_ptr_array_new ();
+
+	db_begin_transaction ();
+
+	stmt = db_get_statement ("remoteStatesClearStmt");
+	if (SQLITE_DONE != sqlite3_step (stmt))
+		g_warning ("db_itemset_get_state_changes: clearing states failed (%s)", sqlite3_errmsg (db));
+	sqlite3_finalize (stmt);
+
+	stmt = db_get_statement ("remoteStatesInsertStmt");
+	for (iter = states; iter; iter = g_slist_next (iter)) {
+		itemRemoteStatePtr state = (itemRemoteStatePtr)iter->data;
+
+		sqlite3_reset (stmt);
+		sqlite3_bind_int (stmt, 1, byNr->len);
+		sqlite3_bind_text (stmt, 2, state->sourceId, -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int (stmt, 3, state->read?1:0);
+		if (state->flag < 0)
+			sqlite3_bind_null (stmt, 4);
+		else
+			sqlite3_bind_int (stmt, 4, state->flag?1:0);
+		res = sqlite3_step (stmt);
+		if (SQLITE_DONE != res)
+			g_warning ("db_itemset_get_state_changes: inserting state failed (%s)", sqlite3_errmsg (db));
+
+		g_ptr_array_add (byNr, state);
+	}
+	sqlite3_finalize (stmt);
+
+	stmt = db_get_statement ("remoteStatesCompareStmt");
+	sqlite3_bind_text (stmt, 1, id, -1, SQLITE_TRANSIENT);
+	while (sqlite3_step (stmt) == SQLITE_ROW) {
+		guint nr = sqlite3_column_int (stmt, 0);
+		itemRemoteStatePtr state;
+
+		if (nr >= byNr->len)
+			continue;
+
+		state = (itemRemoteStatePtr)g_ptr_array_index (byNr, nr);
+		state->itemId = sqlite3_column_int (stmt, 1);
+		changes = g_slist_prepend (changes, state);
+	}
+	sqlite3_finalize (stmt);
+
+	stmt = db_get_statement ("remoteStatesClearStmt");
+	sqlite3_step (stmt);
+	sqlite3_finalize (stmt);
+
+	db_end_transaction ();
+
+	g_ptr_array_free (byNr, TRUE);
+
+	debug_end_measurement (DEBUG_DB, "comparing remote item states");
+
+	return g_slist_reverse (changes);
+}
+
 void 
 db_itemset_remove_all (const gchar *id) 
 {
@@ -1269,6 +1820,131 @@ db_itemset_get_item_count (const gchar *id)
 	return count;
 }
 
+guint
+db_itemset_get_flag_count (const gchar *id) 
+{
+	sqlite3_stmt 	*stmt;
+	gint		res;
+	guint		count = 0;
+
+	stmt = db_get_statement ("itemsetFlagCountStmt");
+	sqlite3_bind_text (stmt, 1, id, -1, SQLITE_TRANSIENT);
+	res = sqlite3_step (stmt);
+	
+	if (SQLITE_ROW == res)
+		count = sqlite3_column_int (stmt, 0);
+	else
+		g_warning ("flag counting failed (error code=%d, %s)", res, sqlite3_errmsg (db));
+
+	sqlite3_finalize (stmt);
+
+	return count;
+}
+
+GList *
+db_itemset_get_oldest (const gchar *id, guint count, gulong keepId)
+{
+	sqlite3_stmt	*stmt;
+	GList		*ids = NULL;
+
+	stmt = db_get_statement ("itemsetOldestStmt");
+	sqlite3_bind_text (stmt, 1, id, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int64 (stmt, 2, keepId);
+	sqlite3_bind_int  (stmt, 3, count);
+
+	while (sqlite3_step (stmt) == SQLITE_ROW)
+		ids = g_list_prepend (ids, GUINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
+
+	sqlite3_finalize (stmt);
+
+	return g_list_reverse (ids);
+}
+
+void
+db_itemset_remove_oldest (const gchar *id, guint count, gulong keepId)
+{
+	sqlite3_stmt	*stmt;
+	gint		res;
+
+	debug2 (DEBUG_DB, "removing %u oldest items of item set %s", count, id);
+	debug_start_measurement (DEBUG_DB);
+
+	stmt = db_get_statement ("itemsetRemoveOldestStmt");
+	sqlite3_bind_text (stmt, 1, id, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int64 (stmt, 2, keepId);
+	sqlite3_bind_int  (stmt, 3, count);
+	sqlite3_bind_text (stmt, 4, id, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int64 (stmt, 5, keepId);
+	sqlite3_bind_int  (stmt, 6, count);
+	res = sqlite3_step (stmt);
+
+	if (SQLITE_DONE != res)
+		g_warning ("removing oldest items failed (error code=%d, %s)", res, sqlite3_errmsg (db));
+
+	sqlite3_finalize (stmt);
+
+	debug_end_measurement (DEBUG_DB, "removing oldest items");
+}
+
+static GList *
+db_itemset_get_ids (const gchar *stmtName, const gchar *id, gint binds)
+{
+	sqlite3_stmt	*stmt;
+	GList		*ids = NULL;
+	gint		i;
+
+	stmt = db_get_statement (stmtName);
+	for (i = 1; i <= binds; i++)
+		sqlite3_bind_text (stmt, i, id, -1, SQLITE_TRANSIENT);
+
+	while (sqlite3_step (stmt) == SQLITE_ROW)
+		ids = g_list_prepend (ids, GUINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
+
+	sqlite3_finalize (stmt);
+
+	return ids;
+}
+
+static void
+db_itemset_mark_read_step (const gchar *stmtName, const gchar *id, gint binds)
+{
+	sqlite3_stmt	*stmt;
+	gint		res, i;
+
+	stmt = db_get_statement (stmtName);
+	for (i = 1; i <= binds; i++)
+		sqlite3_bind_text (stmt, i, id, -1, SQLITE_TRANSIENT);
+
+	res = sqlite3_step (stmt);
+	if (SQLITE_DONE != res)
+		g_warning ("marking item set read failed (error code=%d, %s)", res, sqlite3_errmsg (db));
+
+	sqlite3_finalize (stmt);
+}
+
+GList *
+db_itemset_mark_all_read (const gchar *id, GList **duplicates)
+{
+	GList	*ids;
+
+	debug_start_measurement (DEBUG_DB);
+
+	db_begin_transaction ();
+
+	ids = db_itemset_get_ids ("itemsetUnreadFindStmt", id, 1);
+	*duplicates = db_itemset_get_ids ("itemsetUnreadDuplicatesFindStmt", id, 2);
+
+	/* duplicates first as they are found using the unread items of the set */
+	db_itemset_mark_read_step ("itemsetDuplicatesMarkReadStmt", id, 2);
+	db_itemset_mark_read_step ("itemsetMarkAllReadStmt", id, 1);
+
+	db_end_transaction ();
+
+	debug_end_measurement (DEBUG_DB, "mark item set read");
+
+	return ids;
+}
+
 /* This method is only used for migration from old schema versions */
 static void
 db_view_remove_triggers (const gchar *id)
@@ -1359,8 +2035,9 @@ db_search_folder_load (const gchar *id)
 	itemSet->nodeId = (gchar *)id;
 
 	while (sqlite3_step (stmt) == SQLITE_ROW) {
-		itemSet->ids = g_list_append (itemSet->ids, GUINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
+		itemSet->ids = g_list_prepend (itemSet->ids, GUINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
 	}
+	itemSet->ids = g_list_reverse (itemSet->ids);
 	
 	sqlite3_finalize (stmt);
 
@@ -1554,6 +2231,79 @@ db_subscription_remove (const gchar *id)
 	debug_end_measurement (DEBUG_DB, "subscription remove");
 }
 
+/* Rebuilds the node_ancestors table with one row for every node and
+   each of its ancestors (including the node itself). Recursive queries
+   need SQLite 3.8.3, so the closure is expanded one level per step. */
+static void
+db_node_ancestors_update (void)
+{
+	sqlite3_stmt	*stmt;
+	guint		depth = 0;
+
+	if (nodeAncestorsValid)
+		return;
+
+	debug_start_measurement (DEBUG_DB);
+
+	db_begin_transaction ();
+
+	stmt = db_get_statement ("nodeAncestorsClearStmt");
+	sqlite3_step (stmt);
+	sqlite3_finalize (stmt);
+
+	stmt = db_get_statement ("nodeAncestorsInitStmt");
+	sqlite3_step (stmt);
+	sqlite3_finalize (stmt);
+
+	stmt = db_get_statement ("nodeAncestorsExpandStmt");
+	do {
+		sqlite3_reset (stmt);
+		if (SQLITE_DONE != sqlite3_step (stmt)) {
+			g_warning ("Could not update node ancestors (%s)", sqlite3_errmsg (db));
+			break;
+		}
+		depth++;
+	} while (sqlite3_changes (db) > 0);
+	sqlite3_finalize (stmt);
+
+	db_end_transaction ();
+
+	nodeAncestorsValid = TRUE;
+
+	debug1 (DEBUG_DB, "node ancestors updated (%u levels)", depth);
+	debug_end_measurement (DEBUG_DB, "node ancestors update");
+}
+
+itemSetPtr
+db_folder_load (const gchar *id, gboolean unreadOnly, guint limit)
+{
+	sqlite3_stmt	*stmt;
+	itemSetPtr 	itemSet;
+
+	db_node_ancestors_update ();
+
+	debug3 (DEBUG_DB, "loading folder itemset for node \"%s\" (unread only=%d, limit=%u)", id, unreadOnly, limit);
+	debug_start_measurement (DEBUG_DB);
+
+	itemSet = g_new0 (struct itemSet, 1);
+	itemSet->nodeId = (gchar *)id;
+
+	stmt = db_get_statement (unreadOnly?"folderLoadUnreadStmt":"folderLoadStmt");
+	sqlite3_bind_text (stmt, 1, id, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int  (stmt, 2, limit?(gint)limit:-1);
+
+	while (sqlite3_step (stmt) == SQLITE_ROW) {
+		itemSet->ids = g_list_prepend (itemSet->ids, GUINT_TO_POINTER (sqlite3_column_int (stmt, 0)));
+	}
+	itemSet->ids = g_list_reverse (itemSet->ids);
+
+	sqlite3_finalize (stmt);
+
+	debug_end_measurement (DEBUG_DB, "folder load");
+
+	return itemSet;
+}
+
 void
 db_node_update (nodePtr node)
 {
@@ -1578,6 +2328,8 @@ db_node_update (nodePtr node)
 		g_warning ("Could not update node info %s in DB (error code %d)!", node->id, res);
 
 	sqlite3_finalize (stmt);
+
+	nodeAncestorsValid = FALSE;
 		
 	debug_end_measurement (DEBUG_DB, "node update");
 }
@@ -1614,6 +2366,80 @@ db_node_remove (const gchar *id)
 		g_warning ("Could not remove node %s in DB (error code %d)!", id, res);
 
 	sqlite3_finalize (stmt);
+
+	nodeAncestorsValid = FALSE;
+
+	/* in case it is an online source with unsent actions */
+	stmt = db_get_statement ("pendingActionsRemoveAllStmt");
+	sqlite3_bind_text (stmt, 1, id, -1, SQLITE_TRANSIENT);
+	sqlite3_step (stmt);
+	sqlite3_finalize (stmt);
+}
+
+gint64
+db_pending_action_add (const gchar *nodeId, gint type, const gchar *guid, const gchar *feedUrl)
+{
+	sqlite3_stmt	*stmt;
+	gint64		id = 0;
+	gint		res;
+
+	stmt = db_get_statement ("pendingActionInsertStmt");
+	sqlite3_bind_text (stmt, 1, nodeId, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int  (stmt, 2, type);
+	sqlite3_bind_text (stmt, 3, guid, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text (stmt, 4, feedUrl, -1, SQLITE_TRANSIENT);
+
+	res = sqlite3_step (stmt);
+	if (SQLITE_DONE == res)
+		id = sqlite3_last_insert_rowid (db);
+	else
+		g_warning ("Could not save pending action for %s (%s)", nodeId, sqlite3_errmsg (db));
+
+	sqlite3_finalize (stmt);
+
+	return id;
+}
+
+void
+db_pending_action_remove (gint64 id)
+{
+	sqlite3_stmt	*stmt;
+	gint		res;
+
+	if (!id)
+		return;
+
+	stmt = db_get_statement ("pendingActionRemoveStmt");
+	sqlite3_bind_int64 (stmt, 1, id);
+
+	res = sqlite3_step (stmt);
+	if (SQLITE_DONE != res)
+		g_warning ("Could not remove pending action %" G_GINT64_FORMAT " (%s)", id, sqlite3_errmsg (db));
+
+	sqlite3_finalize (stmt);
+}
+
+GSList *
+db_pending_actions_load (const gchar *nodeId)
+{
+	GSList		*actions = NULL;
+	sqlite3_stmt	*stmt;
+
+	stmt = db_get_statement ("pendingActionsLoadStmt");
+	sqlite3_bind_text (stmt, 1, nodeId, -1, SQLITE_TRANSIENT);
+
+	while (sqlite3_step (stmt) == SQLITE_ROW) {
+		pendingActionPtr action = g_new0 (struct pendingAction, 1);
+		action->id = sqlite3_column_int64 (stmt, 0);
+		action->type = sqlite3_column_int (stmt, 1);
+		action->guid = g_strdup (sqlite3_column_text (stmt, 2));
+		action->feedUrl = g_strdup (sqlite3_column_text (stmt, 3));
+		actions = g_slist_prepend (actions, action);
+	}
+
+	sqlite3_finalize (stmt);
+
+	return g_slist_reverse (actions);
 }
 
 void
@@ -1636,3 +2462,97 @@ db_node_cleanup (nodePtr root)
 
 	sqlite3_finalize (stmt);
 }
+
+/* Hits refresh the LRU time at most this often to avoid a write per hit */
+#define HTML_CACHE_TOUCH_INTERVAL	3600
+
+gchar *
+db_html_cache_load (gulong id, const gchar *digest)
+{
+	sqlite3_stmt	*stmt;
+	gchar		*html = NULL;
+	time_t		now;
+
+	stmt = db_get_statement ("htmlCacheLoadStmt");
+	sqlite3_bind_int  (stmt, 1, id);
+	sqlite3_bind_text (stmt, 2, digest, -1, SQLITE_TRANSIENT);
+	if (SQLITE_ROW == sqlite3_step (stmt))
+		html = g_strdup (sqlite3_column_text (stmt, 0));
+	sqlite3_finalize (stmt);
+
+	if (!html)
+		return NULL;
+
+	now = time (NULL);
+	stmt = db_get_statement ("htmlCacheTouchStmt");
+	sqlite3_bind_int  (stmt, 1, now);
+	sqlite3_bind_int  (stmt, 2, id);
+	sqlite3_bind_text (stmt, 3, digest, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int  (stmt, 4, now - HTML_CACHE_TOUCH_INTERVAL);
+	if (SQLITE_DONE != sqlite3_step (stmt))
+		g_warning ("updating rendered HTML of item %lu failed (%s)", id, sqlite3_errmsg (db));
+	sqlite3_finalize (stmt);
+
+	return html;
+}
+
+/* Drops the least recently used renderings until the cache fits maxSize */
+static void
+db_html_cache_trim (guint64 maxSize)
+{
+	sqlite3_stmt	*stmt;
+	guint64		size = 0;
+	gint		count = 0, evict;
+
+	stmt = db_get_statement ("htmlCacheSizeStmt");
+	if (SQLITE_ROW == sqlite3_step (stmt)) {
+		size = (guint64)sqlite3_column_double (stmt, 0);
+		count = sqlite3_column_int (stmt, 1);
+	}
+	sqlite3_finalize (stmt);
+
+	if (size <= maxSize || !count)
+		return;
+
+	/* Estimate the number of rows to drop from the average size */
+	evict = (gint)((size - maxSize) / (size / count)) + 1;
+	debug3 (DEBUG_DB, "HTML cache: %" G_GUINT64_FORMAT " bytes in %d renderings, dropping %d", size, count, evict);
+
+	stmt = db_get_statement ("htmlCacheEvictStmt");
+	sqlite3_bind_int (stmt, 1, evict);
+	if (SQLITE_DONE != sqlite3_step (stmt))
+		g_warning ("trimming the HTML cache failed (%s)", sqlite3_errmsg (db));
+	sqlite3_finalize (stmt);
+}
+
+void
+db_html_cache_store (GSList *entries, guint64 maxSize)
+{
+	sqlite3_stmt	*stmt;
+	GSList		*iter;
+	time_t		now = time (NULL);
+
+	if (!entries)
+		return;
+
+	debug_start_measurement (DEBUG_DB);
+	db_begin_transaction ();
+
+	for (iter = entries; iter; iter = g_slist_next (iter)) {
+		htmlCacheEntryPtr entry = (htmlCacheEntryPtr)iter->data;
+
+		stmt = db_get_statement ("htmlCacheStoreStmt");
+		sqlite3_bind_int  (stmt, 1, entry->id);
+		sqlite3_bind_text (stmt, 2, entry->digest, -1, SQLITE_TRANSIENT);
+		sqlite3_bind_text (stmt, 3, entry->html, -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int  (stmt, 4, now);
+		if (SQLITE_DONE != sqlite3_step (stmt))
+			g_warning ("storing rendered HTML of item %lu failed (%s)", entry->id, sqlite3_errmsg (db));
+		sqlite3_finalize (stmt);
+	}
+
+	db_html_cache_trim (maxSize);
+
+	db_end_transaction ();
+	debug_end_measurement (DEBUG_DB, "HTML cache store");
+}
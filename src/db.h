@@ -25,6 +25,7 @@
 
 #include "item.h"
 #include "itemset.h"
+#include "node_view.h"
 #include "subscription.h"
 #include "update.h"
 
@@ -49,6 +50,18 @@ void    db_deinit (void);
  */
 itemSetPtr	db_itemset_load (const gchar *id);
 
+/**
+ * Loads the items of all feeds below the given folder node,
+ * newest first.
+ *
+ * @param id		the folder node id
+ * @param unreadOnly	TRUE to load unread items only
+ * @param limit		maximum number of items (0 for no limit)
+ *
+ * @returns a newly allocated item set, must be freed using itemset_free()
+ */
+itemSetPtr	db_folder_load (const gchar *id, gboolean unreadOnly, guint limit);
+
 /**
  * Removes all items of the given item set from the DB.
  *
@@ -82,6 +95,61 @@ guint	db_itemset_get_unread_count (const gchar *id);
  */
 guint   db_itemset_get_item_count (const gchar *id);
 
+/**
+ * Returns the number of flagged items for the given item set.
+ *
+ * @param id	the node id
+ *
+ * @returns the number of flagged items
+ */
+guint   db_itemset_get_flag_count (const gchar *id);
+
+/**
+ * Loads all items of the given item set in one query for
+ * comparison with newly downloaded items. The items are
+ * loaded without metadata.
+ *
+ * @param id	the node id
+ *
+ * @returns a list of items (to be free'd using item_unload())
+ */
+GList *	db_itemset_load_items_for_merge (const gchar *id);
+
+/**
+ * Returns the ids of the oldest unflagged items of the
+ * given item set ordered by date and item id.
+ *
+ * @param id		the node id
+ * @param count		maximum number of ids to return
+ * @param keepId	item id never to return (or 0)
+ *
+ * @returns a list of item ids
+ */
+GList *	db_itemset_get_oldest (const gchar *id, guint count, gulong keepId);
+
+/**
+ * Removes the items returned by db_itemset_get_oldest() for
+ * the same parameters (and their comments) with a single
+ * statement.
+ *
+ * @param id		the node id
+ * @param count		maximum number of items to remove
+ * @param keepId	item id never to remove (or 0)
+ */
+void	db_itemset_remove_oldest (const gchar *id, guint count, gulong keepId);
+
+/**
+ * Marks all unread items of the given item set as read with one
+ * statement and propagates the read state to unread duplicates
+ * in other item sets with a second one.
+ *
+ * @param id		the node id
+ * @param duplicates	returns the ids of the duplicates marked read
+ *
+ * @returns the ids of the items of the set that were marked read
+ */
+GList *	db_itemset_mark_all_read (const gchar *id, GList **duplicates);
+
 /**
  * Returns a batch of items starting with the given
  * offset and no more than the given limit. 
@@ -107,6 +175,29 @@ gboolean        db_itemset_get (itemSetPtr itemSet, gulong offset, guint limit);
  */
 itemPtr	db_item_load(gulong id);
 
+/**
+ * Loads the item fields shown in the item list: id, title, read
+ * and flag state, date, node id and the enclosure flag. The
+ * description and metadata are not loaded.
+ *
+ * @param ids		array of item ids
+ * @param count		number of ids
+ *
+ * @returns a list of items (to be free'd using item_unload()),
+ * items not found are missing in the list
+ */
+GSList * db_item_list_load (const gulong *ids, guint count);
+
+/**
+ * Sorts item ids in the order of the item list columns.
+ *
+ * @param ids		array of item ids, sorted in place
+ * @param count		number of ids
+ * @param sortType	the sort column
+ * @param reversed	TRUE for descending order
+ */
+void	db_item_list_sort (gulong *ids, guint count, nodeViewSortType sortType, gboolean reversed);
+
 /**
  * Updates all attributes of the item in the DB
  *
@@ -137,6 +228,21 @@ void    db_item_state_update (itemPtr item);
  */
 GSList * db_item_get_duplicates(const gchar *guid);
 
+/**
+ * Sets the read state of all duplicates of an item that do not
+ * have it yet (and resets their updated flag) with a single
+ * statement.
+ *
+ * @param guid		the item GUID
+ * @param id		the id of the item itself (to be skipped)
+ * @param newState	the new read state
+ * @param nodeIds	returns the ids of all affected nodes (to be
+ *			free'd using g_free)
+ *
+ * @returns a list of the ids of the changed items
+ */
+GSList * db_item_duplicates_set_read_state (const gchar *guid, gulong id, gboolean newState, GSList **nodeIds);
+
 /**
  * Returns a list of node ids containing an item with the given GUID. 
  *
@@ -146,6 +252,27 @@ GSList * db_item_get_duplicates(const gchar *guid);
  */
 GSList * db_item_get_duplicate_nodes(const gchar *guid);
 
+/** remote state of an item as reported by an online source */
+typedef struct itemRemoteState {
+	gchar		*sourceId;	/**< the remote item id (the item GUID) */
+	gboolean	read;		/**< remote read state */
+	gint		flag;		/**< remote flag (starred) state, -1 if unknown */
+	gulong		itemId;		/**< local item id, set for changed items only */
+} *itemRemoteStatePtr;
+
+/**
+ * Compares a batch of remote item states with the items of the
+ * given node in a single query and returns the states that differ
+ * from the DB. Items not known to the DB are ignored.
+ *
+ * @param id		the node id
+ * @param states	list of itemRemoteStatePtr
+ *
+ * @returns a list of changed states (a subset of the passed states,
+ * with itemId set, to be free'd using g_slist_free)
+ */
+GSList * db_itemset_get_state_changes (const gchar *id, GSList *states);
+
 /**
  * Returns an item set of all items for the given search folder id.
  *
@@ -208,6 +335,71 @@ void db_subscription_remove (const gchar *id);
 void db_node_update (nodePtr node);
 
 
+/** a remote action of an online source not yet confirmed by the server */
+typedef struct pendingAction {
+	gint64	id;		/**< journal id */
+	gint	type;		/**< source specific action type */
+	gchar	*guid;		/**< item the action applies to (or NULL) */
+	gchar	*feedUrl;	/**< feed the action applies to */
+} *pendingActionPtr;
+
+/**
+ * Adds an action to the journal of the given online source.
+ *
+ * @param nodeId	the source root node id
+ * @param type		source specific action type
+ * @param guid		the item guid (or NULL)
+ * @param feedUrl	the feed URL
+ *
+ * @returns the journal id (0 on failure)
+ */
+gint64 db_pending_action_add (const gchar *nodeId, gint type, const gchar *guid, const gchar *feedUrl);
+
+/**
+ * Removes an action from the journal once it was sent or dropped.
+ *
+ * @param id		the journal id
+ */
+void db_pending_action_remove (gint64 id);
+
+/**
+ * Returns all journaled actions of the given online source
+ * in the order they were added.
+ *
+ * @param nodeId	the source root node id
+ *
+ * @returns a list of pendingActionPtr (to be free'd using g_free,
+ * including the guid and feedUrl members)
+ */
+GSList * db_pending_actions_load (const gchar *nodeId);
+
+/** a rendered item to be kept across sessions */
+typedef struct htmlCacheEntry {
+	gulong	id;		/**< item id */
+	gchar	*digest;	/**< digest of everything the rendering depends on */
+	gchar	*html;		/**< the rendered HTML */
+} *htmlCacheEntryPtr;
+
+/**
+ * Looks up a rendering of the given item. Renderings are dropped
+ * when the item is updated or removed.
+ *
+ * @param id		the item id
+ * @param digest	the rendering digest (see item_render_get_digest())
+ *
+ * @returns the rendered HTML (to be free'd using g_free) or NULL
+ */
+gchar * db_html_cache_load (gulong id, const gchar *digest);
+
+/**
+ * Stores item renderings in one transaction and drops the least
+ * recently used ones once the cache exceeds the given size.
+ *
+ * @param entries	list of htmlCacheEntryPtr (not free'd)
+ * @param maxSize	cache size limit in bytes
+ */
+void db_html_cache_store (GSList *entries, guint64 maxSize);
+
 /**
  * Clean old nodes from the DB by comparing all DB nodes
  * against the OPML feed list.
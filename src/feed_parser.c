@@ -110,7 +110,8 @@ feed_free_parser_ctxt (feedParserCtxtPtr ctxt)
 static void
 feed_parser_auto_discover (feedParserCtxtPtr ctxt)
 {
-	gchar	*source;
+	GSList	*links, *iter;
+	gchar	*source = NULL;
 	
 	if (ctxt->feed->parseErrors)
 		g_string_truncate (ctxt->feed->parseErrors, 0);
@@ -119,10 +120,17 @@ feed_parser_auto_discover (feedParserCtxtPtr ctxt)
 		
 	debug1 (DEBUG_UPDATE, "Starting feed auto discovery (%s)", subscription_get_source (ctxt->subscription));
 	
-	source = html_auto_discover_feed (ctxt->data, subscription_get_source (ctxt->subscription));
+	links = html_auto_discover_feeds (ctxt->data, subscription_get_source (ctxt->subscription));
 
-	/* FIXME: we only need the !g_str_equal as a workaround after a 404 */
-	if (source && !g_str_equal (source, subscription_get_source (ctxt->subscription))) {
+	/* Subscribe to the first link that differs from the current source,
+	   a link equal to it is only returned as a workaround after a 404 */
+	for (iter = links; iter && !source; iter = g_slist_next (iter)) {
+		if (!g_str_equal (iter->data, subscription_get_source (ctxt->subscription)))
+			source = g_strdup (iter->data);
+	}
+	g_slist_free_full (links, g_free);
+
+	if (source) {
 		debug1 (DEBUG_UPDATE, "Discovered link: %s", source);
 		ctxt->failed = FALSE;
 		subscription_set_source (ctxt->subscription, source);
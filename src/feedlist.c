@@ -322,6 +322,7 @@ feedlist_mark_all_read (nodePtr node)
 		return;
 
 	feedlist_reset_new_item_count ();
+	node_update_counters_flush ();	/* unread counters decide which nodes to process */
 
 	if (node != ROOTNODE)
 		node_mark_all_read (node);
@@ -551,6 +552,9 @@ feedlist_unread_scan (nodePtr folder)
 nodePtr
 feedlist_find_unread_feed (nodePtr folder)
 {
+	/* the scan relies on up-to-date unread counters */
+	node_update_counters_flush ();
+
 	scanState = UNREAD_SCAN_INIT;
 	return feedlist_unread_scan (folder);
 }
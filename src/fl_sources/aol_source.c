@@ -31,6 +31,7 @@
 #include "common.h"
 #include "debug.h"
 #include "feedlist.h"
+#include "net_monitor.h"
 #include "item_state.h"
 #include "metadata.h"
 #include "node.h"
@@ -48,6 +49,17 @@
 /** default AOL reader subscription list update interval = once a day */
 #define AOL_SOURCE_UPDATE_INTERVAL 60*60*24
 
+/* replay edits that were queued while offline */
+static void
+aol_source_online_status_changed (gpointer instance, gboolean online, gpointer userdata)
+{
+	AolSourcePtr source = (AolSourcePtr) userdata;
+
+	/* without login the next update will log in and process the queue */
+	if (online && source->loginState == AOL_SOURCE_STATE_ACTIVE)
+		aol_source_edit_process (source);
+}
+
 /** create a AOL source with given node as root */ 
 static AolSourcePtr
 aol_source_new (nodePtr node) 
@@ -57,6 +69,15 @@ aol_source_new (nodePtr node)
 	source->actionQueue = g_queue_new (); 
 	source->loginState = AOL_SOURCE_STATE_NONE; 
 	source->lastTimestampMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	source->lastUnreadCountMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	source->pendingTimestampMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	source->pendingUnreadCountMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	g_signal_connect (network_monitor_get (), "online-status-changed",
+	                  G_CALLBACK (aol_source_online_status_changed), source);
+
+	/* actions not confirmed before the last shutdown */
+	aol_source_edit_restore (source);
 	
 	return source;
 }
@@ -68,10 +89,14 @@ aol_source_free (AolSourcePtr source)
 		return;
 
 	update_job_cancel_by_owner (source);
+	g_signal_handlers_disconnect_by_data (network_monitor_get (), source);
 	
 	g_free (source->authHeaderValue);
 	g_queue_free (source->actionQueue) ;
 	g_hash_table_unref (source->lastTimestampMap);
+	g_hash_table_unref (source->lastUnreadCountMap);
+	g_hash_table_unref (source->pendingTimestampMap);
+	g_hash_table_unref (source->pendingUnreadCountMap);
 	g_free (source);
 }
 
@@ -190,6 +215,10 @@ aol_source_auto_update (nodePtr node)
 	if (source->loginState == AOL_SOURCE_STATE_IN_PROGRESS) 
 		return; /* the update will start automatically anyway */
 
+	/* send edits again that failed before */
+	if (source->loginState == AOL_SOURCE_STATE_ACTIVE)
+		aol_source_edit_retry (source);
+
 	g_get_current_time (&now);
 	
 	/* do daily updates for the feed list and feed updates according to the default interval */
@@ -32,6 +32,13 @@ typedef struct AolSource {
 	GQueue		*actionQueue;
 	gint		loginState;	/**< The current login state */
 	gint		authFailures;	/**< Number of authentication failures */
+	guint		editsQueued;	/**< Number of edits journaled since startup */
+	guint		editsReplayed;	/**< Number of journaled edits restored on startup */
+	guint		editsFlushed;	/**< Number of edits confirmed by the server */
+	guint		editsDropped;	/**< Number of edits cancelled out or rejected */
+	gint64		editFlushTime;	/**< Total time (in microseconds) those edits took */
+	gint64		editRetryTime;	/**< Monotonic time after which failed edits are sent again (or 0) */
+	guint		editRetryDelay;	/**< Current delay (in seconds) between edit retries */
 
 	/**
 	 * A map from a subscription source to a timestamp when it was last 
@@ -39,6 +46,20 @@ typedef struct AolSource {
 	 */
 	GHashTable      *lastTimestampMap; 
 
+	/**
+	 * A map from a subscription source to its unread count
+	 * (plus one) provided by remote when it was last updated.
+	 */
+	GHashTable	*lastUnreadCountMap;
+
+	/**
+	 * Unread counts (plus one) and newest item timestamps of feeds
+	 * updated by a quick update. They are moved to the maps above
+	 * once the feed update succeeded.
+	 */
+	GHashTable	*pendingUnreadCountMap;
+	GHashTable	*pendingTimestampMap;
+
 	/**
 	 * A timestamp when the last Quick update took place.
 	 */
@@ -27,97 +27,46 @@
 #include "subscription.h"
 #include "common.h"
 #include "feedlist.h"
+#include "db.h"
+#include "net_monitor.h"
 
 
 #include "aol_source.h"
 #include "aol_source_edit.h"
+#include "fl_sources/google_reader_api_edit.h"
 #include "config.h"
 #include <libxml/xmlwriter.h>
 #include <libxml/xmlreader.h>
 #include <glib/gstdio.h>
 #include "xml.h"
 
-/**
- * A structure to indicate an edit to the Google Reader "database".
- * These edits are put in a queue and processed in sequential order
- * so that google does not end up processing the requests in an 
- * unintended order.
- */
-typedef struct AolSourceAction {
-	/**
-	 * The guid of the item to edit. This will be ignored if the 
-	 * edit is acting on an subscription rather than an item.
-	 */
-	gchar* guid;
-
-	/**
-	 * A MANDATORY feed url to containing the item, or the url of the 
-	 * subscription to edit. 
-	 */
-	gchar* feedUrl;
-
-	/**
-	 * The source type. Currently known types are "feed" and "user".
-	 * "user" sources are used, for example, for items that are links (as
-	 * opposed to posts) in broadcast-friends. The unique id of the source
-	 * is of the form <feedUrlType>/<feedUrl>.
-	 */
-	gchar* feedUrlType; 
-
-	/**
-	 * A callback function on completion of the edit.
-	 */
-	void (*callback) (AolSourcePtr source, struct AolSourceAction* edit, gboolean success);
-
-	/**
-	 * The type of this AolSourceAction.
-	 */
-	int actionType ; 
-} *AolSourceActionPtr ; 
-
-enum { 
-	EDIT_ACTION_MARK_READ,
-	EDIT_ACTION_MARK_UNREAD,
-	EDIT_ACTION_TRACKING_MARK_UNREAD, /**< every UNREAD request, should be followed by tracking-kept-unread */
-	EDIT_ACTION_MARK_STARRED,
-	EDIT_ACTION_MARK_UNSTARRED,
-	EDIT_ACTION_ADD_SUBSCRIPTION,
-	EDIT_ACTION_REMOVE_SUBSCRIPTION
-} ;
-		
-
-typedef struct AolSourceAction* editPtr ;
+/** Edits are queued as shared Google Reader API actions */
+typedef googleReaderApiActionPtr AolSourceActionPtr;
 
 typedef struct AolSourceActionCtxt { 
 	gchar   *nodeId ;
-	AolSourceActionPtr action; 
+	GSList  *actions;	/**< all actions sent with one request */
+	gint64  started;	/**< time the request was sent */
 } *AolSourceActionCtxtPtr; 
 
+/** Delay (in seconds) before retrying a failed edit request */
+#define EDIT_RETRY_DELAY_MIN 30
 
-static void aol_source_edit_push (AolSourcePtr source, AolSourceActionPtr action, gboolean head);
+/** Maximum delay (in seconds) between retries of failed edit requests */
+#define EDIT_RETRY_DELAY_MAX 3600
 
 
-static AolSourceActionPtr 
-aol_source_action_new (void)
-{
-	AolSourceActionPtr action = g_slice_new0 (struct AolSourceAction);
-	return action;
-}
+static void aol_source_edit_push (AolSourcePtr source, AolSourceActionPtr action, gboolean head);
+static void aol_source_edit_push_ (AolSourcePtr source, AolSourceActionPtr action, gboolean head);
 
-static void 
-aol_source_action_free (AolSourceActionPtr action)
-{ 
-	g_free (action->guid);
-	g_free (action->feedUrl);
-	g_slice_free (struct AolSourceAction, action);
-}
 
 static AolSourceActionCtxtPtr
-aol_source_action_context_new(AolSourcePtr source, AolSourceActionPtr action)
+aol_source_action_context_new(AolSourcePtr source, GSList *actions)
 {
 	AolSourceActionCtxtPtr ctxt = g_slice_new0(struct AolSourceActionCtxt);
 	ctxt->nodeId = g_strdup(source->root->id);
-	ctxt->action = action;
+	ctxt->actions = actions;
+	ctxt->started = g_get_monotonic_time ();
 	return ctxt;
 }
 
@@ -128,34 +77,98 @@ aol_source_action_context_free(AolSourceActionCtxtPtr ctxt)
 	g_slice_free(struct AolSourceActionCtxt, ctxt);
 }
 
+static void
+aol_source_edit_log_summary (AolSourcePtr source, const gchar *event)
+{
+	debug6 (DEBUG_UPDATE, "aol_source: %s: %u queued, %u replayed, %u flushed, %u dropped, %u still queued",
+	        event, source->editsQueued, source->editsReplayed, source->editsFlushed, source->editsDropped,
+	        g_queue_get_length (source->actionQueue));
+}
+
+/* the actions stay queued until the next auto update after the delay */
+static void
+aol_source_edit_schedule_retry (AolSourcePtr source)
+{
+	source->editRetryDelay = CLAMP (source->editRetryDelay * 2, EDIT_RETRY_DELAY_MIN, EDIT_RETRY_DELAY_MAX);
+	source->editRetryTime = g_get_monotonic_time () + (gint64)source->editRetryDelay * G_USEC_PER_SEC;
+	debug1 (DEBUG_UPDATE, "aol_source: retrying queued edits in %us", source->editRetryDelay);
+}
+
+void
+aol_source_edit_retry (AolSourcePtr source)
+{
+	if (!source->editRetryTime || g_get_monotonic_time () < source->editRetryTime)
+		return;
+
+	source->editRetryTime = 0;
+	aol_source_edit_process (source);
+}
+
 static void
 aol_source_edit_action_complete (const struct updateResult* const result, gpointer userdata, updateFlags flags) 
 { 
 	AolSourceActionCtxtPtr     editCtxt = (AolSourceActionCtxtPtr) userdata; 
 	nodePtr                       node = node_from_id (editCtxt->nodeId);
 	AolSourcePtr               source; 
-	AolSourceActionPtr         action = editCtxt->action ;
+	GSList                        *actions = editCtxt->actions;
+	GSList                        *iter;
+	gboolean                      success;
+	gint64                        duration = g_get_monotonic_time () - editCtxt->started;
 	
 	aol_source_action_context_free (editCtxt);
 
 	if (!node) {
-		aol_source_action_free (action);
+		g_slist_free_full (actions, (GDestroyNotify)google_reader_api_action_free);
 		return; /* probably got deleted before this callback */
 	} 
 	source = (AolSourcePtr) node->data;
-		
-	if (result->data == NULL || !g_str_equal (result->data, "OK")) {
-		if (action->callback) 
-			(*action->callback) (source, action, FALSE);
+
+	/* Without an answer the actions stay journaled and are put
+	   back to be sent again on the next edit or when going online */
+	if (!result->data || result->httpstatus != 200) {
+		debug1 (DEBUG_UPDATE, "aol_source: edit request failed (HTTP status %d), keeping actions queued", result->httpstatus);
+		actions = g_slist_reverse (actions);
+		for (iter = actions; iter; iter = g_slist_next (iter))
+			aol_source_edit_push_ (source, (AolSourceActionPtr)iter->data, TRUE);
+		g_slist_free (actions);
+		aol_source_edit_log_summary (source, "flush failed");
+		aol_source_edit_schedule_retry (source);
+		return;
+	}
+
+	success = g_str_equal (result->data, "OK");
+	if (!success)
 		debug1 (DEBUG_UPDATE, "The edit action failed with result: %s\n", result->data);
-		aol_source_action_free (action);
-		return; /** @todo start a timer for next processing */
+
+	/* rejected actions would fail again, so they are dropped too */
+	for (iter = actions; iter; iter = g_slist_next (iter)) {
+		AolSourceActionPtr action = (AolSourceActionPtr)iter->data;
+		db_pending_action_remove (action->journalId);
+		if (action->callback)
+			(*action->callback) (source, action, success);
+	}
+
+	if (success)
+		source->editsFlushed += g_slist_length (actions);
+	else
+		source->editsDropped += g_slist_length (actions);
+	source->editFlushTime += duration;
+	debug4 (DEBUG_UPDATE, "aol_source: flushed %u actions in %" G_GINT64_FORMAT "ms (%.1f/s overall), %u still queued",
+	        g_slist_length (actions), duration / 1000,
+	        source->editsFlushed * (gdouble)G_USEC_PER_SEC / MAX (source->editFlushTime, 1),
+	        g_queue_get_length (source->actionQueue));
+	aol_source_edit_log_summary (source, success?"flushed":"rejected");
+
+	g_slist_free_full (actions, (GDestroyNotify)google_reader_api_action_free);
+
+	/* the rest of the queue is sent later, it might be rejected too */
+	if (!success) {
+		aol_source_edit_schedule_retry (source);
+		return;
 	}
-	
-	if (action->callback)
-		action->callback (source, action, TRUE);
 
-	aol_source_action_free (action);
+	source->editRetryDelay = 0;
+	source->editRetryTime = 0;
 
 	/* process anything else waiting on the edit queue */
 	aol_source_edit_process (source);
@@ -187,68 +200,82 @@ aol_source_api_remove_subscription (AolSourceActionPtr action, updateRequestPtr
 }
 
 static void 
-aol_source_api_edit_tag (AolSourceActionPtr action, updateRequestPtr request, const gchar*token) 
+aol_source_api_edit_tag (GSList *actions, updateRequestPtr request, const gchar*token) 
 {
+	AolSourceActionPtr action = (AolSourceActionPtr)actions->data;
+	const gchar	*addTag = NULL, *removeTag = NULL;
+	GString		*postdata;
+	gchar		*escaped;
+
 	update_request_set_source (request, AOL_READER_EDIT_TAG_URL); 
 
-	const gchar* prefix = "feed" ; 
-	gchar* s_escaped = g_uri_escape_string (action->feedUrl, NULL, TRUE);
-	gchar* a_escaped = NULL ;
-	gchar* i_escaped = g_uri_escape_string (action->guid, NULL, TRUE);
-	gchar* postdata = NULL ;
+	switch (action->actionType) {
+		case EDIT_ACTION_MARK_UNREAD:
+			addTag = AOL_READER_TAG_KEPT_UNREAD;
+			removeTag = AOL_READER_TAG_READ;
+			break;
+		case EDIT_ACTION_MARK_READ:
+			addTag = AOL_READER_TAG_READ;
+			break;
+		case EDIT_ACTION_TRACKING_MARK_UNREAD:
+			addTag = AOL_READER_TAG_TRACKING_KEPT_UNREAD;
+			break;
+		case EDIT_ACTION_MARK_STARRED:
+			addTag = AOL_READER_TAG_STARRED;
+			break;
+		case EDIT_ACTION_MARK_UNSTARRED:
+			removeTag = AOL_READER_TAG_STARRED;
+			break;
+		default:
+			g_assert (FALSE);
+	}
 
-	/*
-	 * If the source of the item is a feed then the source *id* will be of
-	 * the form tag:google.com,2005:reader/feed/http://foo.com/bar
-	 * If the item is a shared link it is of the form
-	 * tag:google.com,2005:reader/user/<sharer's-id>/source/com.google/link
-	 * It is possible that there are items other thank link that has
-	 * the ../user/.. id. The GR API requires the strings after ..:reader/
-	 * while AolSourceAction only gives me after :reader/feed/ (or 
-	 * :reader/user/ as the case might be). I therefore need to guess
-	 * the prefix ('feed/' or 'user/') from just this information. 
-	 */
+	/* All actions in the list share the same tag operation, the API
+	   accepts many item ids with their sources in a single call */
+	postdata = g_string_new (NULL);
+	for (; actions; actions = g_slist_next (actions)) {
+		const gchar *prefix = "feed";
 
-	if (strstr(action->feedUrl, "://") == NULL) 
-		prefix = "user" ;
+		action = (AolSourceActionPtr)actions->data;
 
-	if (action->actionType == EDIT_ACTION_MARK_UNREAD) {
-		a_escaped = g_uri_escape_string (AOL_READER_TAG_KEPT_UNREAD, NULL, TRUE);
-		gchar *r_escaped = g_uri_escape_string (AOL_READER_TAG_READ, NULL, TRUE);
-		postdata = g_strdup_printf (AOL_READER_EDIT_TAG_AR_TAG, i_escaped, prefix, s_escaped, a_escaped, r_escaped, token);
-		g_free (r_escaped);
-	}
-	else if (action->actionType == EDIT_ACTION_MARK_READ) { 
-		a_escaped = g_uri_escape_string (AOL_READER_TAG_READ, NULL, TRUE);
-		postdata = g_strdup_printf (AOL_READER_EDIT_TAG_ADD_TAG, i_escaped, prefix, s_escaped, a_escaped, token);
+		/*
+		 * If the source of the item is a feed then the source *id* will be of
+		 * the form tag:google.com,2005:reader/feed/http://foo.com/bar
+		 * If the item is a shared link it is of the form
+		 * tag:google.com,2005:reader/user/<sharer's-id>/source/com.google/link
+		 * It is possible that there are items other thank link that has
+		 * the ../user/.. id. The GR API requires the strings after ..:reader/
+		 * while AolSourceAction only gives me after :reader/feed/ (or 
+		 * :reader/user/ as the case might be). I therefore need to guess
+		 * the prefix ('feed/' or 'user/') from just this information. 
+		 */
+		if (strstr(action->feedUrl, "://") == NULL) 
+			prefix = "user" ;
+
+		escaped = g_uri_escape_string (action->guid, NULL, TRUE);
+		g_string_append_printf (postdata, "i=%s&", escaped);
+		g_free (escaped);
+
+		escaped = g_uri_escape_string (action->feedUrl, NULL, TRUE);
+		g_string_append_printf (postdata, "s=%s%%2F%s&", prefix, escaped);
+		g_free (escaped);
 	}
-	else if (action->actionType == EDIT_ACTION_TRACKING_MARK_UNREAD) {
-		a_escaped = g_uri_escape_string (AOL_READER_TAG_TRACKING_KEPT_UNREAD, NULL, TRUE);
-		postdata = g_strdup_printf (AOL_READER_EDIT_TAG_ADD_TAG, i_escaped, prefix, s_escaped, a_escaped, token);
-	}  
-	else if (action->actionType == EDIT_ACTION_MARK_STARRED) { 
-		a_escaped = g_uri_escape_string (AOL_READER_TAG_STARRED, NULL, TRUE) ;
-		postdata = g_strdup_printf (
-			AOL_READER_EDIT_TAG_ADD_TAG, i_escaped, prefix,
-			s_escaped, a_escaped, token);
+
+	if (addTag) {
+		escaped = g_uri_escape_string (addTag, NULL, TRUE);
+		g_string_append_printf (postdata, "a=%s&", escaped);
+		g_free (escaped);
 	}
-	else if (action->actionType == EDIT_ACTION_MARK_UNSTARRED) {
-		gchar* r_escaped = g_uri_escape_string(AOL_READER_TAG_STARRED, NULL, TRUE);
-		postdata = g_strdup_printf (
-			AOL_READER_EDIT_TAG_REMOVE_TAG, i_escaped, prefix,
-			s_escaped, r_escaped, token);
+	if (removeTag) {
+		escaped = g_uri_escape_string (removeTag, NULL, TRUE);
+		g_string_append_printf (postdata, "r=%s&", escaped);
+		g_free (escaped);
 	}
-	
-	else g_assert (FALSE);
-	
-	g_free (s_escaped);
-	g_free (a_escaped); 
-	g_free (i_escaped);
-	
-	debug1 (DEBUG_UPDATE, "aol_source: postdata [%s]", postdata);
+	g_string_append_printf (postdata, "ac=edit-tags&T=%s&async=true", token);
 
+	debug1 (DEBUG_UPDATE, "aol_source: postdata [%s]", postdata->str);
 
-	request->postdata = postdata;
+	request->postdata = g_string_free (postdata, FALSE);
 }
 
 static void
@@ -258,13 +285,9 @@ aol_source_edit_token_cb (const struct updateResult * const result, gpointer use
 	AolSourcePtr  source;
 	const gchar*     token;
 	AolSourceActionPtr          action;
+	GSList           *actions;
 	updateRequestPtr request; 
 
-	if (result->httpstatus != 200 || result->data == NULL) { 
-		/* FIXME: What is the behaviour that should go here? */
-		return;
-	}
-
 	node = node_from_id ((gchar*) userdata);
 	g_free (userdata);
 	
@@ -274,32 +297,36 @@ aol_source_edit_token_cb (const struct updateResult * const result, gpointer use
 	source = (AolSourcePtr) node->data;
 
 
-	token = result->data; 
-
 	if (!source || g_queue_is_empty (source->actionQueue))
 		return;
 
-	action = g_queue_peek_head (source->actionQueue);
+	/* nothing was popped from the queue yet */
+	if (result->httpstatus != 200 || result->data == NULL) {
+		debug1 (DEBUG_UPDATE, "aol_source: edit token request failed (HTTP status %d)", result->httpstatus);
+		aol_source_edit_schedule_retry (source);
+		return;
+	}
+
+	token = result->data; 
+
+	actions = google_reader_api_edit_pop_batch (source->actionQueue);
+	action = (AolSourceActionPtr)actions->data;
 
 	request = update_request_new ();
 	request->updateState = update_state_copy (source->root->subscription->updateState);
 	request->options = update_options_copy (source->root->subscription->updateOptions) ;
 	update_request_set_auth_value (request, source->authHeaderValue);
 
-	if (action->actionType == EDIT_ACTION_MARK_READ || 
-	    action->actionType == EDIT_ACTION_MARK_UNREAD || 
-	    action->actionType == EDIT_ACTION_TRACKING_MARK_UNREAD ||
-	    action->actionType == EDIT_ACTION_MARK_STARRED || 
-	    action->actionType == EDIT_ACTION_MARK_UNSTARRED) 
-		aol_source_api_edit_tag (action, request, token);
+	if (google_reader_api_action_is_edit_tag (action))
+		aol_source_api_edit_tag (actions, request, token);
 	else if (action->actionType == EDIT_ACTION_ADD_SUBSCRIPTION ) 
 		aol_source_api_add_subscription (action, request, token);
 	else if (action->actionType == EDIT_ACTION_REMOVE_SUBSCRIPTION )
 		aol_source_api_remove_subscription (action, request, token) ;
 
-	update_execute_request (source, request, aol_source_edit_action_complete, aol_source_action_context_new(source, action), 0);
+	debug2 (DEBUG_UPDATE, "aol_source: sending %u actions, %u still queued", g_slist_length (actions), g_queue_get_length (source->actionQueue));
 
-	action = g_queue_pop_head (source->actionQueue);
+	update_execute_request (source, request, aol_source_edit_action_complete, aol_source_action_context_new(source, actions), 0);
 }
 
 void
@@ -310,6 +337,10 @@ aol_source_edit_process (AolSourcePtr source)
 	g_assert (source);
 	if (g_queue_is_empty (source->actionQueue))
 		return;
+
+	/* the journal keeps the actions until we are online again */
+	if (!network_monitor_is_online ())
+		return;
 	
 	/*
  	* Google reader has a system of tokens. So first, I need to request a 
@@ -340,6 +371,8 @@ aol_source_edit_push (AolSourcePtr source, AolSourceActionPtr action, gboolean h
 {
 	g_assert (source);
 	nodePtr root = source->root;
+	action->journalId = db_pending_action_add (root->id, action->actionType, action->guid, action->feedUrl);
+	source->editsQueued++;
 	aol_source_edit_push_ (source, action, head);
 
 	/** @todo any flags I should specify? */
@@ -350,7 +383,7 @@ aol_source_edit_push (AolSourcePtr source, AolSourceActionPtr action, gboolean h
 }
 
 static void 
-update_read_state_callback (AolSourcePtr source, AolSourceActionPtr action, gboolean success) 
+update_read_state_callback (gpointer data, AolSourceActionPtr action, gboolean success) 
 {
 	if (success) {
 		// FIXME: call item_read_state_changed (item, newState);
@@ -362,13 +395,19 @@ update_read_state_callback (AolSourcePtr source, AolSourceActionPtr action, gboo
 void
 aol_source_edit_mark_read (AolSourcePtr source, const gchar *guid, const gchar *feedUrl,	gboolean newStatus)
 {
-	AolSourceActionPtr action = aol_source_action_new ();
+	AolSourceActionPtr action = google_reader_api_action_new ();
 
 	action->guid = g_strdup (guid);
 	action->feedUrl = g_strdup (feedUrl);
 	action->actionType = newStatus ? EDIT_ACTION_MARK_READ :
 	                           EDIT_ACTION_MARK_UNREAD;
 	action->callback = update_read_state_callback;
+
+	/* a pending opposite change was not sent yet, so both can be dropped */
+	if (google_reader_api_edit_cancel_opposite (source, source->actionQueue, action, &source->editsDropped)) {
+		google_reader_api_action_free (action);
+		return;
+	}
 	
 	aol_source_edit_push (source, action, FALSE);
 
@@ -378,7 +417,7 @@ aol_source_edit_mark_read (AolSourcePtr source, const gchar *guid, const gchar *
 		 * I also need to mark it as tracking-kept-unread in a separate
 		 * network call.
 		 */
-		action = aol_source_action_new ();
+		action = google_reader_api_action_new ();
 		action->guid = g_strdup (guid);
 		action->feedUrl = g_strdup (feedUrl);
 		action->actionType = EDIT_ACTION_TRACKING_MARK_UNREAD;
@@ -387,7 +426,7 @@ aol_source_edit_mark_read (AolSourcePtr source, const gchar *guid, const gchar *
 }
 
 static void
-update_starred_state_callback(AolSourcePtr source, AolSourceActionPtr action, gboolean success) 
+update_starred_state_callback(gpointer data, AolSourceActionPtr action, gboolean success) 
 {
 	if (success) {
 		// FIXME: call item_flag_changed (item, newState);
@@ -399,19 +438,26 @@ update_starred_state_callback(AolSourcePtr source, AolSourceActionPtr action, gb
 void
 aol_source_edit_mark_starred (AolSourcePtr source, const gchar *guid, const gchar *feedUrl, gboolean newStatus)
 {
-	AolSourceActionPtr action = aol_source_action_new ();
+	AolSourceActionPtr action = google_reader_api_action_new ();
 
 	action->guid = g_strdup (guid);
 	action->feedUrl = g_strdup (feedUrl);
 	action->actionType = newStatus ? EDIT_ACTION_MARK_STARRED : EDIT_ACTION_MARK_UNSTARRED;
 	action->callback = update_starred_state_callback;
+
+	if (google_reader_api_edit_cancel_opposite (source, source->actionQueue, action, &source->editsDropped)) {
+		google_reader_api_action_free (action);
+		return;
+	}
 	
 	aol_source_edit_push (source, action, FALSE);
 }
 
 static void 
-update_subscription_list_callback(AolSourcePtr source, AolSourceActionPtr action, gboolean success) 
+update_subscription_list_callback(gpointer data, AolSourceActionPtr action, gboolean success) 
 {
+	AolSourcePtr source = (AolSourcePtr) data;
+
 	if (success) { 
 		/*
 		 * It is possible that Google changed the name of the URL that
@@ -437,7 +483,7 @@ update_subscription_list_callback(AolSourcePtr source, AolSourceActionPtr action
 void 
 aol_source_edit_add_subscription (AolSourcePtr source, const gchar* feedUrl)
 {
-	AolSourceActionPtr action = aol_source_action_new () ;
+	AolSourceActionPtr action = google_reader_api_action_new () ;
 	action->actionType = EDIT_ACTION_ADD_SUBSCRIPTION; 
 	action->feedUrl = g_strdup (feedUrl);
 	action->callback = update_subscription_list_callback;
@@ -445,8 +491,10 @@ aol_source_edit_add_subscription (AolSourcePtr source, const gchar* feedUrl)
 }
 
 static void
-aol_source_edit_remove_callback (AolSourcePtr source, AolSourceActionPtr action, gboolean success)
+aol_source_edit_remove_callback (gpointer data, AolSourceActionPtr action, gboolean success)
 {
+	AolSourcePtr source = (AolSourcePtr) data;
+
 	if (success) {	
 		/* 
 		 * The node was removed from the feedlist, but could have
@@ -467,7 +515,7 @@ aol_source_edit_remove_callback (AolSourcePtr source, AolSourceActionPtr action,
 
 void aol_source_edit_remove_subscription (AolSourcePtr source, const gchar* feedUrl) 
 {
-	AolSourceActionPtr action = aol_source_action_new (); 
+	AolSourceActionPtr action = google_reader_api_action_new (); 
 	action->actionType = EDIT_ACTION_REMOVE_SUBSCRIPTION;
 	action->feedUrl = g_strdup (feedUrl);
 	action->callback = aol_source_edit_remove_callback;
@@ -485,3 +533,53 @@ gboolean aol_source_edit_is_in_queue (AolSourcePtr source, const gchar* guid)
 	}
 	return FALSE;
 }
+
+void
+aol_source_edit_restore (AolSourcePtr source)
+{
+	GSList	*actions, *iter;
+
+	actions = db_pending_actions_load (source->root->id);
+	for (iter = actions; iter; iter = g_slist_next (iter)) {
+		pendingActionPtr		pending = (pendingActionPtr)iter->data;
+		AolSourceActionPtr	action = google_reader_api_action_new ();
+
+		action->journalId = pending->id;
+		action->actionType = pending->type;
+		action->guid = pending->guid;
+		action->feedUrl = pending->feedUrl;
+		g_free (pending);
+
+		switch (action->actionType) {
+			case EDIT_ACTION_MARK_READ:
+			case EDIT_ACTION_MARK_UNREAD:
+				action->callback = update_read_state_callback;
+				break;
+			case EDIT_ACTION_TRACKING_MARK_UNREAD:
+				break;
+			case EDIT_ACTION_MARK_STARRED:
+			case EDIT_ACTION_MARK_UNSTARRED:
+				action->callback = update_starred_state_callback;
+				break;
+			case EDIT_ACTION_ADD_SUBSCRIPTION:
+				action->callback = update_subscription_list_callback;
+				break;
+			case EDIT_ACTION_REMOVE_SUBSCRIPTION:
+				action->callback = aol_source_edit_remove_callback;
+				break;
+			default:
+				g_warning ("Dropping journaled action of unknown type %d!", action->actionType);
+				db_pending_action_remove (action->journalId);
+				google_reader_api_action_free (action);
+				source->editsDropped++;
+				continue;
+		}
+
+		aol_source_edit_push_ (source, action, FALSE);
+		source->editsReplayed++;
+	}
+
+	if (actions)
+		aol_source_edit_log_summary (source, "restored journal");
+	g_slist_free (actions);
+}
@@ -34,6 +34,23 @@
  */
 void aol_source_edit_process (AolSourcePtr source);
 
+/**
+ * Process the edit queue again if an edit request failed before and
+ * its retry delay has passed. Call this on every auto update.
+ * 
+ * @param source The AolSource whose editQueue should be retried.
+ */
+void aol_source_edit_retry (AolSourcePtr source);
+
+/**
+ * Loads the actions journaled in the DB that were not yet confirmed
+ * by the server into the edit queue. Call this once after setting up
+ * the source, the actions are sent after the next login.
+ * 
+ * @param source The AolSource whose editQueue should be restored.
+ */
+void aol_source_edit_restore (AolSourcePtr source);
+
 
 /** Edit wrappers */
 
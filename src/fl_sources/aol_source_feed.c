@@ -33,6 +33,7 @@
 #include "subscription.h"
 #include "node.h"
 #include "aol_source_edit.h"
+#include "aol_source_opml.h"
 #include "metadata.h"
 #include "db.h"
 #include "item_state.h"
@@ -87,46 +88,11 @@ aol_source_xml_unlink_node (xmlNodePtr node, gpointer data)
 	xmlFreeNode (node);
 }
 
-static itemPtr
-aol_source_load_item_from_sourceid (nodePtr node, gchar *sourceId, GHashTable *cache) 
-{
-	gpointer    ret = g_hash_table_lookup (cache, sourceId);
-	itemSetPtr  itemset;
-	int         num = g_hash_table_size (cache);
-	GList       *iter; 
-	itemPtr     item = NULL;
-
-	if (ret) return item_load (GPOINTER_TO_UINT (ret));
-
-	/* skip the top 'num' entries */
-	itemset = node_get_itemset (node);
-	iter = itemset->ids;
-	while (num--) iter = g_list_next (iter);
-
-	for (; iter; iter = g_list_next (iter)) {
-		item = item_load (GPOINTER_TO_UINT (iter->data));
-		if (item && item->sourceId) {
-			/* save to cache */
-			g_hash_table_insert (cache, g_strdup(item->sourceId), (gpointer) item->id);
-			if (g_str_equal (item->sourceId, sourceId)) {
-				itemset_free (itemset);
-				return item;
-			}
-		}
-		item_unload (item);
-	}
-
-	g_warning ("Could not find item for %s!", sourceId);
-	itemset_free (itemset);
-	return NULL;
-}
-
-static void
-aol_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPtr subscription, GHashTable *cache)
+static GSList *
+aol_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPtr subscription, GSList *states)
 {
 	AolSourcePtr source = (AolSourcePtr) node_source_root_from_node (subscription->node)->data ;
 	xmlNodePtr      xml;
-	nodePtr         node = subscription->node;
 	xmlChar         *id;
 	gboolean        read = FALSE;
 	gboolean        starred = FALSE;
@@ -152,24 +118,19 @@ aol_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPtr subscri
 		}
 	}
 	
-	itemPtr item = aol_source_load_item_from_sourceid (node, id, cache);
-	if (item && item->sourceId) {
-		if (g_str_equal (item->sourceId, id) && !aol_source_edit_is_in_queue(source, id)) {
-			
-			if (item->readStatus != read)
-				item_read_state_changed (item, read);
-			if (item->flagStatus != starred) 
-				item_flag_state_changed (item, starred);
-		}
-	}
-	if (item) item_unload (item) ;
+	if (!aol_source_edit_is_in_queue (source, id))
+		states = item_state_remote_prepend (states, id, read, starred);
+
 	xmlFree (id);
+
+	return states;
 }
 
 static void
 aol_feed_subscription_process_update_result (subscriptionPtr subscription, const struct updateResult* const result, updateFlags flags)
 {
-	
+	AolSourcePtr source = (AolSourcePtr) node_source_root_from_node (subscription->node)->data;
+
 	debug_start_measurement (DEBUG_UPDATE);
 
 	if (result->data) { 
@@ -208,14 +169,17 @@ aol_feed_subscription_process_update_result (subscriptionPtr subscription, const
 		update_result_free (resultCopy);
 	} else { 
 		feed_get_subscription_type ()->process_update_result (subscription, result, flags);
+		aol_source_opml_quick_update_done (source, subscription, FALSE);
 		return ; 
 	}
 
+	aol_source_opml_quick_update_done (source, subscription, result->httpstatus == 200 && subscription->node->available);
+
 	xmlDocPtr doc = xml_parse (result->data, result->size, NULL);
 	if (doc) {		
 		xmlNodePtr root = xmlDocGetRootElement (doc);
 		xmlNodePtr entry = root->children ; 
-		GHashTable *cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		GSList     *states = NULL;
 
 		while (entry) { 
 			if (!g_str_equal (entry->name, "entry")) {
@@ -223,11 +187,11 @@ aol_feed_subscription_process_update_result (subscriptionPtr subscription, const
 				continue; /* not an entry */
 			}
 			
-			aol_source_item_retrieve_status (entry, subscription, cache);
+			states = aol_source_item_retrieve_status (entry, subscription, states);
 			entry = entry->next;
 		}
 		
-		g_hash_table_unref (cache);
+		item_state_reconcile (subscription->node, states);
 		xmlFreeDoc (doc);
 	} else { 
 		debug0 (DEBUG_UPDATE, "aol_feed_subscription_process_update_result(): Couldn't parse XML!");
@@ -292,8 +292,9 @@ google_subscription_opml_cb (subscriptionPtr subscription, const struct updateRe
 		debug0 (DEBUG_UPDATE, "google_subscription_opml_cb(): ERROR: failed to get subscription list!\n");
 	}
 
+	/* only update the feeds whose unread count or newest item changed */
 	if (!(flags & AOL_SOURCE_UPDATE_ONLY_LIST))
-		node_foreach_child_data (subscription->node, node_update_subscription, GUINT_TO_POINTER (0));
+		aol_source_opml_quick_update (gsource);
 
 }
 
@@ -304,9 +305,11 @@ aol_source_opml_quick_update_helper (xmlNodePtr match, gpointer userdata)
 {
 	AolSourcePtr gsource = (AolSourcePtr) userdata;
 	xmlNodePtr      xmlNode;
-	xmlChar         *id, *newestItemTimestamp;
+	xmlChar         *id, *newestItemTimestamp, *count;
 	nodePtr         node = NULL; 
 	const gchar     *oldNewestItemTimestamp;
+	gpointer        oldCount;
+	gint            unread;
 
 	xmlNode = xpath_find (match, "./string[@name='id']");
 	id = xmlNodeGetContent (xmlNode); 
@@ -326,25 +329,57 @@ aol_source_opml_quick_update_helper (xmlNodePtr match, gpointer userdata)
 	xmlNode = xpath_find (match, "./number[@name='newestItemTimestampUsec']");
 	newestItemTimestamp = xmlNodeGetContent (xmlNode);
 
+	xmlNode = xpath_find (match, "./number[@name='count']");
+	count = xmlNodeGetContent (xmlNode);
+	unread = count ? common_parse_long ((gchar *)count, 0) : 0;
+
 	oldNewestItemTimestamp = g_hash_table_lookup (gsource->lastTimestampMap, node->subscription->source);
+	oldCount = g_hash_table_lookup (gsource->lastUnreadCountMap, node->subscription->source);
 
-	if (!oldNewestItemTimestamp ||
+	if (!oldNewestItemTimestamp || !oldCount ||
+	    GPOINTER_TO_INT (oldCount) - 1 != unread ||
 	    (newestItemTimestamp && 
 	     !g_str_equal (newestItemTimestamp, oldNewestItemTimestamp))) { 
-		debug3(DEBUG_UPDATE, "AolSource: auto-updating %s "
-		       "[oldtimestamp%s, timestamp %s]", 
-		       id, oldNewestItemTimestamp, newestItemTimestamp);
-		g_hash_table_insert (gsource->lastTimestampMap,
+		debug4(DEBUG_UPDATE, "AolSource: auto-updating %s "
+		       "[oldtimestamp%s, timestamp %s, count %d]", 
+		       id, oldNewestItemTimestamp, newestItemTimestamp, unread);
+		/* only remembered once the update succeeded */
+		g_hash_table_insert (gsource->pendingTimestampMap,
 				    g_strdup (node->subscription->source), 
 				    g_strdup (newestItemTimestamp));
+		g_hash_table_insert (gsource->pendingUnreadCountMap,
+				    g_strdup (node->subscription->source), 
+				    GINT_TO_POINTER (unread + 1));
 				    
 		subscription_update (node->subscription, 0);
 	}
 
+	xmlFree (count);
 	xmlFree (newestItemTimestamp);
 	xmlFree (id);
 }
 
+void
+aol_source_opml_quick_update_done (AolSourcePtr gsource, subscriptionPtr subscription, gboolean success)
+{
+	gpointer count = g_hash_table_lookup (gsource->pendingUnreadCountMap, subscription->source);
+
+	if (!count)
+		return;	/* not started by a quick update */
+
+	if (success) {
+		g_hash_table_insert (gsource->lastTimestampMap,
+		                     g_strdup (subscription->source),
+		                     g_strdup (g_hash_table_lookup (gsource->pendingTimestampMap, subscription->source)));
+		g_hash_table_insert (gsource->lastUnreadCountMap,
+		                     g_strdup (subscription->source),
+		                     count);
+	}
+
+	g_hash_table_remove (gsource->pendingTimestampMap, subscription->source);
+	g_hash_table_remove (gsource->pendingUnreadCountMap, subscription->source);
+}
+
 static void
 aol_source_opml_quick_update_cb (const struct updateResult* const result, gpointer userdata, updateFlags flags) 
 {
@@ -352,8 +387,8 @@ aol_source_opml_quick_update_cb (const struct updateResult* const result, gpoint
 	xmlDocPtr       doc;
 
 	if (!result->data) { 
-		/* what do I do? */
-		debug0 (DEBUG_UPDATE, "AolSource: Unable to get unread counts, this update is aborted.");
+		debug0 (DEBUG_UPDATE, "AolSource: Unable to get unread counts, updating all feeds.");
+		node_foreach_child_data (gsource->root, node_update_subscription, GUINT_TO_POINTER (0));
 		return;
 	}
 	doc = xml_parse (result->data, result->size, NULL);
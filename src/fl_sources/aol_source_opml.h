@@ -46,3 +46,15 @@ nodePtr aol_source_opml_get_subnode_by_node(nodePtr node, const gchar *source);
  * @param source	the AOL Reader source
  */
 gboolean aol_source_opml_quick_update (AolSourcePtr source);
+
+/**
+ * Remembers the unread count and newest item timestamp a quick update
+ * of the given feed was started for, if the feed update succeeded.
+ * Otherwise the next quick update updates the feed again. Call this
+ * when processing the result of a feed update.
+ *
+ * @param source	the AOL Reader source
+ * @param subscription	the updated feed
+ * @param success	TRUE if the update succeeded
+ */
+void aol_source_opml_quick_update_done (AolSourcePtr source, subscriptionPtr subscription, gboolean success);
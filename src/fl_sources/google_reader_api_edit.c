@@ -0,0 +1,139 @@
+/**
+ * @file google_reader_api_edit.c  Google Reader API edit queue helpers
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fl_sources/google_reader_api_edit.h"
+
+#include "db.h"
+#include "debug.h"
+
+googleReaderApiActionPtr
+google_reader_api_action_new (void)
+{
+	return g_slice_new0 (struct googleReaderApiAction);
+}
+
+void
+google_reader_api_action_free (googleReaderApiActionPtr action)
+{
+	g_free (action->guid);
+	g_free (action->feedUrl);
+	g_slice_free (struct googleReaderApiAction, action);
+}
+
+gboolean
+google_reader_api_action_is_edit_tag (googleReaderApiActionPtr action)
+{
+	return (action->actionType == EDIT_ACTION_MARK_READ || 
+	        action->actionType == EDIT_ACTION_MARK_UNREAD || 
+	        action->actionType == EDIT_ACTION_TRACKING_MARK_UNREAD ||
+	        action->actionType == EDIT_ACTION_MARK_STARRED || 
+	        action->actionType == EDIT_ACTION_MARK_UNSTARRED);
+}
+
+GSList *
+google_reader_api_edit_pop_batch (GQueue *queue)
+{
+	googleReaderApiActionPtr	head = g_queue_pop_head (queue);
+	GSList			*batch = g_slist_prepend (NULL, head);
+	GHashTable		*skipped;
+	GList			*iter;
+	guint			count = 1;
+
+	if (!google_reader_api_action_is_edit_tag (head))
+		return batch;
+
+	skipped = g_hash_table_new (g_str_hash, g_str_equal);
+	iter = queue->head;
+	while (iter && count < GOOGLE_READER_API_EDIT_TAG_MAX_ITEMS) {
+		googleReaderApiActionPtr	action = (googleReaderApiActionPtr)iter->data;
+		GList			*next = g_list_next (iter);
+
+		if (!google_reader_api_action_is_edit_tag (action))
+			break;
+
+		if (action->actionType == head->actionType &&
+		    !g_hash_table_lookup (skipped, action->guid)) {
+			batch = g_slist_prepend (batch, action);
+			g_queue_delete_link (queue, iter);
+			count++;
+		} else {
+			g_hash_table_insert (skipped, action->guid, action);
+		}
+		iter = next;
+	}
+	g_hash_table_destroy (skipped);
+
+	return g_slist_reverse (batch);
+}
+
+/*
+ * Returns the action type that is undone by the given action type
+ * or -1 if there is none.
+ */
+static gint
+google_reader_api_action_opposite (gint actionType)
+{
+	switch (actionType) {
+		case EDIT_ACTION_MARK_READ:		return EDIT_ACTION_MARK_UNREAD;
+		case EDIT_ACTION_MARK_UNREAD:		return EDIT_ACTION_MARK_READ;
+		case EDIT_ACTION_MARK_STARRED:		return EDIT_ACTION_MARK_UNSTARRED;
+		case EDIT_ACTION_MARK_UNSTARRED:	return EDIT_ACTION_MARK_STARRED;
+		default:				return -1;
+	}
+}
+
+gboolean
+google_reader_api_edit_cancel_opposite (gpointer source, GQueue *queue, googleReaderApiActionPtr action, guint *dropped)
+{
+	gint		opposite = google_reader_api_action_opposite (action->actionType);
+	gboolean	found = FALSE;
+	GList		*iter;
+
+	if (opposite < 0 || !action->guid)
+		return FALSE;
+
+	iter = queue->head;
+	while (iter) {
+		googleReaderApiActionPtr	queued = (googleReaderApiActionPtr)iter->data;
+		GList			*next = g_list_next (iter);
+
+		if (queued->guid && g_str_equal (queued->guid, action->guid) &&
+		    (queued->actionType == opposite ||
+		     (opposite == EDIT_ACTION_MARK_UNREAD && queued->actionType == EDIT_ACTION_TRACKING_MARK_UNREAD))) {
+			if (queued->actionType == opposite)
+				found = TRUE;
+			g_queue_delete_link (queue, iter);
+			db_pending_action_remove (queued->journalId);
+			if (queued->callback)
+				(*queued->callback) (source, queued, FALSE);
+			google_reader_api_action_free (queued);
+			(*dropped)++;
+		}
+		iter = next;
+	}
+
+	if (found) {
+		debug1 (DEBUG_UPDATE, "google_reader_api_edit: cancelled opposite edits for %s", action->guid);
+		if (action->callback)
+			(*action->callback) (source, action, TRUE);
+	}
+
+	return found;
+}
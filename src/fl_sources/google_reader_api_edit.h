@@ -0,0 +1,141 @@
+/**
+ * @file google_reader_api_edit.h  Google Reader API edit queue helpers
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _GOOGLE_READER_API_EDIT_H
+#define _GOOGLE_READER_API_EDIT_H
+
+#include <glib.h>
+
+/** Maximum number of items coalesced into a single edit-tag request */
+#define GOOGLE_READER_API_EDIT_TAG_MAX_ITEMS 100
+
+/** Edit action types (journaled in the DB, so only append new ones) */
+enum { 
+	EDIT_ACTION_MARK_READ,
+	EDIT_ACTION_MARK_UNREAD,
+	EDIT_ACTION_TRACKING_MARK_UNREAD, /**< every UNREAD request, should be followed by tracking-kept-unread */
+	EDIT_ACTION_MARK_STARRED,
+	EDIT_ACTION_MARK_UNSTARRED,
+	EDIT_ACTION_ADD_SUBSCRIPTION,
+	EDIT_ACTION_REMOVE_SUBSCRIPTION
+};
+
+/**
+ * A structure to indicate an edit to the remote "database" of a node
+ * source implementing the Google Reader API (TheOldReader, InoReader,
+ * Reedah, AOL). These edits are put in a queue and processed in
+ * sequential order so that the server does not end up processing the
+ * requests in an unintended order.
+ */
+typedef struct googleReaderApiAction {
+	/**
+	 * The guid of the item to edit. This will be ignored if the 
+	 * edit is acting on an subscription rather than an item.
+	 */
+	gchar* guid;
+
+	/**
+	 * A MANDATORY feed url to containing the item, or the url of the 
+	 * subscription to edit. 
+	 */
+	gchar* feedUrl;
+
+	/**
+	 * The source type. Currently known types are "feed" and "user".
+	 * "user" sources are used, for example, for items that are links (as
+	 * opposed to posts) in broadcast-friends. The unique id of the source
+	 * is of the form <feedUrlType>/<feedUrl>.
+	 */
+	gchar* feedUrlType; 
+
+	/**
+	 * A callback function on completion of the edit. It gets the
+	 * node source data owning the queue.
+	 */
+	void (*callback) (gpointer source, struct googleReaderApiAction* edit, gboolean success);
+
+	/**
+	 * The type of this action.
+	 */
+	int actionType ; 
+
+	/**
+	 * The id of this action in the DB journal (or 0).
+	 */
+	gint64 journalId;
+} *googleReaderApiActionPtr;
+
+/**
+ * Creates a new empty edit action.
+ *
+ * @returns a new action (to be free'd using google_reader_api_action_free())
+ */
+googleReaderApiActionPtr google_reader_api_action_new (void);
+
+/**
+ * Frees an edit action.
+ *
+ * @param action	the action
+ */
+void google_reader_api_action_free (googleReaderApiActionPtr action);
+
+/**
+ * Checks whether an action is sent as an edit-tag request.
+ *
+ * @param action	the action
+ *
+ * @returns TRUE for read, unread and starred state changes
+ */
+gboolean google_reader_api_action_is_edit_tag (googleReaderApiActionPtr action);
+
+/**
+ * Removes the head action and all other queued actions with the same
+ * tag operation (up to GOOGLE_READER_API_EDIT_TAG_MAX_ITEMS) from the
+ * queue. Actions on items touched by a different operation queued in
+ * between are not taken to keep the order of operations per item.
+ * Subscription edits act as a barrier.
+ *
+ * @param queue		a non-empty edit queue
+ *
+ * @returns the list of actions to send with one request
+ */
+GSList * google_reader_api_edit_pop_batch (GQueue *queue);
+
+/**
+ * Drops still queued actions with the opposite effect on the same
+ * item (including the tracking-kept-unread companion of an unread
+ * action) and removes them from the journal. As they were never sent
+ * their callbacks are run with success set to FALSE.
+ *
+ * If an opposite action was found the new action cancelled out: the
+ * server still has the state the new action asks for, so its callback
+ * is run with success set to TRUE and the caller must free it instead
+ * of queuing it.
+ *
+ * @param source	the node source data passed to the callbacks
+ * @param queue		the edit queue of the node source
+ * @param action	the new action
+ * @param dropped	counter to add the number of dropped actions to
+ *
+ * @returns TRUE if the new action cancelled out
+ */
+gboolean google_reader_api_edit_cancel_opposite (gpointer source, GQueue *queue, googleReaderApiActionPtr action, guint *dropped);
+
+#endif
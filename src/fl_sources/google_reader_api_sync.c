@@ -0,0 +1,287 @@
+/**
+ * @file google_reader_api_sync.c  Google Reader API reading list sync
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fl_sources/google_reader_api_sync.h"
+
+#include <string.h>
+
+#include "debug.h"
+#include "feedlist.h"
+#include "item_state.h"
+#include "itemlist.h"
+#include "itemset.h"
+#include "json.h"
+#include "subscription.h"
+#include "update.h"
+#include "fl_sources/json_api_mapper.h"
+
+/**
+ * Extracts what the generic JSON mapping cannot handle: the link,
+ * the read and starred state (which are categories) and the origin
+ * stream which is needed to find the subscription of the item.
+ */
+static void
+google_reader_api_sync_item_callback (JsonNode *node, itemPtr item)
+{
+	JsonNode	*alternate, *categories, *origin;
+	const gchar	*streamId;
+	guint		i;
+
+	alternate = json_get_node (node, "alternate");
+	if (alternate && JSON_NODE_TYPE (alternate) == JSON_NODE_ARRAY &&
+	    json_array_get_length (json_node_get_array (alternate)) > 0)
+		item_set_source (item, json_get_string (json_array_get_element (json_node_get_array (alternate), 0), "href"));
+
+	categories = json_get_node (node, "categories");
+	if (categories && JSON_NODE_TYPE (categories) == JSON_NODE_ARRAY) {
+		JsonArray *array = json_node_get_array (categories);
+
+		for (i = 0; i < json_array_get_length (array); i++) {
+			const gchar *category = json_node_get_string (json_array_get_element (array, i));
+			if (!category)
+				continue;
+
+			if (g_str_has_suffix (category, "/state/com.google/read"))
+				item->readStatus = TRUE;
+			else if (g_str_has_suffix (category, "/state/com.google/starred"))
+				item->flagStatus = TRUE;
+		}
+	}
+
+	origin = json_get_node (node, "origin");
+	streamId = origin ? json_get_string (origin, "streamId") : NULL;
+	if (streamId) {
+		if (!item->tmpdata)
+			item->tmpdata = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+		g_hash_table_insert (item->tmpdata, "origin", g_strdup (streamId));
+	}
+}
+
+static void
+google_reader_api_sync_map_nodes_by_source (nodePtr folder, GHashTable *nodes)
+{
+	GSList	*iter;
+
+	for (iter = folder->children; iter; iter = g_slist_next (iter)) {
+		nodePtr node = (nodePtr)iter->data;
+
+		if (node->subscription && node->subscription->source)
+			g_hash_table_insert (nodes, g_strdup_printf ("feed/%s", node->subscription->source), node);
+		if (node->children)
+			google_reader_api_sync_map_nodes_by_source (node, nodes);
+	}
+}
+
+static GHashTable *
+google_reader_api_sync_get_nodes (googleReaderApiSyncPtr sync)
+{
+	GHashTable *nodes;
+
+	if (sync->get_nodes)
+		return sync->get_nodes (sync->source);
+
+	/* By default the origin stream id is "feed/" plus the feed URL */
+	nodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	google_reader_api_sync_map_nodes_by_source (sync->root, nodes);
+
+	return nodes;
+}
+
+static void
+google_reader_api_sync_merge (gpointer key, gpointer value, gpointer userdata)
+{
+	nodePtr			node = (nodePtr)key;
+	GList			*items = g_list_reverse ((GList *)value);
+	googleReaderApiSyncPtr	sync = (googleReaderApiSyncPtr)userdata;
+	GSList			*states = NULL;
+	itemSetPtr		itemSet;
+	GList			*iter;
+	guint			newCount;
+
+	/* Merging only adds new items, so remember the remote
+	   state to apply it to already known items afterwards */
+	for (iter = items; iter; iter = g_list_next (iter)) {
+		itemPtr item = (itemPtr)iter->data;
+		if (item->sourceId && !sync->is_in_queue (sync->source, item->sourceId))
+			states = item_state_remote_prepend (states, item->sourceId, item->readStatus, item->flagStatus);
+	}
+
+	debug3 (DEBUG_UPDATE, "%s: merging %u synced items into %s", sync->name, g_list_length (items), node->id);
+
+	itemSet = node_get_itemset (node);
+	newCount = itemset_merge_items (itemSet, items, TRUE /* feed valid */, FALSE /* markAsRead */);
+	itemlist_merge_itemset (itemSet);
+	itemset_free (itemSet);
+
+	/* New items already carry the remote state, this catches known ones */
+	item_state_reconcile (node, states);
+
+	feedlist_node_was_updated (node, newCount);
+	node->available = TRUE;
+}
+
+static void google_reader_api_sync_request (googleReaderApiSyncPtr sync, const gchar *continuation);
+
+static void
+google_reader_api_sync_cb (const struct updateResult * const result, gpointer userdata, updateFlags flags)
+{
+	googleReaderApiSyncPtr	sync = (googleReaderApiSyncPtr) userdata;
+	JsonParser		*parser;
+	gchar			*continuation = NULL;
+	gboolean		success = FALSE;
+
+	if (!result->data || result->httpstatus != 200) {
+		debug2 (DEBUG_UPDATE, "%s: reading list sync failed (HTTP status %d)", sync->name, result->httpstatus);
+		sync->started = 0;
+		return;
+	}
+
+	parser = json_parser_new ();
+	if (json_parser_load_from_data (parser, result->data, -1, NULL)) {
+		JsonNode	*root = json_parser_get_root (parser);
+		GHashTable	*nodeItems = g_hash_table_new (g_direct_hash, g_direct_equal);
+		GHashTable	*nodes = google_reader_api_sync_get_nodes (sync);
+		GList		*items, *iter;
+		jsonApiMapping	mapping;
+		const gchar	*tmp;
+
+		/* Link, read and starred state are handled by the callback */
+		mapping.id		= "id";
+		mapping.title		= "title";
+		mapping.link		= NULL;
+		mapping.description	= "summary/content";
+		mapping.read		= NULL;
+		mapping.updated		= "published";
+		mapping.author		= "author";
+		mapping.flag		= NULL;
+
+		mapping.xhtml		= TRUE;
+		mapping.negateRead	= FALSE;
+
+		/* Distribute the items to their subscriptions */
+		items = json_api_get_items_from_node (root, "items", &mapping, google_reader_api_sync_item_callback);
+		for (iter = items; iter; iter = g_list_next (iter)) {
+			itemPtr		item = (itemPtr)iter->data;
+			const gchar	*origin = NULL;
+			nodePtr		node = NULL;
+
+			if (item->tmpdata)
+				origin = g_hash_table_lookup (item->tmpdata, "origin");
+			if (origin)
+				node = g_hash_table_lookup (nodes, origin);
+
+			if (item->tmpdata) {
+				g_hash_table_destroy (item->tmpdata);
+				item->tmpdata = NULL;
+			}
+
+			if (node)
+				g_hash_table_insert (nodeItems, node, g_list_prepend (g_hash_table_lookup (nodeItems, node), item));
+			else
+				item_unload (item);
+		}
+		g_list_free (items);
+
+		debug3 (DEBUG_UPDATE, "%s: reading list page %u changes %u subscriptions", sync->name, sync->pages + 1, g_hash_table_size (nodeItems));
+
+		g_hash_table_foreach (nodeItems, google_reader_api_sync_merge, sync);
+		g_hash_table_destroy (nodeItems);
+		g_hash_table_destroy (nodes);
+
+		tmp = json_get_string (root, "continuation");
+		if (tmp && *tmp)
+			continuation = g_strdup (tmp);
+
+		success = TRUE;
+	} else {
+		g_warning ("Invalid JSON returned on %s reading list request! >>>%s<<<", sync->name, result->data);
+	}
+	g_object_unref (parser);
+
+	if (!success) {
+		sync->started = 0;
+		return;
+	}
+
+	if (continuation) {
+		if (++sync->pages < GOOGLE_READER_API_SYNC_MAX_PAGES) {
+			google_reader_api_sync_request (sync, continuation);
+		} else {
+			/* Too much has changed, fetching each feed is cheaper */
+			debug1 (DEBUG_UPDATE, "%s: too many changes, falling back to a full update", sync->name);
+			sync->started = 0;
+			sync->timestamp = 0;
+			subscription_update (sync->root->subscription, 0);
+		}
+		g_free (continuation);
+		return;
+	}
+
+	/* All pages processed, the next sync continues from here */
+	sync->timestamp = sync->started;
+	sync->started = 0;
+}
+
+static void
+google_reader_api_sync_request (googleReaderApiSyncPtr sync, const gchar *continuation)
+{
+	updateRequestPtr	request = update_request_new ();
+	gchar			*url;
+
+	url = g_strdup_printf (sync->readingListUrl, GOOGLE_READER_API_SYNC_PAGE_SIZE, sync->timestamp);
+	if (continuation) {
+		gchar *escaped = g_uri_escape_string (continuation, NULL, TRUE);
+		gchar *tmp = g_strdup_printf ("%s&c=%s", url, escaped);
+		g_free (escaped);
+		g_free (url);
+		url = tmp;
+	}
+
+	request->updateState = update_state_copy (sync->root->subscription->updateState);
+	request->options = update_options_copy (sync->root->subscription->updateOptions);
+	update_request_set_source (request, url);
+	update_request_set_auth_value (request, *sync->authHeaderValue);
+	g_free (url);
+
+	/* Owned by the source, so freeing the source cancels it */
+	update_execute_request (sync->source, request, google_reader_api_sync_cb, sync, 0);
+}
+
+gboolean
+google_reader_api_sync (googleReaderApiSyncPtr sync)
+{
+	GTimeVal	now;
+
+	/* Without a full update since startup there is no point to continue from */
+	if (!sync->timestamp)
+		return FALSE;
+
+	if (sync->started)
+		return TRUE;
+
+	debug2 (DEBUG_UPDATE, "%s: syncing reading list since %" G_GINT64_FORMAT, sync->name, sync->timestamp);
+
+	g_get_current_time (&now);
+	sync->started = now.tv_sec - GOOGLE_READER_API_SYNC_OVERLAP;
+	sync->pages = 0;
+	google_reader_api_sync_request (sync, NULL);
+
+	return TRUE;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file google_reader_api_sync.h  Google Reader API reading list sync
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _GOOGLE_READER_API_SYNC_H
+#define _GOOGLE_READER_API_SYNC_H
+
+#include <glib.h>
+
+#include "node.h"
+
+/** Number of items per reading list page */
+#define GOOGLE_READER_API_SYNC_PAGE_SIZE 100
+
+/** Maximum number of reading list pages before falling back to a full update */
+#define GOOGLE_READER_API_SYNC_MAX_PAGES 10
+
+/** Seconds a sync overlaps with the last one to tolerate clock skew */
+#define GOOGLE_READER_API_SYNC_OVERLAP 300
+
+/**
+ * Returns a new hash table mapping the origin stream ids of the
+ * reading list to the subscription nodes of a source.
+ */
+typedef GHashTable * (*googleReaderApiGetNodesFunc)(gpointer source);
+
+/**
+ * Returns TRUE if a local state change of the item with the given
+ * id is not yet confirmed by the server.
+ */
+typedef gboolean (*googleReaderApiIsInQueueFunc)(gpointer source, const gchar *guid);
+
+/**
+ * Reading list sync state of a node source implementing the Google
+ * Reader API (TheOldReader, InoReader, Reedah). The node source
+ * embeds it and sets up the source specific fields on creation.
+ */
+typedef struct googleReaderApiSync {
+	const gchar	*name;		/**< source name for debug output */
+	const gchar	*readingListUrl;	/**< reading list URL format taking the page size and the start time */
+	gpointer	source;		/**< the node source data (owner of the requests) */
+	nodePtr		root;		/**< the root node of the source */
+	gchar		**authHeaderValue;	/**< location of the current authorization header value */
+	googleReaderApiGetNodesFunc	get_nodes;	/**< maps stream ids to nodes, NULL for "feed/<url>" ids */
+	googleReaderApiIsInQueueFunc	is_in_queue;	/**< checks for unconfirmed local edits */
+
+	/**
+	 * Time (in seconds) up to which the reading list is known to be
+	 * synced, 0 if there was no full update yet.
+	 */
+	gint64		timestamp;
+	gint64		started;	/**< start time of the running sync (or 0) */
+	guint		pages;		/**< number of pages fetched by the running sync */
+} *googleReaderApiSyncPtr;
+
+/**
+ * Fetches everything that changed since the last sync from the account
+ * wide reading list and merges it into the subscriptions. Only changed
+ * subscriptions are touched.
+ *
+ * @param sync		the sync state of a node source
+ *
+ * @returns FALSE if no sync is possible and a quick update is needed
+ */
+gboolean google_reader_api_sync (googleReaderApiSyncPtr sync);
+
+#endif
@@ -21,6 +21,7 @@
 #ifndef _INOREADER_SOURCE_H
 #define _INOREADER_SOURCE_H
 
+#include "fl_sources/google_reader_api_sync.h"
 #include "fl_sources/node_source.h"
 
 /**
@@ -32,6 +33,13 @@ typedef struct InoreaderSource {
 	GQueue		*actionQueue;
 	gint		loginState;	/**< The current login state */
 	gint		authFailures;	/**< Number of authentication failures */
+	guint		editsQueued;	/**< Number of edits journaled since startup */
+	guint		editsReplayed;	/**< Number of journaled edits restored on startup */
+	guint		editsFlushed;	/**< Number of edits confirmed by the server */
+	guint		editsDropped;	/**< Number of edits cancelled out or rejected */
+	gint64		editFlushTime;	/**< Total time (in microseconds) those edits took */
+	gint64		editRetryTime;	/**< Monotonic time after which failed edits are sent again (or 0) */
+	guint		editRetryDelay;	/**< Current delay (in seconds) between edit retries */
 
 	/**
 	 * A map from a subscription source to a timestamp when it was last 
@@ -39,10 +47,26 @@ typedef struct InoreaderSource {
 	 */
 	GHashTable      *lastTimestampMap; 
 
+	/**
+	 * A map from a subscription source to its unread count
+	 * (plus one) provided by remote when it was last updated.
+	 */
+	GHashTable	*lastUnreadCountMap;
+
+	/**
+	 * Unread counts (plus one) and newest item timestamps of feeds
+	 * updated by a quick update. They are moved to the maps above
+	 * once the feed update succeeded.
+	 */
+	GHashTable	*pendingUnreadCountMap;
+	GHashTable	*pendingTimestampMap;
+
 	/**
 	 * A timestamp when the last Quick update took place.
 	 */
 	GTimeVal        lastQuickUpdate;
+
+	struct googleReaderApiSync	sync;	/**< reading list sync state */
 } *InoreaderSourcePtr;
 
 enum { 
@@ -121,7 +145,17 @@ enum {
  * A list of subscriptions with the unread counters, and the last updated
  * timestamps.
  */
-#define INOREADER_UNREAD_COUNTS_URL "http://www.inoreader.com/reader/api/0/unread-count?all=true&client=liferea"
+#define INOREADER_UNREAD_COUNTS_URL "http://www.inoreader.com/reader/api/0/unread-count?all=true&output=json&client=liferea"
+
+/**
+ * The account wide stream of all items. Returns JSON including the
+ * origin stream of each item and a continuation token if there are
+ * more items than requested.
+ * @param n  the number of items per page
+ * @param ot only return items newer than this time (in seconds)
+ * @param c  (appended if needed) the continuation token of the last page
+ */
+#define INOREADER_READING_LIST_URL "http://www.inoreader.com/reader/api/0/stream/contents/user%%2F-%%2Fstate%%2Fcom.google%%2Freading-list?client=liferea&n=%d&ot=%" G_GINT64_FORMAT
 
 /**
  * Edit the tags associated with an item. The parameters to this _have_ to be
@@ -29,7 +29,11 @@
 #include "xml.h"
 
 #include "feedlist.h"
+#include "itemlist.h"
+#include "json.h"
+#include "json_api_mapper.h"
 #include "inoreader_source.h"
+#include "inoreader_source_feed_list.h"
 #include "subscription.h"
 #include "node.h"
 #include "inoreader_source_edit.h"
@@ -87,46 +91,11 @@ inoreader_source_xml_unlink_node (xmlNodePtr node, gpointer data)
 	xmlFreeNode (node);
 }
 
-static itemPtr
-inoreader_source_load_item_from_sourceid (nodePtr node, gchar *sourceId, GHashTable *cache) 
-{
-	gpointer    ret = g_hash_table_lookup (cache, sourceId);
-	itemSetPtr  itemset;
-	int         num = g_hash_table_size (cache);
-	GList       *iter; 
-	itemPtr     item = NULL;
-
-	if (ret) return item_load (GPOINTER_TO_UINT (ret));
-
-	/* skip the top 'num' entries */
-	itemset = node_get_itemset (node);
-	iter = itemset->ids;
-	while (num--) iter = g_list_next (iter);
-
-	for (; iter; iter = g_list_next (iter)) {
-		item = item_load (GPOINTER_TO_UINT (iter->data));
-		if (item && item->sourceId) {
-			/* save to cache */
-			g_hash_table_insert (cache, g_strdup(item->sourceId), (gpointer) item->id);
-			if (g_str_equal (item->sourceId, sourceId)) {
-				itemset_free (itemset);
-				return item;
-			}
-		}
-		item_unload (item);
-	}
-
-	g_warning ("Could not find item for %s!", sourceId);
-	itemset_free (itemset);
-	return NULL;
-}
-
-static void
-inoreader_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPtr subscription, GHashTable *cache)
+static GSList *
+inoreader_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPtr subscription, GSList *states)
 {
 	InoreaderSourcePtr gsource = (InoreaderSourcePtr) node_source_root_from_node (subscription->node)->data ;
 	xmlNodePtr      xml;
-	nodePtr         node = subscription->node;
 	xmlChar         *id = NULL;
 	gboolean        read = FALSE;
 	gboolean        starred = FALSE;
@@ -154,27 +123,22 @@ inoreader_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPtr s
 	
 	if (!id) {
 		g_warning ("Fatal: could not extract item id from InoReader Atom feed!");
-		return;
+		return states;
 	}
 
-	itemPtr item = inoreader_source_load_item_from_sourceid (node, id, cache);
-	if (item && item->sourceId) {
-		if (g_str_equal (item->sourceId, id) && !inoreader_source_edit_is_in_queue (gsource, id)) {
-			
-			if (item->readStatus != read)
-				item_read_state_changed (item, read);
-			if (item->flagStatus != starred) 
-				item_flag_state_changed (item, starred);
-		}
-	}
-	if (item) item_unload (item) ;
+	if (!inoreader_source_edit_is_in_queue (gsource, id))
+		states = item_state_remote_prepend (states, id, read, starred);
+
 	xmlFree (id);
+
+	return states;
 }
 
 static void
 inoreader_feed_subscription_process_update_result (subscriptionPtr subscription, const struct updateResult* const result, updateFlags flags)
 {
-	
+	InoreaderSourcePtr gsource = (InoreaderSourcePtr) node_source_root_from_node (subscription->node)->data;
+
 	debug_start_measurement (DEBUG_UPDATE);
 
 	if (result->data) { 
@@ -213,14 +177,17 @@ inoreader_feed_subscription_process_update_result (subscriptionPtr subscription,
 		update_result_free (resultCopy);
 	} else { 
 		feed_get_subscription_type ()->process_update_result (subscription, result, flags);
+		inoreader_source_opml_quick_update_done (gsource, subscription, FALSE);
 		return ; 
 	}
 
+	inoreader_source_opml_quick_update_done (gsource, subscription, result->httpstatus == 200 && subscription->node->available);
+
 	xmlDocPtr doc = xml_parse (result->data, result->size, NULL);
 	if (doc) {		
 		xmlNodePtr root = xmlDocGetRootElement (doc);
 		xmlNodePtr entry = root->children ; 
-		GHashTable *cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		GSList     *states = NULL;
 
 		while (entry) { 
 			if (!g_str_equal (entry->name, "entry")) {
@@ -228,11 +195,11 @@ inoreader_feed_subscription_process_update_result (subscriptionPtr subscription,
 				continue; /* not an entry */
 			}
 			
-			inoreader_source_item_retrieve_status (entry, subscription, cache);
+			states = inoreader_source_item_retrieve_status (entry, subscription, states);
 			entry = entry->next;
 		}
 		
-		g_hash_table_unref (cache);
+		item_state_reconcile (subscription->node, states);
 		xmlFreeDoc (doc);
 	} else { 
 		debug0 (DEBUG_UPDATE, "google_feed_subscription_process_update_result(): Couldn't parse XML!");
@@ -45,3 +45,15 @@ nodePtr inoreader_source_opml_get_subnode_by_node(nodePtr node, const gchar *sou
  * @param gsource	the Google Reader source
  */
 gboolean inoreader_source_opml_quick_update (InoreaderSourcePtr gsource);
+
+/**
+ * Remembers the unread count and newest item timestamp a quick update
+ * of the given feed was started for, if the feed update succeeded.
+ * Otherwise the next quick update updates the feed again. Call this
+ * when processing the result of a feed update.
+ *
+ * @param gsource	the Inoreader source
+ * @param subscription	the updated feed
+ * @param success	TRUE if the update succeeded
+ */
+void inoreader_source_opml_quick_update_done (InoreaderSourcePtr gsource, subscriptionPtr subscription, gboolean success);
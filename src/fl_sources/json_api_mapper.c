@@ -27,91 +27,166 @@
 #include "metadata.h"
 #include "xml.h"
 
-JsonNode *
-json_api_get_node (JsonNode *parent, const gchar *mapping)
+/* A mapping is compiled once per JSON document into location
+   steps that are split already, so resolving a field for each
+   item only walks the object members and does no string work. */
+typedef struct jsonApiCompiledMapping {
+	gchar	**id;
+	gchar	**title;
+	gchar	**link;
+	gchar	**description;
+	gchar	**updated;
+	gchar	**author;
+	gchar	**read;
+	gchar	**flag;
+} jsonApiCompiledMapping;
+
+static gchar **
+json_api_path_compile (const gchar *mapping)
 {
-	JsonNode	*node = parent;
-	gchar		**step;
-	gchar		**steps = g_strsplit (g_strdup (mapping), "/", 0);
+	if (!mapping || !*mapping)
+		return NULL;
 
-	step = steps;
-	if (!*step)
-		return node;
+	return g_strsplit (mapping, "/", 0);
+}
 
-	while (*(step + 1) && node) {
-		node = json_get_node (node, *step);
-		step++;
-	}
+static void
+json_api_mapping_compile (jsonApiMapping *mapping, jsonApiCompiledMapping *compiled)
+{
+	compiled->id		= json_api_path_compile (mapping->id);
+	compiled->title		= json_api_path_compile (mapping->title);
+	compiled->link		= json_api_path_compile (mapping->link);
+	compiled->description	= json_api_path_compile (mapping->description);
+	compiled->updated	= json_api_path_compile (mapping->updated);
+	compiled->author	= json_api_path_compile (mapping->author);
+	compiled->read		= json_api_path_compile (mapping->read);
+	compiled->flag		= json_api_path_compile (mapping->flag);
+}
+
+static void
+json_api_mapping_free (jsonApiCompiledMapping *compiled)
+{
+	g_strfreev (compiled->id);
+	g_strfreev (compiled->title);
+	g_strfreev (compiled->link);
+	g_strfreev (compiled->description);
+	g_strfreev (compiled->updated);
+	g_strfreev (compiled->author);
+	g_strfreev (compiled->read);
+	g_strfreev (compiled->flag);
+}
+
+/* Walks all location steps and returns the node of the final field */
+static JsonNode *
+json_api_path_resolve (JsonNode *node, gchar **steps)
+{
+	if (!steps)
+		return NULL;
 
-	g_strfreev (steps);
+	while (*steps && node) {
+		node = json_get_node (node, *steps);
+		steps++;
+	}
 
 	return node;
 }
 
-const gchar *
-json_api_get_string (JsonNode *parent, const gchar *mapping)
+static const gchar *
+json_api_get_string (JsonNode *parent, gchar **steps)
 {
-	JsonNode	*node;
-	const gchar	*field;
-
-	if (!parent || !mapping)
-		return NULL;
+	JsonNode *node = json_api_path_resolve (parent, steps);
 
-	node = json_api_get_node (parent, mapping);
-	if (!node)
+	if (!node || JSON_NODE_TYPE (node) != JSON_NODE_VALUE)
 		return NULL;
 
-	field = strrchr (mapping, '/');
-	if (!field)
-		field = mapping;
-	else
-		field++;
-
-	return json_get_string (node, field);
+	return json_node_get_string (node);
 }
 
-gint
-json_api_get_int (JsonNode *parent, const gchar *mapping)
+static gint64
+json_api_get_int (JsonNode *parent, gchar **steps)
 {
-	JsonNode	*node;
-	const gchar	*field;
+	JsonNode *node = json_api_path_resolve (parent, steps);
 
-	if (!parent || !mapping)
+	if (!node || JSON_NODE_TYPE (node) != JSON_NODE_VALUE)
 		return 0;
 
-	node = json_api_get_node (parent, mapping);
-	if (!node)
-		return 0;
+	return json_node_get_int (node);
+}
 
-	field = strrchr (mapping, '/');
-	if (!field)
-		field = mapping;
-	else
-		field++;
+static gboolean
+json_api_get_bool (JsonNode *parent, gchar **steps)
+{
+	JsonNode *node = json_api_path_resolve (parent, steps);
+
+	if (!node || JSON_NODE_TYPE (node) != JSON_NODE_VALUE)
+		return FALSE;
 
-	return json_get_int (node, field);
+	return json_node_get_boolean (node);
 }
 
-gboolean
-json_api_get_bool (JsonNode *parent, const gchar *mapping)
+GList *
+json_api_get_items_from_node (JsonNode *document, const gchar *root, jsonApiMapping *mapping, jsonApiItemCallbackFunc callback)
 {
-	JsonNode	*node;
-	const gchar	*field;
+	GList			*items = NULL;
+	JsonNode		*rootNode = json_get_node (document, root);
+	JsonArray		*array = NULL;
+	jsonApiCompiledMapping	paths;
+	guint			i, length = 0;
+
+	if (rootNode && JSON_NODE_TYPE (rootNode) == JSON_NODE_ARRAY) {
+		array = json_node_get_array (rootNode);
+		length = json_array_get_length (array);
+	}
 
-	if (!parent || !mapping)
-		return FALSE;
+	debug2 (DEBUG_PARSING, "JSON API: found items root node \"%s\" with %u items", root, length);
 
-	node = json_api_get_node (parent, mapping);
-	if (!node)
-		return FALSE;
+	json_api_mapping_compile (mapping, &paths);
 
-	field = strrchr (mapping, '/');
-	if (!field)
-		field = mapping;
-	else
-		field++;
+	for (i = 0; i < length; i++) {
+		JsonNode	*node = json_array_get_element (array, i);
+		itemPtr		item = item_new ();
+		const gchar	*content;
+		const gchar	*tmp;
+
+		/* Parse default feeds */
+		item_set_id	(item, json_api_get_string (node, paths.id));
+		item_set_title	(item, json_api_get_string (node, paths.title));
+		item_set_source	(item, json_api_get_string (node, paths.link));
+
+		item->time       = json_api_get_int (node, paths.updated);
+		item->readStatus = json_api_get_bool (node, paths.read);
+		item->flagStatus = json_api_get_bool (node, paths.flag);
+
+		if (mapping->negateRead)
+			item->readStatus = !item->readStatus;
+
+		/* Handling encoded content */
+		content = json_api_get_string (node, paths.description);
+		if (mapping->xhtml) {
+			gchar *xhtml = xhtml_extract_from_string (content, NULL);
+			item_set_description (item, xhtml);
+			xmlFree (xhtml);
+		} else {
+			item_set_description (item, content);
+		}
+
+		/* Optional meta data */
+		tmp = json_api_get_string (node, paths.author);
+		if (tmp)
+			item->metadata = metadata_list_append (item->metadata, "author", tmp);
 
-	return json_get_bool (node, field);
+		/* prepend and reverse later, appending is O(n) per item */
+		items = g_list_prepend (items, (gpointer)item);
+
+		/* Allow optional item callback to process stuff */
+		if (callback)
+			(*callback)(node, item);
+	}
+
+	json_api_mapping_free (&paths);
+	items = g_list_reverse (items);
+
+	return items;
 }
 
 GList *
@@ -120,61 +195,12 @@ json_api_get_items (const gchar *json, const gchar *root, jsonApiMapping *mappin
 	GList		*items = NULL;
 	JsonParser	*parser = json_parser_new ();
 
-	if (json_parser_load_from_data (parser, json, -1, NULL)) {
-		JsonArray	*array = json_node_get_array (json_get_node (json_parser_get_root (parser), root));
-		GList		*elements = json_array_get_elements (array);
-		GList		*iter = elements;
-
-		debug1 (DEBUG_PARSING, "JSON API: found items root node \"%s\"", root);
-                
-		while (iter) {
-			JsonNode *node = (JsonNode *)iter->data;
-			itemPtr item = item_new ();
-
-			/* Parse default feeds */
-			item_set_id	(item, json_api_get_string (node, mapping->id));
-			item_set_title	(item, json_api_get_string (node, mapping->title));
-			item_set_source	(item, json_api_get_string (node, mapping->link));
-
-			item->time       = json_api_get_int (node, mapping->updated);
-			item->readStatus = json_api_get_bool (node, mapping->read);
-			item->flagStatus = json_api_get_bool (node, mapping->flag);
-
-			if (mapping->negateRead)
-				item->readStatus = !item->readStatus;
-
-			/* Handling encoded content */
-			const gchar *content; 
-			gchar *xhtml;
-
-			content = json_api_get_string (node, mapping->description);
-			if (mapping->xhtml) {
-				xhtml = xhtml_extract_from_string (content, NULL);
-				item_set_description (item, xhtml);
-				xmlFree (xhtml);
-			} else {
-				item_set_description (item, content);
-			}
-
-			/* Optional meta data */
-			const gchar *tmp = json_api_get_string (node, mapping->author);
-			if (tmp)
-				item->metadata = metadata_list_append (item->metadata, "author", tmp);
-	
-			items = g_list_append (items, (gpointer)item);
-
-			/* Allow optional item callback to process stuff */
-			if (callback)
-				(*callback)(node, item);
-				
-			iter = g_list_next (iter);
-		}
-
-		g_list_free (elements);
-		g_object_unref (parser);
-	} else {
+	if (json_parser_load_from_data (parser, json, -1, NULL))
+		items = json_api_get_items_from_node (json_parser_get_root (parser), root, mapping, callback);
+	else
 		debug1 (DEBUG_PARSING, "Could not parse JSON \"%s\"", json);
-	}
+
+	g_object_unref (parser);
 
 	return items;
 }
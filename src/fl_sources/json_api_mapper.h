@@ -52,4 +52,18 @@ typedef void (*jsonApiItemCallbackFunc)(JsonNode *node, itemPtr item);
  */
 GList * json_api_get_items (const gchar *json, const gchar *root, jsonApiMapping *mapping, jsonApiItemCallbackFunc callback);
 
+/**
+ * Extracts all items from an already parsed JSON document. Use this
+ * when other fields (e.g. a continuation token) are needed from the
+ * same document.
+ *
+ * @param document	the root node of the parsed JSON document
+ * @param root		the name of the root node (e.g. "items")
+ * @param mapping	hash table defining location steps and logic
+ * @param callback	optional callback function to process item node
+ *
+ * @returns a list of items (all to be freed with item_free()) or NULL
+ */
+GList * json_api_get_items_from_node (JsonNode *document, const gchar *root, jsonApiMapping *mapping, jsonApiItemCallbackFunc callback);
+
 #endif
@@ -184,6 +184,16 @@ typedef struct nodeSourceType {
 	 */
 	void		(*convert_to_local) (nodePtr node);
 
+	/**
+	 * Marks all items of a subscription as read on the remote side
+	 * with a single request. The local DB was already updated in bulk
+	 * when this is called. Sources implementing item_mark_read()
+	 * without this method get their items marked read one by one.
+	 *
+	 * This is an OPTIONAL method.
+	 */
+	void		(*item_mark_all_read) (nodePtr node);
+
 } *nodeSourceTypePtr;
 
 /** feed list source instance */
@@ -31,6 +31,7 @@
 #include "common.h"
 #include "debug.h"
 #include "feedlist.h"
+#include "net_monitor.h"
 #include "item_state.h"
 #include "metadata.h"
 #include "node.h"
@@ -47,6 +48,17 @@
 /** default Reedah subscription list update interval = once a day */
 #define REEDAH_SOURCE_UPDATE_INTERVAL 60*60*24
 
+/* replay edits that were queued while offline */
+static void
+reedah_source_online_status_changed (gpointer instance, gboolean online, gpointer userdata)
+{
+	ReedahSourcePtr source = (ReedahSourcePtr) userdata;
+
+	/* without login the next update will log in and process the queue */
+	if (online && source->loginState == REEDAH_SOURCE_STATE_ACTIVE)
+		reedah_source_edit_process (source);
+}
+
 /** create a Reedah source with given node as root */ 
 static ReedahSourcePtr
 reedah_source_new (nodePtr node) 
@@ -56,6 +68,23 @@ reedah_source_new (nodePtr node)
 	source->actionQueue = g_queue_new (); 
 	source->loginState = REEDAH_SOURCE_STATE_NONE; 
 	source->lastTimestampMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	source->lastUnreadCountMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	source->pendingTimestampMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	source->pendingUnreadCountMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	source->sync.name = "Reedah";
+	source->sync.readingListUrl = REEDAH_READER_READING_LIST_URL;
+	source->sync.source = source;
+	source->sync.root = node;
+	source->sync.authHeaderValue = &source->authHeaderValue;
+	source->sync.get_nodes = NULL;
+	source->sync.is_in_queue = (googleReaderApiIsInQueueFunc)reedah_source_edit_is_in_queue;
+
+	g_signal_connect (network_monitor_get (), "online-status-changed",
+	                  G_CALLBACK (reedah_source_online_status_changed), source);
+
+	/* actions not confirmed before the last shutdown */
+	reedah_source_edit_restore (source);
 	
 	return source;
 }
@@ -67,10 +96,14 @@ reedah_source_free (ReedahSourcePtr gsource)
 		return;
 
 	update_job_cancel_by_owner (gsource);
+	g_signal_handlers_disconnect_by_data (network_monitor_get (), gsource);
 	
 	g_free (gsource->authHeaderValue);
 	g_queue_free (gsource->actionQueue) ;
 	g_hash_table_unref (gsource->lastTimestampMap);
+	g_hash_table_unref (gsource->lastUnreadCountMap);
+	g_hash_table_unref (gsource->pendingTimestampMap);
+	g_hash_table_unref (gsource->pendingUnreadCountMap);
 	g_free (gsource);
 }
 
@@ -193,6 +226,10 @@ reedah_source_auto_update (nodePtr node)
 	if (source->loginState == REEDAH_SOURCE_STATE_IN_PROGRESS) 
 		return; /* the update will start automatically anyway */
 
+	/* send edits again that failed before */
+	if (source->loginState == REEDAH_SOURCE_STATE_ACTIVE)
+		reedah_source_edit_retry (source);
+
 	debug0 (DEBUG_UPDATE, "reedah_source_auto_update()");
 
 	g_get_current_time (&now);
@@ -203,7 +240,9 @@ reedah_source_auto_update (nodePtr node)
 		g_get_current_time (&source->lastQuickUpdate);
 	}
 	else if (source->lastQuickUpdate.tv_sec + REEDAH_SOURCE_QUICK_UPDATE_INTERVAL <= now.tv_sec) {
-		reedah_source_opml_quick_update (source);
+		/* only fetch what changed, if possible for the whole account at once */
+		if (!google_reader_api_sync (&source->sync))
+			reedah_source_opml_quick_update (source);
 		reedah_source_edit_process (source);
 		g_get_current_time (&source->lastQuickUpdate);
 	}
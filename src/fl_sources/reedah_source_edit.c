@@ -26,97 +26,46 @@
 #include "subscription.h"
 #include "common.h"
 #include "feedlist.h"
+#include "db.h"
+#include "net_monitor.h"
 
 
 #include "reedah_source.h"
 #include "reedah_source_edit.h"
+#include "fl_sources/google_reader_api_edit.h"
 #include "config.h"
 #include <libxml/xmlwriter.h>
 #include <libxml/xmlreader.h>
 #include <glib/gstdio.h>
 #include "xml.h"
 
-/**
- * A structure to indicate an edit to the Reedah "database".
- * These edits are put in a queue and processed in sequential order
- * so that Reedah does not end up processing the requests in an 
- * unintended order.
- */
-typedef struct ReedahSourceAction {
-	/**
-	 * The guid of the item to edit. This will be ignored if the 
-	 * edit is acting on an subscription rather than an item.
-	 */
-	gchar* guid;
-
-	/**
-	 * A MANDATORY feed url to containing the item, or the url of the 
-	 * subscription to edit. 
-	 */
-	gchar* feedUrl;
-
-	/**
-	 * The source type. Currently known types are "feed" and "user".
-	 * "user" sources are used, for example, for items that are links (as
-	 * opposed to posts) in broadcast-friends. The unique id of the source
-	 * is of the form <feedUrlType>/<feedUrl>.
-	 */
-	gchar* feedUrlType; 
-
-	/**
-	 * A callback function on completion of the edit.
-	 */
-	void (*callback) (ReedahSourcePtr gsource, struct ReedahSourceAction* edit, gboolean success);
-
-	/**
-	 * The type of this ReedahSourceAction.
-	 */
-	int actionType ; 
-} *ReedahSourceActionPtr ; 
-
-enum { 
-	EDIT_ACTION_MARK_READ,
-	EDIT_ACTION_MARK_UNREAD,
-	EDIT_ACTION_TRACKING_MARK_UNREAD, /**< every UNREAD request, should be followed by tracking-kept-unread */
-	EDIT_ACTION_MARK_STARRED,
-	EDIT_ACTION_MARK_UNSTARRED,
-	EDIT_ACTION_ADD_SUBSCRIPTION,
-	EDIT_ACTION_REMOVE_SUBSCRIPTION
-} ;
-		
-
-typedef struct ReedahSourceAction* editPtr ;
+/** Edits are queued as shared Google Reader API actions */
+typedef googleReaderApiActionPtr ReedahSourceActionPtr;
 
 typedef struct ReedahSourceActionCtxt { 
 	gchar   *nodeId ;
-	ReedahSourceActionPtr action; 
+	GSList  *actions;	/**< all actions sent with one request */
+	gint64  started;	/**< time the request was sent */
 } *ReedahSourceActionCtxtPtr; 
 
+/** Delay (in seconds) before retrying a failed edit request */
+#define EDIT_RETRY_DELAY_MIN 30
 
-static void reedah_source_edit_push (ReedahSourcePtr gsource, ReedahSourceActionPtr action, gboolean head);
+/** Maximum delay (in seconds) between retries of failed edit requests */
+#define EDIT_RETRY_DELAY_MAX 3600
 
 
-static ReedahSourceActionPtr 
-reedah_source_action_new (void)
-{
-	ReedahSourceActionPtr action = g_slice_new0 (struct ReedahSourceAction);
-	return action;
-}
+static void reedah_source_edit_push (ReedahSourcePtr gsource, ReedahSourceActionPtr action, gboolean head);
+static void reedah_source_edit_push_ (ReedahSourcePtr gsource, ReedahSourceActionPtr action, gboolean head);
 
-static void 
-reedah_source_action_free (ReedahSourceActionPtr action)
-{ 
-	g_free (action->guid);
-	g_free (action->feedUrl);
-	g_slice_free (struct ReedahSourceAction, action);
-}
 
 static ReedahSourceActionCtxtPtr
-reedah_source_action_context_new(ReedahSourcePtr gsource, ReedahSourceActionPtr action)
+reedah_source_action_context_new(ReedahSourcePtr gsource, GSList *actions)
 {
 	ReedahSourceActionCtxtPtr ctxt = g_slice_new0(struct ReedahSourceActionCtxt);
 	ctxt->nodeId = g_strdup(gsource->root->id);
-	ctxt->action = action;
+	ctxt->actions = actions;
+	ctxt->started = g_get_monotonic_time ();
 	return ctxt;
 }
 
@@ -127,34 +76,98 @@ reedah_source_action_context_free(ReedahSourceActionCtxtPtr ctxt)
 	g_slice_free(struct ReedahSourceActionCtxt, ctxt);
 }
 
+static void
+reedah_source_edit_log_summary (ReedahSourcePtr gsource, const gchar *event)
+{
+	debug6 (DEBUG_UPDATE, "reedah_source: %s: %u queued, %u replayed, %u flushed, %u dropped, %u still queued",
+	        event, gsource->editsQueued, gsource->editsReplayed, gsource->editsFlushed, gsource->editsDropped,
+	        g_queue_get_length (gsource->actionQueue));
+}
+
+/* the actions stay queued until the next auto update after the delay */
+static void
+reedah_source_edit_schedule_retry (ReedahSourcePtr gsource)
+{
+	gsource->editRetryDelay = CLAMP (gsource->editRetryDelay * 2, EDIT_RETRY_DELAY_MIN, EDIT_RETRY_DELAY_MAX);
+	gsource->editRetryTime = g_get_monotonic_time () + (gint64)gsource->editRetryDelay * G_USEC_PER_SEC;
+	debug1 (DEBUG_UPDATE, "reedah_source: retrying queued edits in %us", gsource->editRetryDelay);
+}
+
+void
+reedah_source_edit_retry (ReedahSourcePtr gsource)
+{
+	if (!gsource->editRetryTime || g_get_monotonic_time () < gsource->editRetryTime)
+		return;
+
+	gsource->editRetryTime = 0;
+	reedah_source_edit_process (gsource);
+}
+
 static void
 reedah_source_edit_action_complete (const struct updateResult* const result, gpointer userdata, updateFlags flags) 
 { 
 	ReedahSourceActionCtxtPtr     editCtxt = (ReedahSourceActionCtxtPtr) userdata; 
 	nodePtr                       node = node_from_id (editCtxt->nodeId);
 	ReedahSourcePtr               gsource; 
-	ReedahSourceActionPtr         action = editCtxt->action ;
+	GSList                        *actions = editCtxt->actions;
+	GSList                        *iter;
+	gboolean                      success;
+	gint64                        duration = g_get_monotonic_time () - editCtxt->started;
 	
 	reedah_source_action_context_free (editCtxt);
 
 	if (!node) {
-		reedah_source_action_free (action);
+		g_slist_free_full (actions, (GDestroyNotify)google_reader_api_action_free);
 		return; /* probably got deleted before this callback */
 	} 
 	gsource = (ReedahSourcePtr) node->data;
-		
-	if (result->data == NULL || !g_str_equal (result->data, "OK")) {
-		if (action->callback) 
-			(*action->callback) (gsource, action, FALSE);
+
+	/* Without an answer the actions stay journaled and are put
+	   back to be sent again on the next edit or when going online */
+	if (!result->data || result->httpstatus != 200) {
+		debug1 (DEBUG_UPDATE, "reedah_source: edit request failed (HTTP status %d), keeping actions queued", result->httpstatus);
+		actions = g_slist_reverse (actions);
+		for (iter = actions; iter; iter = g_slist_next (iter))
+			reedah_source_edit_push_ (gsource, (ReedahSourceActionPtr)iter->data, TRUE);
+		g_slist_free (actions);
+		reedah_source_edit_log_summary (gsource, "flush failed");
+		reedah_source_edit_schedule_retry (gsource);
+		return;
+	}
+
+	success = g_str_equal (result->data, "OK");
+	if (!success)
 		debug1 (DEBUG_UPDATE, "The edit action failed with result: %s\n", result->data);
-		reedah_source_action_free (action);
-		return; /** @todo start a timer for next processing */
+
+	/* rejected actions would fail again, so they are dropped too */
+	for (iter = actions; iter; iter = g_slist_next (iter)) {
+		ReedahSourceActionPtr action = (ReedahSourceActionPtr)iter->data;
+		db_pending_action_remove (action->journalId);
+		if (action->callback)
+			(*action->callback) (gsource, action, success);
+	}
+
+	if (success)
+		gsource->editsFlushed += g_slist_length (actions);
+	else
+		gsource->editsDropped += g_slist_length (actions);
+	gsource->editFlushTime += duration;
+	debug4 (DEBUG_UPDATE, "reedah_source: flushed %u actions in %" G_GINT64_FORMAT "ms (%.1f/s overall), %u still queued",
+	        g_slist_length (actions), duration / 1000,
+	        gsource->editsFlushed * (gdouble)G_USEC_PER_SEC / MAX (gsource->editFlushTime, 1),
+	        g_queue_get_length (gsource->actionQueue));
+	reedah_source_edit_log_summary (gsource, success?"flushed":"rejected");
+
+	g_slist_free_full (actions, (GDestroyNotify)google_reader_api_action_free);
+
+	/* the rest of the queue is sent later, it might be rejected too */
+	if (!success) {
+		reedah_source_edit_schedule_retry (gsource);
+		return;
 	}
-	
-	if (action->callback)
-		action->callback (gsource, action, TRUE);
 
-	reedah_source_action_free (action);
+	gsource->editRetryDelay = 0;
+	gsource->editRetryTime = 0;
 
 	/* process anything else waiting on the edit queue */
 	reedah_source_edit_process (gsource);
@@ -186,68 +199,82 @@ reedah_source_api_remove_subscription (ReedahSourceActionPtr action, updateReque
 }
 
 static void 
-reedah_source_api_edit_tag (ReedahSourceActionPtr action, updateRequestPtr request, const gchar*token) 
+reedah_source_api_edit_tag (GSList *actions, updateRequestPtr request, const gchar*token) 
 {
+	ReedahSourceActionPtr action = (ReedahSourceActionPtr)actions->data;
+	const gchar	*addTag = NULL, *removeTag = NULL;
+	GString		*postdata;
+	gchar		*escaped;
+
 	update_request_set_source (request, REEDAH_READER_EDIT_TAG_URL); 
 
-	const gchar* prefix = "feed" ; 
-	gchar* s_escaped = g_uri_escape_string (action->feedUrl, NULL, TRUE);
-	gchar* a_escaped = NULL ;
-	gchar* i_escaped = g_uri_escape_string (action->guid, NULL, TRUE);
-	gchar* postdata = NULL ;
+	switch (action->actionType) {
+		case EDIT_ACTION_MARK_UNREAD:
+			addTag = REEDAH_READER_TAG_KEPT_UNREAD;
+			removeTag = REEDAH_READER_TAG_READ;
+			break;
+		case EDIT_ACTION_MARK_READ:
+			addTag = REEDAH_READER_TAG_READ;
+			break;
+		case EDIT_ACTION_TRACKING_MARK_UNREAD:
+			addTag = REEDAH_READER_TAG_TRACKING_KEPT_UNREAD;
+			break;
+		case EDIT_ACTION_MARK_STARRED:
+			addTag = REEDAH_READER_TAG_STARRED;
+			break;
+		case EDIT_ACTION_MARK_UNSTARRED:
+			removeTag = REEDAH_READER_TAG_STARRED;
+			break;
+		default:
+			g_assert (FALSE);
+	}
 
-	/*
-	 * If the source of the item is a feed then the source *id* will be of
-	 * the form tag:google.com,2005:reader/feed/http://foo.com/bar
-	 * If the item is a shared link it is of the form
-	 * tag:google.com,2005:reader/user/<sharer's-id>/source/com.google/link
-	 * It is possible that there are items other thank link that has
-	 * the ../user/.. id. The GR API requires the strings after ..:reader/
-	 * while ReedahSourceAction only gives me after :reader/feed/ (or 
-	 * :reader/user/ as the case might be). I therefore need to guess
-	 * the prefix ('feed/' or 'user/') from just this information. 
-	 */
+	/* All actions in the list share the same tag operation, the API
+	   accepts many item ids with their sources in a single call */
+	postdata = g_string_new (NULL);
+	for (; actions; actions = g_slist_next (actions)) {
+		const gchar *prefix = "feed";
 
-	if (strstr(action->feedUrl, "://") == NULL) 
-		prefix = "user" ;
+		action = (ReedahSourceActionPtr)actions->data;
 
-	if (action->actionType == EDIT_ACTION_MARK_UNREAD) {
-		a_escaped = g_uri_escape_string (REEDAH_READER_TAG_KEPT_UNREAD, NULL, TRUE);
-		gchar *r_escaped = g_uri_escape_string (REEDAH_READER_TAG_READ, NULL, TRUE);
-		postdata = g_strdup_printf (REEDAH_READER_EDIT_TAG_AR_TAG, i_escaped, prefix, s_escaped, a_escaped, r_escaped, token);
-		g_free (r_escaped);
-	}
-	else if (action->actionType == EDIT_ACTION_MARK_READ) { 
-		a_escaped = g_uri_escape_string (REEDAH_READER_TAG_READ, NULL, TRUE);
-		postdata = g_strdup_printf (REEDAH_READER_EDIT_TAG_ADD_TAG, i_escaped, prefix, s_escaped, a_escaped, token);
+		/*
+		 * If the source of the item is a feed then the source *id* will be of
+		 * the form tag:google.com,2005:reader/feed/http://foo.com/bar
+		 * If the item is a shared link it is of the form
+		 * tag:google.com,2005:reader/user/<sharer's-id>/source/com.google/link
+		 * It is possible that there are items other thank link that has
+		 * the ../user/.. id. The GR API requires the strings after ..:reader/
+		 * while ReedahSourceAction only gives me after :reader/feed/ (or 
+		 * :reader/user/ as the case might be). I therefore need to guess
+		 * the prefix ('feed/' or 'user/') from just this information. 
+		 */
+		if (strstr(action->feedUrl, "://") == NULL) 
+			prefix = "user" ;
+
+		escaped = g_uri_escape_string (action->guid, NULL, TRUE);
+		g_string_append_printf (postdata, "i=%s&", escaped);
+		g_free (escaped);
+
+		escaped = g_uri_escape_string (action->feedUrl, NULL, TRUE);
+		g_string_append_printf (postdata, "s=%s%%2F%s&", prefix, escaped);
+		g_free (escaped);
 	}
-	else if (action->actionType == EDIT_ACTION_TRACKING_MARK_UNREAD) {
-		a_escaped = g_uri_escape_string (REEDAH_READER_TAG_TRACKING_KEPT_UNREAD, NULL, TRUE);
-		postdata = g_strdup_printf (REEDAH_READER_EDIT_TAG_ADD_TAG, i_escaped, prefix, s_escaped, a_escaped, token);
-	}  
-	else if (action->actionType == EDIT_ACTION_MARK_STARRED) { 
-		a_escaped = g_uri_escape_string (REEDAH_READER_TAG_STARRED, NULL, TRUE) ;
-		postdata = g_strdup_printf (
-			REEDAH_READER_EDIT_TAG_ADD_TAG, i_escaped, prefix,
-			s_escaped, a_escaped, token);
+
+	if (addTag) {
+		escaped = g_uri_escape_string (addTag, NULL, TRUE);
+		g_string_append_printf (postdata, "a=%s&", escaped);
+		g_free (escaped);
 	}
-	else if (action->actionType == EDIT_ACTION_MARK_UNSTARRED) {
-		gchar* r_escaped = g_uri_escape_string(REEDAH_READER_TAG_STARRED, NULL, TRUE);
-		postdata = g_strdup_printf (
-			REEDAH_READER_EDIT_TAG_REMOVE_TAG, i_escaped, prefix,
-			s_escaped, r_escaped, token);
+	if (removeTag) {
+		escaped = g_uri_escape_string (removeTag, NULL, TRUE);
+		g_string_append_printf (postdata, "r=%s&", escaped);
+		g_free (escaped);
 	}
-	
-	else g_assert (FALSE);
-	
-	g_free (s_escaped);
-	g_free (a_escaped); 
-	g_free (i_escaped);
-	
-	debug1 (DEBUG_UPDATE, "reedah_source: postdata [%s]", postdata);
+	g_string_append_printf (postdata, "ac=edit-tags&T=%s&async=true", token);
 
+	debug1 (DEBUG_UPDATE, "reedah_source: postdata [%s]", postdata->str);
 
-	request->postdata = postdata;
+	request->postdata = g_string_free (postdata, FALSE);
 }
 
 static void
@@ -257,13 +284,9 @@ reedah_source_edit_token_cb (const struct updateResult * const result, gpointer
 	ReedahSourcePtr  gsource;
 	const gchar*     token;
 	ReedahSourceActionPtr          action;
+	GSList           *actions;
 	updateRequestPtr request; 
 
-	if (result->httpstatus != 200 || result->data == NULL) { 
-		/* FIXME: What is the behaviour that should go here? */
-		return;
-	}
-
 	node = node_from_id ((gchar*) userdata);
 	g_free (userdata);
 	
@@ -273,32 +296,36 @@ reedah_source_edit_token_cb (const struct updateResult * const result, gpointer
 	gsource = (ReedahSourcePtr) node->data;
 
 
-	token = result->data; 
-
 	if (!gsource || g_queue_is_empty (gsource->actionQueue))
 		return;
 
-	action = g_queue_peek_head (gsource->actionQueue);
+	/* nothing was popped from the queue yet */
+	if (result->httpstatus != 200 || result->data == NULL) {
+		debug1 (DEBUG_UPDATE, "reedah_source: edit token request failed (HTTP status %d)", result->httpstatus);
+		reedah_source_edit_schedule_retry (gsource);
+		return;
+	}
+
+	token = result->data; 
+
+	actions = google_reader_api_edit_pop_batch (gsource->actionQueue);
+	action = (ReedahSourceActionPtr)actions->data;
 
 	request = update_request_new ();
 	request->updateState = update_state_copy (gsource->root->subscription->updateState);
 	request->options = update_options_copy (gsource->root->subscription->updateOptions) ;
 	update_request_set_auth_value (request, gsource->authHeaderValue);
 
-	if (action->actionType == EDIT_ACTION_MARK_READ || 
-	    action->actionType == EDIT_ACTION_MARK_UNREAD || 
-	    action->actionType == EDIT_ACTION_TRACKING_MARK_UNREAD ||
-	    action->actionType == EDIT_ACTION_MARK_STARRED || 
-	    action->actionType == EDIT_ACTION_MARK_UNSTARRED) 
-		reedah_source_api_edit_tag (action, request, token);
+	if (google_reader_api_action_is_edit_tag (action))
+		reedah_source_api_edit_tag (actions, request, token);
 	else if (action->actionType == EDIT_ACTION_ADD_SUBSCRIPTION ) 
 		reedah_source_api_add_subscription (action, request, token);
 	else if (action->actionType == EDIT_ACTION_REMOVE_SUBSCRIPTION )
 		reedah_source_api_remove_subscription (action, request, token) ;
 
-	update_execute_request (gsource, request, reedah_source_edit_action_complete, reedah_source_action_context_new(gsource, action), 0);
+	debug2 (DEBUG_UPDATE, "reedah_source: sending %u actions, %u still queued", g_slist_length (actions), g_queue_get_length (gsource->actionQueue));
 
-	action = g_queue_pop_head (gsource->actionQueue);
+	update_execute_request (gsource, request, reedah_source_edit_action_complete, reedah_source_action_context_new(gsource, actions), 0);
 }
 
 void
@@ -309,6 +336,10 @@ reedah_source_edit_process (ReedahSourcePtr gsource)
 	g_assert (gsource);
 	if (g_queue_is_empty (gsource->actionQueue))
 		return;
+
+	/* the journal keeps the actions until we are online again */
+	if (!network_monitor_is_online ())
+		return;
 	
 	/*
  	* Google reader has a system of tokens. So first, I need to request a 
@@ -339,6 +370,8 @@ reedah_source_edit_push (ReedahSourcePtr gsource, ReedahSourceActionPtr action,
 {
 	g_assert (gsource);
 	nodePtr root = gsource->root;
+	action->journalId = db_pending_action_add (root->id, action->actionType, action->guid, action->feedUrl);
+	gsource->editsQueued++;
 	reedah_source_edit_push_ (gsource, action, head);
 
 	/** @todo any flags I should specify? */
@@ -349,7 +382,7 @@ reedah_source_edit_push (ReedahSourcePtr gsource, ReedahSourceActionPtr action,
 }
 
 static void 
-update_read_state_callback (ReedahSourcePtr gsource, ReedahSourceActionPtr action, gboolean success) 
+update_read_state_callback (gpointer data, ReedahSourceActionPtr action, gboolean success) 
 {
 	if (success) {
 		// FIXME: call item_read_state_changed (item, newState);
@@ -361,13 +394,19 @@ update_read_state_callback (ReedahSourcePtr gsource, ReedahSourceActionPtr actio
 void
 reedah_source_edit_mark_read (ReedahSourcePtr gsource, const gchar *guid, const gchar *feedUrl,	gboolean newStatus)
 {
-	ReedahSourceActionPtr action = reedah_source_action_new ();
+	ReedahSourceActionPtr action = google_reader_api_action_new ();
 
 	action->guid = g_strdup (guid);
 	action->feedUrl = g_strdup (feedUrl);
 	action->actionType = newStatus ? EDIT_ACTION_MARK_READ :
 	                           EDIT_ACTION_MARK_UNREAD;
 	action->callback = update_read_state_callback;
+
+	/* a pending opposite change was not sent yet, so both can be dropped */
+	if (google_reader_api_edit_cancel_opposite (gsource, gsource->actionQueue, action, &gsource->editsDropped)) {
+		google_reader_api_action_free (action);
+		return;
+	}
 	
 	reedah_source_edit_push (gsource, action, FALSE);
 
@@ -377,7 +416,7 @@ reedah_source_edit_mark_read (ReedahSourcePtr gsource, const gchar *guid, const
 		 * I also need to mark it as tracking-kept-unread in a separate
 		 * network call.
 		 */
-		action = reedah_source_action_new ();
+		action = google_reader_api_action_new ();
 		action->guid = g_strdup (guid);
 		action->feedUrl = g_strdup (feedUrl);
 		action->actionType = EDIT_ACTION_TRACKING_MARK_UNREAD;
@@ -386,7 +425,7 @@ reedah_source_edit_mark_read (ReedahSourcePtr gsource, const gchar *guid, const
 }
 
 static void
-update_starred_state_callback(ReedahSourcePtr gsource, ReedahSourceActionPtr action, gboolean success) 
+update_starred_state_callback(gpointer data, ReedahSourceActionPtr action, gboolean success) 
 {
 	if (success) {
 		// FIXME: call item_flag_changed (item, newState);
@@ -398,19 +437,26 @@ update_starred_state_callback(ReedahSourcePtr gsource, ReedahSourceActionPtr act
 void
 reedah_source_edit_mark_starred (ReedahSourcePtr gsource, const gchar *guid, const gchar *feedUrl, gboolean newStatus)
 {
-	ReedahSourceActionPtr action = reedah_source_action_new ();
+	ReedahSourceActionPtr action = google_reader_api_action_new ();
 
 	action->guid = g_strdup (guid);
 	action->feedUrl = g_strdup (feedUrl);
 	action->actionType = newStatus ? EDIT_ACTION_MARK_STARRED : EDIT_ACTION_MARK_UNSTARRED;
 	action->callback = update_starred_state_callback;
+
+	if (google_reader_api_edit_cancel_opposite (gsource, gsource->actionQueue, action, &gsource->editsDropped)) {
+		google_reader_api_action_free (action);
+		return;
+	}
 	
 	reedah_source_edit_push (gsource, action, FALSE);
 }
 
 static void 
-update_subscription_list_callback(ReedahSourcePtr gsource, ReedahSourceActionPtr action, gboolean success) 
+update_subscription_list_callback(gpointer data, ReedahSourceActionPtr action, gboolean success) 
 {
+	ReedahSourcePtr gsource = (ReedahSourcePtr) data;
+
 	if (success) { 
 		/*
 		 * It is possible that Google changed the name of the URL that
@@ -436,7 +482,7 @@ update_subscription_list_callback(ReedahSourcePtr gsource, ReedahSourceActionPtr
 void 
 reedah_source_edit_add_subscription (ReedahSourcePtr gsource, const gchar* feedUrl)
 {
-	ReedahSourceActionPtr action = reedah_source_action_new () ;
+	ReedahSourceActionPtr action = google_reader_api_action_new () ;
 	action->actionType = EDIT_ACTION_ADD_SUBSCRIPTION; 
 	action->feedUrl = g_strdup (feedUrl);
 	action->callback = update_subscription_list_callback;
@@ -444,8 +490,10 @@ reedah_source_edit_add_subscription (ReedahSourcePtr gsource, const gchar* feedU
 }
 
 static void
-reedah_source_edit_remove_callback (ReedahSourcePtr gsource, ReedahSourceActionPtr action, gboolean success)
+reedah_source_edit_remove_callback (gpointer data, ReedahSourceActionPtr action, gboolean success)
 {
+	ReedahSourcePtr gsource = (ReedahSourcePtr) data;
+
 	if (success) {	
 		/* 
 		 * The node was removed from the feedlist, but could have
@@ -466,7 +514,7 @@ reedah_source_edit_remove_callback (ReedahSourcePtr gsource, ReedahSourceActionP
 
 void reedah_source_edit_remove_subscription (ReedahSourcePtr gsource, const gchar* feedUrl) 
 {
-	ReedahSourceActionPtr action = reedah_source_action_new (); 
+	ReedahSourceActionPtr action = google_reader_api_action_new (); 
 	action->actionType = EDIT_ACTION_REMOVE_SUBSCRIPTION;
 	action->feedUrl = g_strdup (feedUrl);
 	action->callback = reedah_source_edit_remove_callback;
@@ -484,3 +532,53 @@ gboolean reedah_source_edit_is_in_queue (ReedahSourcePtr gsource, const gchar* g
 	}
 	return FALSE;
 }
+
+void
+reedah_source_edit_restore (ReedahSourcePtr gsource)
+{
+	GSList	*actions, *iter;
+
+	actions = db_pending_actions_load (gsource->root->id);
+	for (iter = actions; iter; iter = g_slist_next (iter)) {
+		pendingActionPtr		pending = (pendingActionPtr)iter->data;
+		ReedahSourceActionPtr	action = google_reader_api_action_new ();
+
+		action->journalId = pending->id;
+		action->actionType = pending->type;
+		action->guid = pending->guid;
+		action->feedUrl = pending->feedUrl;
+		g_free (pending);
+
+		switch (action->actionType) {
+			case EDIT_ACTION_MARK_READ:
+			case EDIT_ACTION_MARK_UNREAD:
+				action->callback = update_read_state_callback;
+				break;
+			case EDIT_ACTION_TRACKING_MARK_UNREAD:
+				break;
+			case EDIT_ACTION_MARK_STARRED:
+			case EDIT_ACTION_MARK_UNSTARRED:
+				action->callback = update_starred_state_callback;
+				break;
+			case EDIT_ACTION_ADD_SUBSCRIPTION:
+				action->callback = update_subscription_list_callback;
+				break;
+			case EDIT_ACTION_REMOVE_SUBSCRIPTION:
+				action->callback = reedah_source_edit_remove_callback;
+				break;
+			default:
+				g_warning ("Dropping journaled action of unknown type %d!", action->actionType);
+				db_pending_action_remove (action->journalId);
+				google_reader_api_action_free (action);
+				gsource->editsDropped++;
+				continue;
+		}
+
+		reedah_source_edit_push_ (gsource, action, FALSE);
+		gsource->editsReplayed++;
+	}
+
+	if (actions)
+		reedah_source_edit_log_summary (gsource, "restored journal");
+	g_slist_free (actions);
+}
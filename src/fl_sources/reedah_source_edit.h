@@ -33,6 +33,23 @@
  */
 void reedah_source_edit_process (ReedahSourcePtr gsource);
 
+/**
+ * Process the edit queue again if an edit request failed before and
+ * its retry delay has passed. Call this on every auto update.
+ * 
+ * @param gsource The ReedahSource whose editQueue should be retried.
+ */
+void reedah_source_edit_retry (ReedahSourcePtr gsource);
+
+/**
+ * Loads the actions journaled in the DB that were not yet confirmed
+ * by the server into the edit queue. Call this once after setting up
+ * the source, the actions are sent after the next login.
+ * 
+ * @param gsource The ReedahSource whose editQueue should be restored.
+ */
+void reedah_source_edit_restore (ReedahSourcePtr gsource);
+
 
 /** Edit wrappers */
 
@@ -35,6 +35,7 @@
 #include "node.h"
 #include "reedah_source_edit.h"
 #include "reedah_source.h"
+#include "reedah_source_feed_list.h"
 #include "subscription.h"
 #include "xml.h"
 
@@ -101,6 +102,8 @@ reedah_item_callback (JsonNode *node, itemPtr item)
 static void
 reedah_feed_subscription_process_update_result (subscriptionPtr subscription, const struct updateResult* const result, updateFlags flags)
 {
+	ReedahSourcePtr gsource = (ReedahSourcePtr) node_source_root_from_node (subscription->node)->data;
+
 	if (result->data && result->httpstatus == 200) {
 		GList		*items = NULL;
 		jsonApiMapping	mapping;
@@ -158,6 +161,8 @@ reedah_feed_subscription_process_update_result (subscriptionPtr subscription, co
 	} else {
 		subscription->node->available = FALSE;
 	}
+
+	reedah_source_opml_quick_update_done (gsource, subscription, subscription->node->available);
 }
 
 static gboolean
@@ -197,80 +197,162 @@ reedah_subscription_opml_cb (subscriptionPtr subscription, const struct updateRe
 		debug0 (DEBUG_UPDATE, "reedah_subscription_cb(): ERROR: failed to get subscription list!");
 	}
 
-	if (!(flags & REEDAH_SOURCE_UPDATE_ONLY_LIST))
-		node_foreach_child_data (subscription->node, node_update_subscription, GUINT_TO_POINTER (0));
+	if (!(flags & REEDAH_SOURCE_UPDATE_ONLY_LIST)) {
+		GTimeVal now;
+
+		/* Changed feeds are updated now, later syncs can continue from here */
+		g_get_current_time (&now);
+		source->sync.timestamp = now.tv_sec;
+
+		reedah_source_opml_quick_update (source);
+	}
 }
 
 /** functions for an efficient updating mechanism */
 
+/**
+ * Updates the given feed if its unread count or newest item timestamp
+ * differ from the ones seen last time.
+ */
 static void
-reedah_source_opml_quick_update_helper (xmlNodePtr match, gpointer userdata) 
+reedah_source_opml_quick_update_node (ReedahSourcePtr gsource, nodePtr node, gint count, const gchar *newestItemTimestamp)
 {
-	ReedahSourcePtr gsource = (ReedahSourcePtr) userdata;
-	xmlNodePtr      xmlNode;
-	xmlChar         *id, *newestItemTimestamp;
-	nodePtr         node = NULL; 
-	const gchar     *oldNewestItemTimestamp;
-
-	xmlNode = xpath_find (match, "./string[@name='id']");
-	id = xmlNodeGetContent (xmlNode); 
-
-	if (g_str_has_prefix (id, "feed/"))
-		node = reedah_source_opml_get_node_by_source (gsource, id + strlen ("feed/"));
-	else {
-		xmlFree (id);
-		return;
-	}
+	const gchar	*oldNewestItemTimestamp;
+	gpointer	oldCount;
+
+	oldNewestItemTimestamp = g_hash_table_lookup (gsource->lastTimestampMap, node->subscription->source);
+	oldCount = g_hash_table_lookup (gsource->lastUnreadCountMap, node->subscription->source);
 
-	if (node == NULL) {
-		xmlFree (id);
+	if (oldCount && GPOINTER_TO_INT (oldCount) - 1 == count &&
+	    !g_strcmp0 (oldNewestItemTimestamp, newestItemTimestamp))
 		return;
-	}
 
-	xmlNode = xpath_find (match, "./number[@name='newestItemTimestampUsec']");
-	newestItemTimestamp = xmlNodeGetContent (xmlNode);
+	debug5 (DEBUG_UPDATE, "ReedahSource: auto-updating %s "
+	        "[old count %d, count %d, old timestamp %s, timestamp %s]",
+	        node->subscription->source, GPOINTER_TO_INT (oldCount) - 1, count,
+	        oldNewestItemTimestamp, newestItemTimestamp);
 
-	oldNewestItemTimestamp = g_hash_table_lookup (gsource->lastTimestampMap, node->subscription->source);
+	/* only remembered once the update succeeded */
+	g_hash_table_insert (gsource->pendingTimestampMap,
+	                     g_strdup (node->subscription->source),
+	                     g_strdup (newestItemTimestamp));
+	g_hash_table_insert (gsource->pendingUnreadCountMap,
+	                     g_strdup (node->subscription->source),
+	                     GINT_TO_POINTER (count + 1));
 
-	if (!oldNewestItemTimestamp ||
-	    (newestItemTimestamp && 
-	     !g_str_equal (newestItemTimestamp, oldNewestItemTimestamp))) { 
-		debug3(DEBUG_UPDATE, "ReedahSource: auto-updating %s "
-		       "[oldtimestamp%s, timestamp %s]", 
-		       id, oldNewestItemTimestamp, newestItemTimestamp);
+	subscription_update (node->subscription, 0);
+}
+
+void
+reedah_source_opml_quick_update_done (ReedahSourcePtr gsource, subscriptionPtr subscription, gboolean success)
+{
+	gpointer count = g_hash_table_lookup (gsource->pendingUnreadCountMap, subscription->source);
+
+	if (!count)
+		return;	/* not started by a quick update */
+
+	if (success) {
 		g_hash_table_insert (gsource->lastTimestampMap,
-				    g_strdup (node->subscription->source), 
-				    g_strdup (newestItemTimestamp));
-				    
-		subscription_update (node->subscription, 0);
+		                     g_strdup (subscription->source),
+		                     g_strdup (g_hash_table_lookup (gsource->pendingTimestampMap, subscription->source)));
+		g_hash_table_insert (gsource->lastUnreadCountMap,
+		                     g_strdup (subscription->source),
+		                     count);
 	}
 
-	xmlFree (newestItemTimestamp);
-	xmlFree (id);
+	g_hash_table_remove (gsource->pendingTimestampMap, subscription->source);
+	g_hash_table_remove (gsource->pendingUnreadCountMap, subscription->source);
 }
 
+/* Feeds without unread items might not be listed at all */
 static void
-reedah_source_opml_quick_update_cb (const struct updateResult* const result, gpointer userdata, updateFlags flags) 
+reedah_source_opml_quick_update_unlisted (ReedahSourcePtr gsource, nodePtr folder, GHashTable *listed)
 {
-	ReedahSourcePtr gsource = (ReedahSourcePtr) userdata;
-	xmlDocPtr       doc;
+	GSList	*iter;
 
-	if (!result->data) { 
-		/* what do I do? */
-		debug0 (DEBUG_UPDATE, "ReedahSource: Unable to get unread counts, this update is aborted.");
-		return;
+	for (iter = folder->children; iter; iter = g_slist_next (iter)) {
+		nodePtr node = (nodePtr)iter->data;
+
+		if (node->children)
+			reedah_source_opml_quick_update_unlisted (gsource, node, listed);
+
+		if (!node->subscription || g_hash_table_lookup (listed, node))
+			continue;
+
+		reedah_source_opml_quick_update_node (gsource, node, 0,
+		                                       g_hash_table_lookup (gsource->lastTimestampMap, node->subscription->source));
 	}
-	doc = xml_parse (result->data, result->size, NULL);
-	if (!doc) {
-		debug0 (DEBUG_UPDATE, "ReedahSource: The XML failed to parse, maybe the session has expired. (FIXME)");
+}
+
+/* The timestamp is a string for some services and a number for others */
+static gchar *
+reedah_source_opml_get_timestamp (JsonNode *count)
+{
+	JsonNode *node = json_get_node (count, "newestItemTimestampUsec");
+
+	if (!node || JSON_NODE_TYPE (node) != JSON_NODE_VALUE)
+		return NULL;
+
+	if (json_node_get_value_type (node) == G_TYPE_STRING)
+		return g_strdup (json_node_get_string (node));
+
+	return g_strdup_printf ("%" G_GINT64_FORMAT, json_node_get_int (node));
+}
+
+static void
+reedah_source_opml_quick_update_cb (const struct updateResult* const result, gpointer userdata, updateFlags flags) 
+{
+	ReedahSourcePtr	gsource = (ReedahSourcePtr) userdata;
+	JsonParser	*parser;
+	JsonNode	*list = NULL;
+	GHashTable	*listed;
+	GList		*elements, *iter;
+
+	parser = json_parser_new ();
+	if (result->data && result->httpstatus == 200 &&
+	    json_parser_load_from_data (parser, result->data, -1, NULL))
+		list = json_get_node (json_parser_get_root (parser), "unreadcounts");
+
+	if (!list || JSON_NODE_TYPE (list) != JSON_NODE_ARRAY) {
+		debug0 (DEBUG_UPDATE, "ReedahSource: Unable to get unread counts, updating all feeds.");
+		node_foreach_child_data (gsource->root, node_update_subscription, GUINT_TO_POINTER (0));
+		g_object_unref (parser);
 		return;
 	}
 
-	xpath_foreach_match (xmlDocGetRootElement (doc),
-			    "/object/list[@name='unreadcounts']/object", 
-			    reedah_source_opml_quick_update_helper, gsource);
-	
-	xmlFreeDoc (doc);
+	/* We expect something like this:
+
+	   {"max":1000,
+	    "unreadcounts":[{"id":"feed\/http:\/\/rss.slashdot.org\/Slashdot\/slashdot",
+	                     "count":12,
+	                     "newestItemTimestampUsec":"1375821312282000"},
+	                    ...
+
+	   Labels and states are listed too, but only feeds are of interest. */
+	listed = g_hash_table_new (g_direct_hash, g_direct_equal);
+	elements = iter = json_array_get_elements (json_node_get_array (list));
+	while (iter) {
+		JsonNode	*count = (JsonNode *)iter->data;
+		const gchar	*id = json_get_string (count, "id");
+		nodePtr		node = NULL;
+
+		if (id && g_str_has_prefix (id, "feed/"))
+			node = reedah_source_opml_get_node_by_source (gsource, id + strlen ("feed/"));
+		if (node) {
+			gchar *timestamp = reedah_source_opml_get_timestamp (count);
+
+			g_hash_table_insert (listed, node, node);
+			reedah_source_opml_quick_update_node (gsource, node, json_get_int (count, "count"), timestamp);
+			g_free (timestamp);
+		}
+		iter = g_list_next (iter);
+	}
+	g_list_free (elements);
+
+	reedah_source_opml_quick_update_unlisted (gsource, gsource->root, listed);
+
+	g_hash_table_destroy (listed);
+	g_object_unref (parser);
 }
 
 gboolean
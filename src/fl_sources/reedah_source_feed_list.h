@@ -47,3 +47,15 @@ nodePtr reedah_source_opml_get_subnode_by_node(nodePtr node, const gchar *source
  * @param gsource	the Reedah source
  */
 gboolean reedah_source_opml_quick_update (ReedahSourcePtr gsource);
+
+/**
+ * Remembers the unread count and newest item timestamp a quick update
+ * of the given feed was started for, if the feed update succeeded.
+ * Otherwise the next quick update updates the feed again. Call this
+ * when processing the result of a feed update.
+ *
+ * @param gsource	the Reedah source
+ * @param subscription	the updated feed
+ * @param success	TRUE if the update succeeded
+ */
+void reedah_source_opml_quick_update_done (ReedahSourcePtr gsource, subscriptionPtr subscription, gboolean success);
@@ -31,6 +31,7 @@
 #include "common.h"
 #include "debug.h"
 #include "feedlist.h"
+#include "net_monitor.h"
 #include "item_state.h"
 #include "metadata.h"
 #include "node.h"
@@ -47,6 +48,17 @@
 /** default TheOldReader subscription list update interval = once a day */
 #define THEOLDREADER_SOURCE_UPDATE_INTERVAL 60*60*24
 
+/* replay edits that were queued while offline */
+static void
+theoldreader_source_online_status_changed (gpointer instance, gboolean online, gpointer userdata)
+{
+	TheOldReaderSourcePtr source = (TheOldReaderSourcePtr) userdata;
+
+	/* without login the next update will log in and process the queue */
+	if (online && source->loginState == THEOLDREADER_SOURCE_STATE_ACTIVE)
+		theoldreader_source_edit_process (source);
+}
+
 /** create a source with given node as root */ 
 static TheOldReaderSourcePtr
 theoldreader_source_new (nodePtr node) 
@@ -56,6 +68,24 @@ theoldreader_source_new (nodePtr node)
 	source->actionQueue = g_queue_new (); 
 	source->loginState = THEOLDREADER_SOURCE_STATE_NONE; 
 	source->lastTimestampMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	source->lastUnreadCountMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	source->pendingTimestampMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	source->pendingUnreadCountMap = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	source->sync.name = "TheOldReader";
+	source->sync.readingListUrl = THEOLDREADER_READER_READING_LIST_URL;
+	source->sync.source = source;
+	source->sync.root = node;
+	source->sync.authHeaderValue = &source->authHeaderValue;
+	/* the reading list origin is the feed id and not the feed URL here */
+	source->sync.get_nodes = (googleReaderApiGetNodesFunc)theoldreader_source_opml_get_nodes_by_id;
+	source->sync.is_in_queue = (googleReaderApiIsInQueueFunc)theoldreader_source_edit_is_in_queue;
+
+	g_signal_connect (network_monitor_get (), "online-status-changed",
+	                  G_CALLBACK (theoldreader_source_online_status_changed), source);
+
+	/* actions not confirmed before the last shutdown */
+	theoldreader_source_edit_restore (source);
 	
 	return source;
 }
@@ -67,10 +97,14 @@ theoldreader_source_free (TheOldReaderSourcePtr source)
 		return;
 
 	update_job_cancel_by_owner (source);
+	g_signal_handlers_disconnect_by_data (network_monitor_get (), source);
 	
 	g_free (source->authHeaderValue);
 	g_queue_free (source->actionQueue) ;
 	g_hash_table_unref (source->lastTimestampMap);
+	g_hash_table_unref (source->lastUnreadCountMap);
+	g_hash_table_unref (source->pendingTimestampMap);
+	g_hash_table_unref (source->pendingUnreadCountMap);
 	g_free (source);
 }
 
@@ -191,22 +225,18 @@ theoldreader_source_auto_update (nodePtr node)
 	if (source->loginState == THEOLDREADER_SOURCE_STATE_IN_PROGRESS) 
 		return; /* the update will start automatically anyway */
 
+	/* send edits again that failed before */
+	if (source->loginState == THEOLDREADER_SOURCE_STATE_ACTIVE)
+		theoldreader_source_edit_retry (source);
+
 	g_get_current_time (&now);
 	
-	/* do daily updates for the feed list and feed updates according to the default interval */
-/*	if (node->subscription->updateState->lastPoll.tv_sec + THEOLDREADER_SOURCE_UPDATE_INTERVAL <= now.tv_sec) {
-		subscription_update (node->subscription, 0);
-		g_get_current_time (&source->lastQuickUpdate);
-	}
-	else if (source->lastQuickUpdate.tv_sec + THEOLDREADER_SOURCE_QUICK_UPDATE_INTERVAL <= now.tv_sec) {
-		theoldreader_source_opml_quick_update (source);
-		theoldreader_source_edit_process (source);
-		g_get_current_time (&source->lastQuickUpdate);
-	}*/
-
-	// FIXME: Don't do below, but above logic!
+	/* do daily updates for the feed list and feed updates, in between only sync what changed */
 	if (source->lastQuickUpdate.tv_sec + THEOLDREADER_SOURCE_QUICK_UPDATE_INTERVAL <= now.tv_sec) {
-		subscription_update (node->subscription, 0);
+		if (node->subscription->updateState->lastPoll.tv_sec + THEOLDREADER_SOURCE_UPDATE_INTERVAL <= now.tv_sec)
+			subscription_update (node->subscription, 0);
+		else if (!google_reader_api_sync (&source->sync))
+			theoldreader_source_opml_quick_update (source);
 		g_get_current_time (&source->lastQuickUpdate);
 	}
 }
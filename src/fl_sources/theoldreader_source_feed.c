@@ -29,7 +29,11 @@
 #include "xml.h"
 
 #include "feedlist.h"
+#include "itemlist.h"
+#include "json.h"
+#include "json_api_mapper.h"
 #include "theoldreader_source.h"
+#include "theoldreader_source_feed_list.h"
 #include "subscription.h"
 #include "node.h"
 #include "theoldreader_source_edit.h"
@@ -59,47 +63,11 @@ theoldreader_source_migrate_node (nodePtr node)
 	itemset_free (itemset);
 }
 
-static itemPtr
-theoldreader_source_load_item_from_sourceid (nodePtr node, gchar *sourceId, GHashTable *cache) 
-{
-	gpointer    ret = g_hash_table_lookup (cache, sourceId);
-	itemSetPtr  itemset;
-	int         num = g_hash_table_size (cache);
-	GList       *iter; 
-	itemPtr     item = NULL;
-
-	if (ret)
-		return item_load (GPOINTER_TO_UINT (ret));
-
-	/* skip the top 'num' entries */
-	itemset = node_get_itemset (node);
-	iter = itemset->ids;
-	while (num--) iter = g_list_next (iter);
-
-	for (; iter; iter = g_list_next (iter)) {
-		item = item_load (GPOINTER_TO_UINT (iter->data));
-		if (item && item->sourceId) {
-			/* save to cache */
-			g_hash_table_insert (cache, g_strdup(item->sourceId), (gpointer) item->id);
-			if (g_str_equal (item->sourceId, sourceId)) {
-				itemset_free (itemset);
-				return item;
-			}
-		}
-		item_unload (item);
-	}
-
-	g_warning ("Could not find item for %s!", sourceId);
-	itemset_free (itemset);
-	return NULL;
-}
-
-static void
-theoldreader_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPtr subscription, GHashTable *cache)
+static GSList *
+theoldreader_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPtr subscription, GSList *states)
 {
 	TheOldReaderSourcePtr gsource = (TheOldReaderSourcePtr) node_source_root_from_node (subscription->node)->data ;
 	xmlNodePtr      xml;
-	nodePtr         node = subscription->node;
 	xmlChar         *id = NULL;
 	gboolean        read = FALSE;
 
@@ -129,25 +97,21 @@ theoldreader_source_item_retrieve_status (const xmlNodePtr entry, subscriptionPt
 
 	if (!id) {
 		g_warning ("Skipping item without id in theoldreader_source_item_retrieve_status()!");
-		return;
+		return states;
 	}
 	
-	itemPtr item = theoldreader_source_load_item_from_sourceid (node, id, cache);
-	if (item && item->sourceId) {
-		if (g_str_equal (item->sourceId, id) && !theoldreader_source_edit_is_in_queue(gsource, id)) {
-			
-			if (item->readStatus != read)
-				item_read_state_changed (item, read);
-		}
-	}
-	if (item)
-		item_unload (item);
+	if (!theoldreader_source_edit_is_in_queue (gsource, id))
+		states = item_state_remote_prepend (states, id, read, -1);
+
 	xmlFree (id);
+
+	return states;
 }
 
 static void
 theoldreader_feed_subscription_process_update_result (subscriptionPtr subscription, const struct updateResult* const result, updateFlags flags)
 {
+	TheOldReaderSourcePtr gsource = (TheOldReaderSourcePtr) node_source_root_from_node (subscription->node)->data;
 	gchar 	*id;
 
 	debug_start_measurement (DEBUG_UPDATE);
@@ -164,6 +128,9 @@ theoldreader_feed_subscription_process_update_result (subscriptionPtr subscripti
 	metadata_list_set (&subscription->metadata, "theoldreader-feed-id", id);
 	g_free (id);
 
+	theoldreader_source_opml_quick_update_done (gsource, subscription,
+	                                            result->httpstatus == 200 && subscription->node->available);
+
 	if (!result->data)
 		return;
 
@@ -171,7 +138,7 @@ theoldreader_feed_subscription_process_update_result (subscriptionPtr subscripti
 	if (doc) {		
 		xmlNodePtr root = xmlDocGetRootElement (doc);
 		xmlNodePtr entry = root->children ; 
-		GHashTable *cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		GSList     *states = NULL;
 
 		while (entry) { 
 			if (!g_str_equal (entry->name, "entry")) {
@@ -179,11 +146,11 @@ theoldreader_feed_subscription_process_update_result (subscriptionPtr subscripti
 				continue; /* not an entry */
 			}
 			
-			theoldreader_source_item_retrieve_status (entry, subscription, cache);
+			states = theoldreader_source_item_retrieve_status (entry, subscription, states);
 			entry = entry->next;
 		}
 		
-		g_hash_table_unref (cache);
+		item_state_reconcile (subscription->node, states);
 		xmlFreeDoc (doc);
 	} else { 
 		debug0 (DEBUG_UPDATE, "theoldreader_feed_subscription_process_update_result(): Couldn't parse XML!");
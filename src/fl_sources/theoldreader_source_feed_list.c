@@ -111,6 +111,37 @@ theoldreader_source_opml_get_subnode_by_node (nodePtr node, const gchar *source)
 	return NULL;
 }
 
+static void
+theoldreader_source_opml_map_nodes_by_id (nodePtr folder, GHashTable *nodes)
+{
+	GSList	*iter;
+
+	for (iter = folder->children; iter; iter = g_slist_next (iter)) {
+		nodePtr		node = (nodePtr)iter->data;
+		const gchar	*id;
+
+		if (node->children)
+			theoldreader_source_opml_map_nodes_by_id (node, nodes);
+
+		if (!node->subscription)
+			continue;
+
+		id = metadata_list_get (node->subscription->metadata, "theoldreader-feed-id");
+		if (id)
+			g_hash_table_insert (nodes, (gpointer)id, node);
+	}
+}
+
+GHashTable *
+theoldreader_source_opml_get_nodes_by_id (TheOldReaderSourcePtr gsource)
+{
+	GHashTable *nodes = g_hash_table_new (g_str_hash, g_str_equal);
+
+	theoldreader_source_opml_map_nodes_by_id (gsource->root, nodes);
+
+	return nodes;
+}
+
 /* JSON subscription list processing implementation */
 
 static void
@@ -196,8 +227,180 @@ theoldreader_subscription_cb (subscriptionPtr subscription, const struct updateR
 		debug0 (DEBUG_UPDATE, "theoldreader_subscription_cb(): ERROR: failed to get subscription list!");
 	}
 
-	if (!(flags & THEOLDREADER_SOURCE_UPDATE_ONLY_LIST))
-		node_foreach_child_data (subscription->node, node_update_subscription, GUINT_TO_POINTER (0));
+	if (!(flags & THEOLDREADER_SOURCE_UPDATE_ONLY_LIST)) {
+		GTimeVal now;
+
+		/* Changed feeds are updated now, later syncs can continue from here */
+		g_get_current_time (&now);
+		source->sync.timestamp = now.tv_sec;
+
+		theoldreader_source_opml_quick_update (source);
+	}
+}
+
+/** functions for an efficient updating mechanism */
+
+/**
+ * Updates the given feed if its unread count or newest item timestamp
+ * differ from the ones seen last time.
+ */
+static void
+theoldreader_source_opml_quick_update_node (TheOldReaderSourcePtr gsource, nodePtr node, gint count, const gchar *newestItemTimestamp)
+{
+	const gchar	*oldNewestItemTimestamp;
+	gpointer	oldCount;
+
+	oldNewestItemTimestamp = g_hash_table_lookup (gsource->lastTimestampMap, node->subscription->source);
+	oldCount = g_hash_table_lookup (gsource->lastUnreadCountMap, node->subscription->source);
+
+	if (oldCount && GPOINTER_TO_INT (oldCount) - 1 == count &&
+	    !g_strcmp0 (oldNewestItemTimestamp, newestItemTimestamp))
+		return;
+
+	debug5 (DEBUG_UPDATE, "TheOldReaderSource: auto-updating %s "
+	        "[old count %d, count %d, old timestamp %s, timestamp %s]",
+	        node->subscription->source, GPOINTER_TO_INT (oldCount) - 1, count,
+	        oldNewestItemTimestamp, newestItemTimestamp);
+
+	/* only remembered once the update succeeded */
+	g_hash_table_insert (gsource->pendingTimestampMap,
+	                     g_strdup (node->subscription->source),
+	                     g_strdup (newestItemTimestamp));
+	g_hash_table_insert (gsource->pendingUnreadCountMap,
+	                     g_strdup (node->subscription->source),
+	                     GINT_TO_POINTER (count + 1));
+
+	subscription_update (node->subscription, 0);
+}
+
+void
+theoldreader_source_opml_quick_update_done (TheOldReaderSourcePtr gsource, subscriptionPtr subscription, gboolean success)
+{
+	gpointer count = g_hash_table_lookup (gsource->pendingUnreadCountMap, subscription->source);
+
+	if (!count)
+		return;	/* not started by a quick update */
+
+	if (success) {
+		g_hash_table_insert (gsource->lastTimestampMap,
+		                     g_strdup (subscription->source),
+		                     g_strdup (g_hash_table_lookup (gsource->pendingTimestampMap, subscription->source)));
+		g_hash_table_insert (gsource->lastUnreadCountMap,
+		                     g_strdup (subscription->source),
+		                     count);
+	}
+
+	g_hash_table_remove (gsource->pendingTimestampMap, subscription->source);
+	g_hash_table_remove (gsource->pendingUnreadCountMap, subscription->source);
+}
+
+/* Feeds without unread items might not be listed at all */
+static void
+theoldreader_source_opml_quick_update_unlisted (TheOldReaderSourcePtr gsource, nodePtr folder, GHashTable *listed)
+{
+	GSList	*iter;
+
+	for (iter = folder->children; iter; iter = g_slist_next (iter)) {
+		nodePtr node = (nodePtr)iter->data;
+
+		if (node->children)
+			theoldreader_source_opml_quick_update_unlisted (gsource, node, listed);
+
+		if (!node->subscription || g_hash_table_lookup (listed, node))
+			continue;
+
+		theoldreader_source_opml_quick_update_node (gsource, node, 0,
+		                                       g_hash_table_lookup (gsource->lastTimestampMap, node->subscription->source));
+	}
+}
+
+/* The timestamp is a string for some services and a number for others */
+static gchar *
+theoldreader_source_opml_get_timestamp (JsonNode *count)
+{
+	JsonNode *node = json_get_node (count, "newestItemTimestampUsec");
+
+	if (!node || JSON_NODE_TYPE (node) != JSON_NODE_VALUE)
+		return NULL;
+
+	if (json_node_get_value_type (node) == G_TYPE_STRING)
+		return g_strdup (json_node_get_string (node));
+
+	return g_strdup_printf ("%" G_GINT64_FORMAT, json_node_get_int (node));
+}
+
+static void
+theoldreader_source_opml_quick_update_cb (const struct updateResult* const result, gpointer userdata, updateFlags flags) 
+{
+	TheOldReaderSourcePtr	gsource = (TheOldReaderSourcePtr) userdata;
+	JsonParser	*parser;
+	JsonNode	*list = NULL;
+	GHashTable	*listed;
+	GHashTable	*nodes;
+	GList		*elements, *iter;
+
+	parser = json_parser_new ();
+	if (result->data && result->httpstatus == 200 &&
+	    json_parser_load_from_data (parser, result->data, -1, NULL))
+		list = json_get_node (json_parser_get_root (parser), "unreadcounts");
+
+	if (!list || JSON_NODE_TYPE (list) != JSON_NODE_ARRAY) {
+		debug0 (DEBUG_UPDATE, "TheOldReaderSource: Unable to get unread counts, updating all feeds.");
+		node_foreach_child_data (gsource->root, node_update_subscription, GUINT_TO_POINTER (0));
+		g_object_unref (parser);
+		return;
+	}
+
+	/* We expect something like this:
+
+	   {"max":1000,
+	    "unreadcounts":[{"id":"feed\/http:\/\/rss.slashdot.org\/Slashdot\/slashdot",
+	                     "count":12,
+	                     "newestItemTimestampUsec":"1375821312282000"},
+	                    ...
+
+	   Labels and states are listed too, but only feeds are of interest. */
+	listed = g_hash_table_new (g_direct_hash, g_direct_equal);
+	nodes = theoldreader_source_opml_get_nodes_by_id (gsource);
+	elements = iter = json_array_get_elements (json_node_get_array (list));
+	while (iter) {
+		JsonNode	*count = (JsonNode *)iter->data;
+		const gchar	*id = json_get_string (count, "id");
+		nodePtr		node = NULL;
+
+		if (id)
+			node = g_hash_table_lookup (nodes, id);
+		if (node) {
+			gchar *timestamp = theoldreader_source_opml_get_timestamp (count);
+
+			g_hash_table_insert (listed, node, node);
+			theoldreader_source_opml_quick_update_node (gsource, node, json_get_int (count, "count"), timestamp);
+			g_free (timestamp);
+		}
+		iter = g_list_next (iter);
+	}
+	g_list_free (elements);
+
+	theoldreader_source_opml_quick_update_unlisted (gsource, gsource->root, listed);
+
+	g_hash_table_destroy (listed);
+	g_hash_table_destroy (nodes);
+	g_object_unref (parser);
+}
+
+gboolean
+theoldreader_source_opml_quick_update (TheOldReaderSourcePtr gsource)
+{
+	updateRequestPtr request = update_request_new ();
+	request->updateState = update_state_copy (gsource->root->subscription->updateState);
+	request->options = update_options_copy (gsource->root->subscription->updateOptions);
+	update_request_set_source (request, THEOLDREADER_READER_UNREAD_COUNTS_URL);
+	update_request_set_auth_value (request, gsource->authHeaderValue);
+
+	update_execute_request (gsource, request, theoldreader_source_opml_quick_update_cb,
+				gsource, 0);
+
+	return TRUE;
 }
 
 static void
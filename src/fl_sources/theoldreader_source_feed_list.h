@@ -39,9 +39,31 @@ nodePtr theoldreader_source_opml_get_node_by_source(TheOldReaderSourcePtr gsourc
  */
 nodePtr theoldreader_source_opml_get_subnode_by_node(nodePtr node, const gchar *source);
 
+/**
+ * Maps all feeds by their TheOldReader feed id. The stream ids used
+ * by TheOldReader are these ids and not the feed URLs.
+ *
+ * @param gsource	the TheOldReader source
+ *
+ * @returns a hash table of nodes (to be freed with g_hash_table_destroy())
+ */
+GHashTable * theoldreader_source_opml_get_nodes_by_id (TheOldReaderSourcePtr gsource);
+
 /**
  * Perform a quick update of the TheOldReader source.
  *
  * @param gsource	the TheOldReader source
  */
 gboolean theoldreader_source_opml_quick_update (TheOldReaderSourcePtr gsource);
+
+/**
+ * Remembers the unread count and newest item timestamp a quick update
+ * of the given feed was started for, if the feed update succeeded.
+ * Otherwise the next quick update updates the feed again. Call this
+ * when processing the result of a feed update.
+ *
+ * @param gsource	the TheOldReader source
+ * @param subscription	the updated feed
+ * @param success	TRUE if the update succeeded
+ */
+void theoldreader_source_opml_quick_update_done (TheOldReaderSourcePtr gsource, subscriptionPtr subscription, gboolean success);
@@ -52,21 +52,35 @@ ttrss_source_new (nodePtr node)
 	source->categories = g_hash_table_new (g_direct_hash, g_direct_equal);
 	source->categoryToNode = g_hash_table_new (g_direct_hash, g_direct_equal);
 	source->nodeToCategory = g_hash_table_new (g_direct_hash, g_direct_equal);
+	source->sinceIds = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	source->pendingRead = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	source->pendingFlag = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	
 	return source;
 }
 
+static gboolean ttrss_source_send_updates (gpointer user_data);
+
 static void
 ttrss_source_free (ttrssSourcePtr source) 
 {
 	if (!source)
 		return;
 
+	/* do not lose item state changes still waiting for the timer */
+	if (source->updateTimer) {
+		g_source_remove (source->updateTimer);
+		ttrss_source_send_updates (source);
+	}
+
 	update_job_cancel_by_owner (source);
 
 	g_hash_table_destroy (source->categories);
 	g_hash_table_destroy (source->categoryToNode);
 	g_hash_table_destroy (source->nodeToCategory);
+	g_hash_table_destroy (source->sinceIds);
+	g_hash_table_destroy (source->pendingRead);
+	g_hash_table_destroy (source->pendingFlag);
 	g_free (source->session_id);
 	g_free (source);
 }
@@ -184,6 +198,17 @@ ttrss_source_login (ttrssSourcePtr source, guint32 flags)
 
 /* node source type implementation */
 
+static void
+ttrss_source_reset_since_ids (ttrssSourcePtr source)
+{
+	GTimeVal	now;
+
+	g_get_current_time (&now);
+	source->lastFullUpdate = now.tv_sec;
+
+	g_hash_table_remove_all (source->sinceIds);
+}
+
 static void
 ttrss_source_update (nodePtr node)
 {
@@ -197,6 +222,10 @@ ttrss_source_update (nodePtr node)
 	if (source->loginState == TTRSS_SOURCE_STATE_NO_AUTH)
 		source->loginState = TTRSS_SOURCE_STATE_NONE;
 
+	/* Headlines since the newest known article contain no state
+	   changes of older items, so a manual update fetches all */
+	ttrss_source_reset_since_ids (source);
+
 	subscription_update (node->subscription, 0);
 }
 
@@ -204,6 +233,7 @@ static void
 ttrss_source_auto_update (nodePtr node)
 {
 	ttrssSourcePtr	source = (ttrssSourcePtr) node->data;
+	GTimeVal	now;
 
 	if (source->loginState == TTRSS_SOURCE_STATE_NONE) {
 		ttrss_source_update (node);
@@ -213,6 +243,11 @@ ttrss_source_auto_update (nodePtr node)
 	if (source->loginState == TTRSS_SOURCE_STATE_IN_PROGRESS) 
 		return; /* the update will start automatically anyway */
 
+	/* Same as for manual updates, but only once in a while */
+	g_get_current_time (&now);
+	if (now.tv_sec - source->lastFullUpdate >= TTRSS_SOURCE_FULL_UPDATE_INTERVAL)
+		ttrss_source_reset_since_ids (source);
+
 	debug0 (DEBUG_UPDATE, "ttrss_source_auto_update()");
 	subscription_auto_update (node->subscription);
 }
@@ -419,21 +454,92 @@ ttrss_source_remote_update_cb (const struct updateResult * const result, gpointe
 	debug2 (DEBUG_UPDATE, "TinyTinyRSS update result processing... status:%d >>>%s<<<", result->httpstatus, result->data);
 }
 
-/* FIXME: Only simple synchronous item change requests... Get async! */
+/* Item state changes are collected for TTRSS_SOURCE_UPDATE_DELAY
+   seconds and then sent with one request per field and mode. */
+
+static void
+ttrss_source_update_articles (ttrssSourcePtr source, GHashTable *pending, const gchar *format)
+{
+	GString		*ids[2];
+	GHashTableIter	iter;
+	gpointer	key, value;
+	gint		mode;
+
+	ids[0] = g_string_new (NULL);
+	ids[1] = g_string_new (NULL);
+
+	g_hash_table_iter_init (&iter, pending);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		GString *list = ids[GPOINTER_TO_INT (value) - 1];
+
+		if (list->len)
+			g_string_append_c (list, ',');
+		g_string_append (list, (gchar *)key);
+	}
+	g_hash_table_remove_all (pending);
+
+	for (mode = 0; mode < 2; mode++) {
+		if (ids[mode]->len) {
+			updateRequestPtr	request = update_request_new ();
+			gchar			*source_uri = g_strdup_printf (TTRSS_URL, source->url);
+
+			request->options = update_options_copy (source->root->subscription->updateOptions);
+			request->postdata = g_strdup_printf (format, source->session_id, ids[mode]->str, mode);
+			update_request_set_source (request, source_uri);
+			g_free (source_uri);
+
+			/* Not owned by the source, so changes sent when freeing it are not cancelled */
+			update_execute_request (NULL, request, ttrss_source_remote_update_cb, NULL, 0 /* flags */);
+		}
+		g_string_free (ids[mode], TRUE);
+	}
+}
+
+static gboolean
+ttrss_source_send_updates (gpointer user_data)
+{
+	ttrssSourcePtr	source = (ttrssSourcePtr)user_data;
+
+	source->updateTimer = 0;
+
+	/* Without a session or root subscription (e.g. when freed
+	   before the first login) there is no way to send anything */
+	if (!source->session_id || !source->root || !source->root->subscription) {
+		debug2 (DEBUG_UPDATE, "TinyTinyRSS dropping %u read and %u flag state changes",
+		        g_hash_table_size (source->pendingRead), g_hash_table_size (source->pendingFlag));
+		g_hash_table_remove_all (source->pendingRead);
+		g_hash_table_remove_all (source->pendingFlag);
+		return FALSE;
+	}
+
+	debug2 (DEBUG_UPDATE, "TinyTinyRSS sending %u read and %u flag state changes",
+	        g_hash_table_size (source->pendingRead), g_hash_table_size (source->pendingFlag));
+
+	ttrss_source_update_articles (source, source->pendingRead, TTRSS_JSON_UPDATE_ITEM_UNREAD);
+	ttrss_source_update_articles (source, source->pendingFlag, TTRSS_JSON_UPDATE_ITEM_FLAG);
+
+	return FALSE;
+}
+
+/* Only the latest change per item is kept, so toggling an item twice sends one change */
+static void
+ttrss_source_queue_update (ttrssSourcePtr source, GHashTable *pending, const gchar *id, gint mode)
+{
+	if (!id)
+		return;
+
+	g_hash_table_insert (pending, g_strdup (id), GINT_TO_POINTER (mode + 1));
+
+	if (!source->updateTimer)
+		source->updateTimer = g_timeout_add_seconds (TTRSS_SOURCE_UPDATE_DELAY, ttrss_source_send_updates, source);
+}
 
 static void 
 ttrss_source_item_set_flag (nodePtr node, itemPtr item, gboolean newStatus)
 {
-	nodePtr			root = node_source_root_from_node (node);
-	ttrssSourcePtr		source = (ttrssSourcePtr)root->data;
-	updateRequestPtr	request;
+	ttrssSourcePtr	source = (ttrssSourcePtr)node_source_root_from_node (node)->data;
 
-	request = update_request_new ();
-	request->options = update_options_copy (root->subscription->updateOptions);
-	request->postdata = g_strdup_printf (TTRSS_JSON_UPDATE_ITEM_FLAG, source->session_id, item_get_id(item), newStatus?1:0 );
-
-	update_request_set_source (request, g_strdup_printf (TTRSS_URL, source->url));
-	update_execute_request (source, request, ttrss_source_remote_update_cb, source, 0 /* flags */);
+	ttrss_source_queue_update (source, source->pendingFlag, item_get_id (item), newStatus?1:0);
 
 	item_flag_state_changed (item, newStatus);
 }
@@ -441,18 +547,45 @@ ttrss_source_item_set_flag (nodePtr node, itemPtr item, gboolean newStatus)
 static void
 ttrss_source_item_mark_read (nodePtr node, itemPtr item, gboolean newStatus)
 {
-	nodePtr			root = node_source_root_from_node (node);
-	ttrssSourcePtr		source = (ttrssSourcePtr)root->data;
+	ttrssSourcePtr	source = (ttrssSourcePtr)node_source_root_from_node (node)->data;
+
+	ttrss_source_queue_update (source, source->pendingRead, item_get_id (item), newStatus?0:1);
+
+	item_read_state_changed (item, newStatus);
+}
+
+static void
+ttrss_source_item_mark_all_read (nodePtr node)
+{
+	ttrssSourcePtr		source = (ttrssSourcePtr)node_source_root_from_node (node)->data;
 	updateRequestPtr	request;
+	const gchar		*feed_id;
+	gchar			*source_uri;
+
+	if (!node->subscription)
+		return;
+
+	feed_id = metadata_list_get (node->subscription->metadata, "ttrss-feed-id");
+	if (!feed_id)
+		return;
+
+	/* Send queued single item changes first, so a pending
+	   "unread" cannot undo the catchup */
+	if (source->updateTimer) {
+		g_source_remove (source->updateTimer);
+		ttrss_source_send_updates (source);
+	}
 
 	request = update_request_new ();
-	request->options = update_options_copy (root->subscription->updateOptions);
-	request->postdata = g_strdup_printf (TTRSS_JSON_UPDATE_ITEM_UNREAD, source->session_id, item_get_id(item), newStatus?0:1 );
+	source_uri = g_strdup_printf (TTRSS_URL, source->url);
+	request->options = update_options_copy (source->root->subscription->updateOptions);
+	request->postdata = g_strdup_printf (TTRSS_JSON_CATCHUP_FEED, source->session_id, feed_id);
+	update_request_set_source (request, source_uri);
+	g_free (source_uri);
 
-	update_request_set_source (request, g_strdup_printf (TTRSS_URL, source->url));
-	update_execute_request (source, request, ttrss_source_remote_update_cb, source, 0 /* flags */);
+	debug1 (DEBUG_UPDATE, "TinyTinyRSS marking feed %s read", feed_id);
 
-	item_read_state_changed (item, newStatus);
+	update_execute_request (NULL, request, ttrss_source_remote_update_cb, NULL, 0 /* flags */);
 }
 
 /* node source type definition */
@@ -481,7 +614,8 @@ static struct nodeSourceType nst = {
 	.add_folder          = NULL,	/* not supported by current tt-rss JSON API (v1.5) */
 	.add_subscription    = ttrss_source_add_subscription,
 	.remove_node         = ttrss_source_remove_node,
-	.convert_to_local    = NULL	/* FIXME: implement me to allow data migration from tt-rss! */
+	.convert_to_local    = NULL,	/* FIXME: implement me to allow data migration from tt-rss! */
+	.item_mark_all_read  = ttrss_source_item_mark_all_read
 };
 
 nodeSourceTypePtr
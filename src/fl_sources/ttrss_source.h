@@ -38,6 +38,11 @@ typedef struct ttrssSource {
 	GHashTable	*categories;	/**< Lookup hash for feed id to category id */
 	GHashTable	*categoryToNode;	/**< Lookup hash for category id to folder node id */
 	GHashTable	*nodeToCategory;	/**< Lookup hash for category id to folder node id */
+	GHashTable	*sinceIds;	/**< Lookup hash for feed id to newest known article id */
+	gint64		lastFullUpdate;	/**< Time (in seconds) the since ids were last reset */
+	GHashTable	*pendingRead;	/**< Lookup hash for article id to pending read mode (+1) */
+	GHashTable	*pendingFlag;	/**< Lookup hash for article id to pending flag mode (+1) */
+	guint		updateTimer;	/**< Timer for sending pending item state changes (or 0) */
 } *ttrssSourcePtr;
  
 enum { 
@@ -129,11 +134,25 @@ enum  {
  */
 #define TTRSS_JSON_HEADLINES "{\"op\":\"getHeadlines\", \"sid\":\"%s\", \"feed_id\":\"%s\", \"limit\":\"%d\", \"show_content\":\"true\", \"view_mode\":\"all_articles\"}"
 
+/**
+ * Fetch only TinyTinyRSS headlines newer than the given article. As
+ * article ids are increasing these are the items not known yet, so
+ * the content is only transferred for them.
+ *
+ * @param sid		session id
+ * @param feed_id	tt-rss feed id
+ * @param limit		feed cache size
+ * @param since_id	newest known tt-rss item id
+ *
+ * @returns JSON feed list
+ */
+#define TTRSS_JSON_HEADLINES_SINCE "{\"op\":\"getHeadlines\", \"sid\":\"%s\", \"feed_id\":\"%s\", \"limit\":\"%d\", \"since_id\":\"%s\", \"show_content\":\"true\", \"view_mode\":\"all_articles\"}"
+
 /**
  * Toggle item flag state.
  *
  * @param sid		session id
- * @param item_id	tt-rss item id
+ * @param article_ids	comma separated list of tt-rss item ids
  * @param mode		0 = unflagged, 1 = flagged
  */
 #define TTRSS_JSON_UPDATE_ITEM_FLAG "{\"op\":\"updateArticle\", \"sid\":\"%s\", \"article_ids\":\"%s\", \"mode\":\"%d\", \"field\":\"0\"}"
@@ -142,11 +161,31 @@ enum  {
  * Toggle item read state.
  *
  * @param sid		session id
- * @param item_id	tt-rss item id
+ * @param article_ids	comma separated list of tt-rss item ids
  * @param mode		0 = read, 1 = unread
  */
 #define TTRSS_JSON_UPDATE_ITEM_UNREAD "{\"op\":\"updateArticle\", \"sid\":\"%s\", \"article_ids\":\"%s\", \"mode\":\"%d\", \"field\":\"2\"}"
 
+/**
+ * Mark all items of a feed as read.
+ *
+ * @param sid		session id
+ * @param feed_id	tt-rss feed id
+ */
+#define TTRSS_JSON_CATCHUP_FEED "{\"op\":\"catchupFeed\", \"sid\":\"%s\", \"feed_id\":\"%s\", \"is_cat\":\"false\"}"
+
+/**
+ * Number of seconds item state changes are collected before
+ * they are sent with one request per state.
+ */
+#define TTRSS_SOURCE_UPDATE_DELAY	2
+
+/**
+ * Interval (in seconds) after which auto updates fetch all headlines
+ * again, so that remote state changes of older items are synced.
+ */
+#define TTRSS_SOURCE_FULL_UPDATE_INTERVAL	(60 * 60)
+
 /**
  * Returns ttss source type implementation info.
  */
@@ -25,6 +25,7 @@
 #include "db.h"
 #include "debug.h"
 #include "feedlist.h"
+#include "item_state.h"
 #include "itemlist.h"
 #include "itemset.h"
 #include "json.h"
@@ -37,6 +38,8 @@
 static void
 ttrss_feed_subscription_process_update_result (subscriptionPtr subscription, const struct updateResult* const result, updateFlags flags)
 {
+	ttrssSourcePtr	source = (ttrssSourcePtr) node_source_root_from_node (subscription->node)->data;
+
 	if (result->data && result->httpstatus == 200) {
 		JsonParser	*parser = json_parser_new ();
 
@@ -45,6 +48,9 @@ ttrss_feed_subscription_process_update_result (subscriptionPtr subscription, con
 			GList		*elements = json_array_get_elements (array);
 			GList		*iter = elements;
 			GList		*items = NULL;
+			GSList		*states = NULL;
+			gint64		maxId = 0;
+			const gchar	*feed_id;
 
 			/*
 			   We expect to get something like this
@@ -73,6 +79,7 @@ ttrss_feed_subscription_process_update_result (subscriptionPtr subscription, con
 				const gchar *content; 
 				gchar *xhtml;
 
+				maxId = MAX (maxId, json_get_int (node, "id"));
 				id = g_strdup_printf ("%" G_GINT64_FORMAT, json_get_int (node, "id"));
 				item_set_id (item, id);
 				g_free (id);
@@ -94,15 +101,21 @@ ttrss_feed_subscription_process_update_result (subscriptionPtr subscription, con
 				}
 				if (json_get_bool (node, "marked"))
 					item->flagStatus = TRUE;
+
+				/* local changes not yet sent win over the remote state */
+				if (!g_hash_table_lookup (source->pendingRead, item_get_id (item)) &&
+				    !g_hash_table_lookup (source->pendingFlag, item_get_id (item)))
+					states = item_state_remote_prepend (states, item_get_id (item), item->readStatus, item->flagStatus);
 					
-				items = g_list_append (items, (gpointer)item);
+				items = g_list_prepend (items, (gpointer)item);
 				
 				iter = g_list_next (iter);
 			}
 
 			g_list_free (elements);
+			items = g_list_reverse (items);
 
-			/* merge against feed cache */
+			/* merge against feed cache, with no new headlines there is nothing to do */
 			if (items) {
 				itemSetPtr itemSet = node_get_itemset (subscription->node);
 				gint newCount = itemset_merge_items (itemSet, items, TRUE /* feed valid */, FALSE /* markAsRead */);
@@ -112,6 +125,14 @@ ttrss_feed_subscription_process_update_result (subscriptionPtr subscription, con
 				feedlist_node_was_updated (subscription->node, newCount);
 			}
 
+			/* merging only adds new items, this applies remote state changes to known ones */
+			item_state_reconcile (subscription->node, states);
+
+			/* next time only ask for headlines newer than the ones seen */
+			feed_id = metadata_list_get (subscription->metadata, "ttrss-feed-id");
+			if (feed_id && maxId > common_parse_long (g_hash_table_lookup (source->sinceIds, feed_id), 0))
+				g_hash_table_insert (source->sinceIds, g_strdup (feed_id), g_strdup_printf ("%" G_GINT64_FORMAT, maxId));
+
 			subscription->node->available = TRUE;
 		} else {
 			subscription->node->available = FALSE;
@@ -131,7 +152,7 @@ ttrss_feed_subscription_prepare_update_request (subscriptionPtr subscription,
 {
 	nodePtr		root = node_source_root_from_node (subscription->node);
 	ttrssSourcePtr	source = (ttrssSourcePtr) root->data;
-	const gchar	*feed_id;
+	const gchar	*feed_id, *since_id;
 	gchar		*source_name;
 	gint		fetchCount;
 
@@ -154,7 +175,12 @@ ttrss_feed_subscription_prepare_update_request (subscriptionPtr subscription,
 	/* We can always max out as TinyTinyRSS does limit results itself */	
 	fetchCount = feed_get_max_item_count (subscription->node);
 
-	request->postdata = g_strdup_printf (TTRSS_JSON_HEADLINES, source->session_id, feed_id, fetchCount);
+	/* After the first full fetch only new headlines are requested */
+	since_id = g_hash_table_lookup (source->sinceIds, feed_id);
+	if (since_id)
+		request->postdata = g_strdup_printf (TTRSS_JSON_HEADLINES_SINCE, source->session_id, feed_id, fetchCount, since_id);
+	else
+		request->postdata = g_strdup_printf (TTRSS_JSON_HEADLINES, source->session_id, feed_id, fetchCount);
 	source_name = g_strdup_printf (TTRSS_URL, source->url);
 	update_request_set_source (request, source_name);
 	g_free (source_name);
@@ -21,6 +21,8 @@
 #include "folder.h"
 
 #include "common.h"
+#include "conf.h"
+#include "db.h"
 #include "debug.h"
 #include "feedlist.h"
 #include "itemset.h"
@@ -37,31 +39,18 @@
    
    The folder node type does not implement the hierarchy of the feed list! */
 
-static void
-folder_merge_child_items (nodePtr node, gpointer user_data)
-{
-	itemSetPtr	folderItemSet = (itemSetPtr)user_data;
-	itemSetPtr	nodeItemSet;
-
-	if (IS_VFOLDER (node))
-		return;
-
-	nodeItemSet = node_get_itemset (node);
-	folderItemSet->ids = g_list_concat (folderItemSet->ids, nodeItemSet->ids);
-	nodeItemSet->ids = NULL;
-	itemset_free (nodeItemSet);
-}
-
 static itemSetPtr
 folder_load (nodePtr node)
 {
-	itemSetPtr	itemSet;
-	
-	itemSet = g_new0 (struct itemSet, 1);
-	itemSet->nodeId = node->id;
+	gboolean	hideRead;
+	gint		limit;
+
+	/* Instead of merging the item sets of all childs the DB
+	   selects the newest (unread) items of all descendants */
+	conf_get_bool_value (FOLDER_DISPLAY_HIDE_READ, &hideRead);
+	conf_get_int_value (FOLDER_DISPLAY_LIMIT, &limit);
 
-	node_foreach_child_data (node, folder_merge_child_items, itemSet);
-	return itemSet;
+	return db_folder_load (node->id, hideRead, MAX (limit, 0));
 }
 
 static void
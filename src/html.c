@@ -19,7 +19,6 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -28,148 +27,273 @@
 #include "html.h"
 #include "xml.h"
 
-enum {
-	LINK_FAVICON,
-	LINK_RSS_ALTERNATE,
-};
+/* Single pass tokenizer for the <head> section of a HTML document.
+   It never modifies the input and only copies attribute values of
+   <link> tags that turn out to be feed or favicon links. */
 
-static gchar *
-checkLinkRef (const gchar* str, gint linkType)
+static gboolean
+html_is_space (gchar c)
+{
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f');
+}
+
+/* Case insensitive check if the len bytes at str equal the given word */
+static gboolean
+html_word_is (const gchar *str, gsize len, const gchar *word)
+{
+	return (len == strlen (word)) && (0 == g_ascii_strncasecmp (str, word, len));
+}
+
+/* Checks if the whitespace separated token list (e.g. a rel value) contains token */
+static gboolean
+html_token_list_contains (const gchar *list, gsize len, const gchar *token)
+{
+	const gchar *end = list + len;
+
+	while (list < end) {
+		const gchar *start;
+
+		while (list < end && html_is_space (*list))
+			list++;
+		start = list;
+		while (list < end && !html_is_space (*list))
+			list++;
+		if (list > start && html_word_is (start, list - start, token))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Case insensitive substring check on a non-terminated string */
+static gboolean
+html_value_contains (const gchar *value, gsize len, const gchar *needle)
 {
-	gchar		*res;
-	const gchar	*tmp, *tmp2;
-	size_t		len = 0;
-	gchar		quote; 
-	
-	/*debug1(DEBUG_PARSING, "checking link %s", str); */
-	tmp = common_strcasestr (str, "href=");
-	if (!tmp)
-		return NULL;
-	tmp += 5;
-	
-	/* skip spaces up to the first quote. This is really slightly
-	 wrong.  SGML allows unquoted atributes, but not if they contain
-	 slashes, so 99% of all URIs will require quotes. */
-	while (*tmp != '\"' && *tmp != '\'') {
-		if (*tmp == '>' || *tmp == '\0' || !isspace(*tmp))
-			return NULL;
-		tmp++;
+	gsize	needleLen = strlen (needle);
+	gsize	i;
+
+	for (i = 0; i + needleLen <= len; i++) {
+		if (0 == g_ascii_strncasecmp (value + i, needle, needleLen))
+			return TRUE;
 	}
-	quote = *tmp; /* The type of quote mark used to delimit the arg */
-	tmp++;
-	tmp2 = tmp;
-	while ((*tmp2 != quote && *(tmp2-1) != '\\') && /* Escaped quote*/
-		  *tmp2 != '\0')
-		tmp2++, len++;
-
-	res = g_strndup (tmp, len);
-
-	if (linkType == LINK_FAVICON) {
-		/* The type attribute is optional, so don't check for it,
-		 * as according to the W3C, it must be must be png, gif or
-		 * ico anyway: http://www.w3.org/2005/10/howto-favicon
-		 * Instead, do stronger checks for the rel attribute. */
-		if (((NULL != common_strcasestr (str, "rel=\"shortcut icon\"")) ||
-		     (NULL != common_strcasestr (str, "rel=\"icon\"")) ||
-		     (NULL != common_strcasestr (str, "rel=\'shortcut icon\'")) ||
-		     (NULL != common_strcasestr (str, "rel=\'icon\'"))) /*&&
-		    ((NULL != common_strcasestr (str, "image/x-icon")) ||
-		     (NULL != common_strcasestr (str, "image/png")) ||
-		     (NULL != common_strcasestr (str, "image/gif")))*/)
-			return res;
-	} else if (linkType == LINK_RSS_ALTERNATE) {
-		if ((common_strcasestr (str, "alternate") != NULL) &&
-		    ((common_strcasestr (str, "text/xml") != NULL) || 
-		     (common_strcasestr (str, "rss+xml") != NULL) ||
-		     (common_strcasestr (str, "rdf+xml") != NULL) ||
-		     (common_strcasestr (str, "atom+xml") != NULL)))
-			return res;
+
+	return FALSE;
+}
+
+typedef struct {
+	const gchar	*rel, *type, *href;
+	gsize		relLen, typeLen, hrefLen;
+} linkAttributes;
+
+/* Parses the attributes of a tag up to the closing '>' and returns a
+   pointer to it (or NULL if the tag is not terminated). */
+static const gchar *
+html_parse_link_attributes (const gchar *p, linkAttributes *attrs)
+{
+	while (*p) {
+		const gchar	*name, *value = NULL;
+		gsize		nameLen, valueLen = 0;
+
+		while (html_is_space (*p) || *p == '/')
+			p++;
+		if (*p == '>')
+			return p;
+		if (!*p)
+			break;
+
+		name = p;
+		while (*p && !html_is_space (*p) && *p != '=' && *p != '>' && *p != '/')
+			p++;
+		nameLen = p - name;
+
+		while (html_is_space (*p))
+			p++;
+		if (*p == '=') {
+			p++;
+			while (html_is_space (*p))
+				p++;
+			if (*p == '"' || *p == '\'') {
+				const gchar *close = strchr (p + 1, *p);
+				if (!close)
+					return NULL;
+				value = p + 1;
+				valueLen = close - value;
+				p = close + 1;
+			} else {
+				value = p;
+				while (*p && !html_is_space (*p) && *p != '>')
+					p++;
+				valueLen = p - value;
+			}
+		}
+
+		if (!value || !nameLen)
+			continue;
+
+		if (html_word_is (name, nameLen, "rel")) {
+			attrs->rel = value;
+			attrs->relLen = valueLen;
+		} else if (html_word_is (name, nameLen, "type")) {
+			attrs->type = value;
+			attrs->typeLen = valueLen;
+		} else if (html_word_is (name, nameLen, "href")) {
+			attrs->href = value;
+			attrs->hrefLen = valueLen;
+		}
 	}
-	g_free (res);
+
 	return NULL;
 }
 
 static gchar *
-search_links (const gchar* data, gint linkType)
+html_link_to_url (const linkAttributes *attrs, const gchar *baseUri)
 {
-	gchar	*ptr;
-	const gchar	*tmp = data;
-	gchar	*result = NULL;
-	gchar	*res;
-	gchar	*tstr;
-	gchar	*endptr;
-	
-	while (1) {
-		ptr = common_strcasestr (tmp, "<link ");
-		if (!ptr)
-			return NULL;
-		
-		endptr = strchr (ptr, '>');
-		if (!endptr)
-			return NULL;
-		*endptr = '\0';
-		tstr = g_strdup (ptr);
-		*endptr = '>';
-		res = checkLinkRef (tstr, linkType);
-		g_free (tstr);
-		if (res) {
-			result = res;
+	gchar	*tmp, *url;
+
+	/* URIs can contain escaped things.... All ampersands must be escaped, for example */
+	tmp = unhtmlize (g_strndup (attrs->href, attrs->hrefLen));
+	url = (gchar *)common_build_url (tmp, baseUri);
+	g_free (tmp);
+
+	return url;
+}
+
+/* Case insensitive search for an end tag like "</script" */
+static const gchar *
+html_find_end_tag (const gchar *p, const gchar *endTag)
+{
+	gsize len = strlen (endTag);
+
+	while (NULL != (p = strchr (p, '<'))) {
+		if (0 == g_ascii_strncasecmp (p, endTag, len))
+			return p;
+		p++;
+	}
+
+	return NULL;
+}
+
+void
+html_discover_links (const gchar *data, const gchar *baseUri, GSList **feeds, GSList **favicons)
+{
+	const gchar *p = data;
+
+	if (!data)
+		return;
+
+	while (NULL != (p = strchr (p, '<'))) {
+		const gchar	*name;
+		gsize		nameLen;
+		gboolean	closing = FALSE;
+
+		p++;
+
+		/* comments might contain outdated links */
+		if (0 == strncmp (p, "!--", 3)) {
+			p = strstr (p + 3, "-->");
+			if (!p)
+				break;
+			continue;
+		}
+
+		if (*p == '/') {
+			closing = TRUE;
+			p++;
+		}
+
+		name = p;
+		while (g_ascii_isalnum (*p))
+			p++;
+		nameLen = p - name;
+
+		/* All links we are interested in are in the <head> */
+		if (closing && html_word_is (name, nameLen, "head"))
+			break;
+		if (!closing && html_word_is (name, nameLen, "body"))
 			break;
-/*		deactivated as long as we support only subscribing 
-		to the first found link (BTW this code crashes on
-		sites like Groklaw!)
-		
-			gchar* t;
-			if(result == NULL)
-				result = res;
-			else {
-				t = g_strdup_printf("%s\n%s", result, res);
-				g_free(res);
-				g_free(result);
-				result = t;
-			}*/
+
+		if (!closing && html_word_is (name, nameLen, "script")) {
+			p = html_find_end_tag (p, "</script");
+			if (!p)
+				break;
+			continue;
+		}
+
+		if (!closing && html_word_is (name, nameLen, "link") && html_is_space (*p)) {
+			linkAttributes attrs = { NULL, NULL, NULL, 0, 0, 0 };
+
+			p = html_parse_link_attributes (p, &attrs);
+			if (!p)
+				break;
+
+			if (!attrs.href || !attrs.rel)
+				continue;
+
+			/* The type attribute is optional for favicons, so don't check
+			   for it, as according to the W3C, it must be png, gif or ico
+			   anyway: http://www.w3.org/2005/10/howto-favicon */
+			if (favicons && html_token_list_contains (attrs.rel, attrs.relLen, "icon"))
+				*favicons = g_slist_append (*favicons, html_link_to_url (&attrs, baseUri));
+
+			if (feeds && attrs.type &&
+			    html_token_list_contains (attrs.rel, attrs.relLen, "alternate") &&
+			    (html_value_contains (attrs.type, attrs.typeLen, "text/xml") ||
+			     html_value_contains (attrs.type, attrs.typeLen, "rss+xml") ||
+			     html_value_contains (attrs.type, attrs.typeLen, "rdf+xml") ||
+			     html_value_contains (attrs.type, attrs.typeLen, "atom+xml")))
+				*feeds = g_slist_append (*feeds, html_link_to_url (&attrs, baseUri));
 		}
-		tmp = endptr;
 	}
-	
-	result = unhtmlize (result); /* URIs can contain escaped things.... All ampersands must be escaped, for example */
+}
+
+/* Returns the first link of the list and frees all others */
+static gchar *
+html_first_link (GSList *links)
+{
+	gchar	*result = NULL;
+
+	if (links) {
+		result = (gchar *)links->data;
+		links->data = NULL;
+	}
+	g_slist_free_full (links, g_free);
+
 	return result;
 }
 
+GSList *
+html_auto_discover_feeds (const gchar *data, const gchar *baseUri)
+{
+	GSList	*feeds = NULL;
+
+	debug0 (DEBUG_UPDATE, "searching through link tags");
+	html_discover_links (data, baseUri, &feeds, NULL);
+	debug1 (DEBUG_UPDATE, "found %d feed links", g_slist_length (feeds));
+
+	return feeds;
+}
+
 gchar *
 html_auto_discover_feed (const gchar* data, const gchar *baseUri)
 {
-	gchar	*res, *tmp;
+	gchar	*res;
 
-	debug0 (DEBUG_UPDATE, "searching through link tags");
-	res = search_links (data, LINK_RSS_ALTERNATE);
+	res = html_first_link (html_auto_discover_feeds (data, baseUri));
 	debug1 (DEBUG_UPDATE, "search result: %s", res?res:"none found");
 
-	if (res) {
-		/* turn relative URIs into absolute URIs */
-		tmp = res;
-		res = common_build_url (res, baseUri);
-		g_free (tmp);
-	}
-
 	return res;
 }
 
 gchar *
 html_discover_favicon (const gchar * data, const gchar * baseUri)
 {
-	gchar	*res, *tmp;
+	GSList	*favicons = NULL;
+	gchar	*res;
 
 	debug0 (DEBUG_UPDATE, "searching through link tags");
-	res = search_links (data, LINK_FAVICON);
+	html_discover_links (data, baseUri, NULL, &favicons);
+	res = html_first_link (favicons);
 	debug1 (DEBUG_UPDATE, "search result: %s", res? res : "none found");
 
-	if (res) {
-		/* turn relative URIs into absolute URIs */
-		tmp = res;
-		res = common_build_url (res, baseUri);
-		g_free (tmp);
-	}
-	
 	return res;
 }
@@ -23,6 +23,28 @@
 
 #include <glib.h>
 
+/**
+ * Scans the head section of a HTML document once and collects
+ * all feed and favicon links. Relative links are resolved
+ * against baseUri. The input is not modified.
+ *
+ * @param data		HTML source
+ * @param baseUri	URI that relative links will be based off of
+ * @param feeds		list to append feed URLs to (or NULL)
+ * @param favicons	list to append favicon URLs to (or NULL)
+ */
+void html_discover_links (const gchar *data, const gchar *baseUri, GSList **feeds, GSList **favicons);
+
+/**
+ * HTML feed auto discovery function. Returns all
+ * feed links found in the passed HTML document.
+ *
+ * @param data		HTML source
+ * @param baseUri	URI that relative links will be based off of
+ * @returns	list of feed URLs in document order. Must be freed by caller.
+ */
+GSList * html_auto_discover_feeds (const gchar *data, const gchar *baseUri);
+
 /**
  * HTML feed auto discovery function. Searches the
  * passed HTML document for feed links and returns
@@ -22,33 +22,200 @@
 #include <libxml/uri.h>
 
 #include "common.h"
+#include "db.h"
 #include "debug.h"
 #include "feed.h"
 #include "folder.h"
 #include "htmlview.h"
 #include "item.h"
+#include "item_render.h"
 #include "itemlist.h"
+#include "metadata.h"
 #include "render.h"
 #include "vfolder.h"
+#include "ui/itemview.h"
 #include "ui/liferea_htmlview.h"
 
 // FIXME: namespace clash of LifereaHtmlView *htmlview and htmlView_priv 
 // clearly shows the need to merge htmlview.c and src/ui/ui_htmlview.c,
 // maybe with a separate a HTML cache object...
 
+/* size limit of the persistent cache of rendered items (see db_html_cache_store()) */
+#define HTML_CACHE_MAX_SIZE	(32 * 1024 * 1024)
+
+/* The combined view only puts a window of the items into the document.
+   It starts with the first page and the document scripts request the
+   next or previous page using liferea-more-items:// links when scrolling
+   close to the window borders. Items far away are removed again, at the
+   top they are replaced by a spacer of the same height. */
+#define HTMLVIEW_PAGE_SIZE	25	/**< number of items added at once */
+#define HTMLVIEW_MAX_PAGES	4	/**< maximum number of pages in the document */
+
+/* Once written, a document is only reloaded when the view mode or the
+   displayed node changes. All other changes (new, removed and updated
+   items) are applied by running the patch scripts in the document. */
+
 static struct htmlView_priv 
 {
 	GHashTable	*chunkHash;	/**< cache of HTML chunks of all displayed items */
 	GSList		*orderedChunks;	/**< ordered list of chunks */
 	nodePtr		node;		/**< the node whose items are displayed */
 	guint		missingContent;	/**< counter for items without content */
+	gboolean	paging;		/**< TRUE if the document shows a window of the items */
+	gboolean	summaryMode;	/**< summary mode of the combined view */
+	gboolean	patchable;	/**< TRUE if the document can be updated by the patch scripts */
+	guint		documentMode;	/**< view mode of the document */
+	GSList		*removedIds;	/**< ids of removed items still in the document */
+	gulong		displayedId;	/**< id of the item in the single item document */
+	gchar		*displayedHtml;	/**< HTML of the item in the single item document */
+
+	guint		prefetchSource;	/**< idle source of the pending prefetch (or 0) */
+	gulong		readyId;	/**< id of the prefetched item (or 0) */
+	gchar		*readyKey;	/**< validation key of the prefetched rendering */
+	gchar		*readyHtml;	/**< prefetched single item rendering */
+	gint64		readyUsecs;	/**< time needed for the prefetched rendering */
+	guint		prefetchHits;	/**< number of prefetched renderings used */
+	guint		prefetchMisses;	/**< number of prefetched renderings not used */
+	gint64		prefetchSaved;	/**< total rendering time saved by prefetching */
 } htmlView_priv;
 
+/* Patch scripts, items are the <body> elements with an "item-<id>" id */
+static const gchar *patchScript =
+	"<script type=\"text/javascript\">//<![CDATA[\n"
+	"function lifereaItem (id) {\n"
+	"	return document.getElementById (id ? 'item-' + id : 'liferea-spacer');\n"
+	"}\n"
+	"\n"
+	"function lifereaParse (html) {\n"
+	"	var tmp = document.createElementNS ('http://www.w3.org/1999/xhtml', 'div');\n"
+	"	tmp.innerHTML = html;\n"
+	"	return tmp;\n"
+	"}\n"
+	"\n"
+	"/* keeps the visible content in place when changing things above it */\n"
+	"function lifereaPatch (anchor, change) {\n"
+	"	var root = document.documentElement;\n"
+	"	var height = root.scrollHeight;\n"
+	"	var above = anchor.getBoundingClientRect ().bottom <= 0;\n"
+	"	change ();\n"
+	"	if (above)\n"
+	"		window.scrollBy (0, root.scrollHeight - height);\n"
+	"}\n"
+	"\n"
+	"function lifereaInsertItem (afterId, html) {\n"
+	"	var prev = lifereaItem (afterId);\n"
+	"	var tmp = lifereaParse (html);\n"
+	"	if (prev)\n"
+	"		lifereaPatch (prev, function () {\n"
+	"			while (tmp.lastChild)\n"
+	"				prev.parentNode.insertBefore (tmp.lastChild, prev.nextSibling);\n"
+	"		});\n"
+	"}\n"
+	"\n"
+	"function lifereaReplaceItem (id, html) {\n"
+	"	var old = lifereaItem (id);\n"
+	"	var tmp = lifereaParse (html);\n"
+	"	if (old && tmp.firstChild)\n"
+	"		lifereaPatch (old, function () {\n"
+	"			old.parentNode.replaceChild (tmp.firstChild, old);\n"
+	"		});\n"
+	"}\n"
+	"\n"
+	"function lifereaRemoveItem (id) {\n"
+	"	var old = lifereaItem (id);\n"
+	"	if (old)\n"
+	"		lifereaPatch (old, function () {\n"
+	"			old.parentNode.removeChild (old);\n"
+	"		});\n"
+	"}\n"
+	"\n"
+	"function lifereaSetRead (id, read) {\n"
+	"	var item = lifereaItem (id);\n"
+	"	var nodes = item?item.querySelectorAll ('.itemshaded, .itemunshaded, .summaryshaded, .summaryunshaded'):[];\n"
+	"	for (var i = 0; i < nodes.length; i++)\n"
+	"		nodes[i].className = nodes[i].className.replace (/(item|summary)(un)?shaded/, read?'$1unshaded':'$1shaded');\n"
+	"}\n"
+	"//]]></script>";
+
+/* Paging scripts, all chunks are <body> elements between the spacer and the end marker */
+static const gchar *pagingScript =
+	"<script type=\"text/javascript\">//<![CDATA[\n"
+	"var lifereaLoading = false;\n"
+	"var lifereaHasPrev = false;\n"
+	"var lifereaHasNext = true;\n"
+	"\n"
+	"function lifereaCheckScroll () {\n"
+	"	var spacer = document.getElementById ('liferea-spacer');\n"
+	"	if (lifereaLoading)\n"
+	"		return;\n"
+	"	if (lifereaHasNext && window.pageYOffset + 2 * window.innerHeight >= document.documentElement.scrollHeight) {\n"
+	"		lifereaLoading = true;\n"
+	"		window.location.href = 'liferea-more-items://next';\n"
+	"	} else if (lifereaHasPrev && window.pageYOffset < spacer.offsetHeight + window.innerHeight) {\n"
+	"		lifereaLoading = true;\n"
+	"		window.location.href = 'liferea-more-items://previous';\n"
+	"	}\n"
+	"}\n"
+	"\n"
+	"function lifereaAddItems (html, atTop, drop, hasPrev, hasNext) {\n"
+	"	var root = document.documentElement;\n"
+	"	var spacer = document.getElementById ('liferea-spacer');\n"
+	"	var end = document.getElementById ('liferea-end');\n"
+	"	var tmp = document.createElementNS ('http://www.w3.org/1999/xhtml', 'div');\n"
+	"	var y = window.pageYOffset;\n"
+	"	var spacerHeight = spacer.offsetHeight;\n"
+	"	var height, added;\n"
+	"\n"
+	"	for (; drop > 0; drop--) {\n"
+	"		if (atTop) {\n"
+	"			root.removeChild (end.previousSibling);\n"
+	"		} else {\n"
+	"			height = root.scrollHeight;\n"
+	"			root.removeChild (spacer.nextSibling);\n"
+	"			spacerHeight += height - root.scrollHeight;\n"
+	"			spacer.style.height = spacerHeight + 'px';\n"
+	"		}\n"
+	"	}\n"
+	"\n"
+	"	tmp.innerHTML = html;\n"
+	"	height = root.scrollHeight;\n"
+	"	if (atTop) {\n"
+	"		while (tmp.lastChild)\n"
+	"			root.insertBefore (tmp.lastChild, spacer.nextSibling);\n"
+	"		added = root.scrollHeight - height;\n"
+	"		height = hasPrev ? Math.max (0, spacerHeight - added) : 0;\n"
+	"		spacer.style.height = height + 'px';\n"
+	"		window.scrollTo (window.pageXOffset, y + added + height - spacerHeight);\n"
+	"	} else {\n"
+	"		while (tmp.firstChild)\n"
+	"			root.insertBefore (tmp.firstChild, end);\n"
+	"	}\n"
+	"\n"
+	"	lifereaHasPrev = hasPrev;\n"
+	"	lifereaHasNext = hasNext;\n"
+	"	lifereaLoading = false;\n"
+	"	window.setTimeout (lifereaCheckScroll, 0);\n"
+	"}\n"
+	"\n"
+	"window.addEventListener ('scroll', lifereaCheckScroll, false);\n"
+	"window.addEventListener ('load', lifereaCheckScroll, false);\n"
+	"//]]></script>";
+
+/** changes of a chunk not yet applied to the document */
+typedef enum {
+	HTML_CHUNK_CURRENT = 0,	/**< nothing to do */
+	HTML_CHUNK_NEW,		/**< item was added */
+	HTML_CHUNK_CHANGED	/**< item was updated, HTML is the old rendering */
+} htmlChunkState;
+
 typedef struct htmlChunk 
 {
-	gulong 		id;	/**< item id */
-	gchar		*html;	/**< the rendered HTML (or NULL if not yet rendered) */
-	time_t		date;	/**< date as sorting criteria */
+	gulong 		id;		/**< item id */
+	gchar		*html;		/**< the rendered HTML (or NULL if not yet rendered) */
+	time_t		date;		/**< date as sorting criteria */
+	gboolean	readStatus;	/**< read status of the rendered item */
+	gboolean	inDocument;	/**< TRUE if the chunk is part of the document */
+	htmlChunkState	state;		/**< pending document change */
 } *htmlChunkPtr;
 
 static void
@@ -65,6 +232,31 @@ htmlview_chunk_sort (gconstpointer a,
 	return (((htmlChunkPtr)a)->date) - (((htmlChunkPtr)b)->date);
 }
 
+/* Speculative rendering: while an item is displayed, the item "next
+   unread" will most likely select is rendered in idle time and kept
+   until the selection changes. */
+
+static void
+htmlview_prefetch_drop (void)
+{
+	htmlView_priv.readyId = 0;
+	g_free (htmlView_priv.readyKey);
+	htmlView_priv.readyKey = NULL;
+	g_free (htmlView_priv.readyHtml);
+	htmlView_priv.readyHtml = NULL;
+}
+
+static void
+htmlview_prefetch_cancel (void)
+{
+	if (htmlView_priv.prefetchSource) {
+		g_source_remove (htmlView_priv.prefetchSource);
+		htmlView_priv.prefetchSource = 0;
+	}
+
+	htmlview_prefetch_drop ();
+}
+
 void 
 htmlview_init (void) 
 {
@@ -92,6 +284,13 @@ htmlview_clear (void)
 	htmlView_priv.chunkHash = g_hash_table_new (g_direct_hash, g_direct_equal);
 	htmlView_priv.orderedChunks = NULL;
 	htmlView_priv.missingContent = 0;
+
+	/* enforce a full reload */
+	g_slist_free (htmlView_priv.removedIds);
+	htmlView_priv.removedIds = NULL;
+	htmlView_priv.patchable = FALSE;
+
+	htmlview_prefetch_cancel ();
 }
 
 void
@@ -110,6 +309,8 @@ htmlview_add_item (itemPtr item)
 
 	chunk = g_new0 (struct htmlChunk, 1);
 	chunk->id = item->id;
+	if (htmlView_priv.patchable)
+		chunk->state = HTML_CHUNK_NEW;
 	g_hash_table_insert (htmlView_priv.chunkHash, GUINT_TO_POINTER (item->id), chunk);
 	
 	htmlView_priv.orderedChunks = g_slist_insert_sorted (htmlView_priv.orderedChunks, chunk, htmlview_chunk_sort);
@@ -128,6 +329,9 @@ htmlview_remove_item (itemPtr item)
 	chunk = g_hash_table_lookup (htmlView_priv.chunkHash, GUINT_TO_POINTER (item->id));
 	if (chunk) 
 	{
+		if (chunk->inDocument)
+			htmlView_priv.removedIds = g_slist_prepend (htmlView_priv.removedIds, GUINT_TO_POINTER (chunk->id));
+
 		g_hash_table_remove (htmlView_priv.chunkHash, GUINT_TO_POINTER (item->id));
 		htmlView_priv.orderedChunks = g_slist_remove (htmlView_priv.orderedChunks, chunk);
 		htmlview_chunk_free (chunk);
@@ -146,18 +350,27 @@ htmlview_update_item (itemPtr item)
 {
 	htmlChunkPtr	chunk;
 	
-	/* ensure rerendering on next update by replace old HTML chunk with NULL */
+	/* ensure rerendering on next update, chunks in the document keep
+	   the old HTML to find out what has to be changed in the document */
 	chunk = (htmlChunkPtr) g_hash_table_lookup (htmlView_priv.chunkHash, GUINT_TO_POINTER (item->id));
 	if (chunk) 
 	{
-		g_free (chunk->html);
-		chunk->html = NULL;
+		if (chunk->inDocument) {
+			if (HTML_CHUNK_CURRENT == chunk->state)
+				chunk->state = HTML_CHUNK_CHANGED;
+		} else {
+			g_free (chunk->html);
+			chunk->html = NULL;
+		}
 	}
 }
 
 void
 htmlview_update_all_items (void)
 {
+	/* the rendering options changed, so reload everything */
+	htmlView_priv.patchable = FALSE;
+
 	GSList	*iter = htmlView_priv.orderedChunks;
 	while (iter) {
 		htmlChunkPtr chunk = (htmlChunkPtr)iter->data;
@@ -180,66 +393,192 @@ htmlview_get_item_direction(itemPtr item)
 	return ("ltr");
 }
 
+/* Sets up the rendering options, returns the base URL to be free'd */
 static gchar *
-htmlview_render_item (itemPtr item, 
-                      guint viewMode,
-                      gboolean summaryMode) 
+htmlview_get_render_params (itemPtr item,
+                            nodePtr node,
+                            guint viewMode,
+                            gboolean summaryMode,
+                            itemRenderParamsPtr params)
 {
-	renderParamPtr	params;
-	gchar		*output = NULL, *baseUrl = NULL;
-	nodePtr		node;
-	xmlDocPtr 	doc;
-	xmlNodePtr 	xmlNode;
-	const gchar     *text_direction = NULL;
-	gboolean	isMergedItemset;
+	gchar	*baseUrl = NULL;
 
-	debug_enter ("htmlview_render_item");
+	if (NULL != node_get_base_url (node))
+		baseUrl = common_uri_escape (node_get_base_url (node));
+
+	params->baseUrl = baseUrl;
+	params->summary = summaryMode;
+	params->showFeedName = (node != htmlView_priv.node);
+	params->single = (viewMode == ITEMVIEW_SINGLE_ITEM);
+	params->txtDirection = htmlview_get_item_direction (item);
+	params->appDirection = common_get_app_direction ();
+
+	return baseUrl;
+}
+
+/* Renders an item, if cacheEntries is given it first tries the
+   persistent HTML cache and appends new renderings to the list */
+static gchar *
+htmlview_render_item_cached (itemPtr item,
+                             guint viewMode,
+                             gboolean summaryMode,
+                             GSList **cacheEntries)
+{
+	struct itemRenderParams	params;
+	gchar		*output = NULL, *baseUrl, *digest = NULL;
+	nodePtr		node;
 
 	/* don't use node from htmlView_priv as this would be
 	   wrong for folders and other merged item sets */
 	node = node_from_id (item->nodeId);
-	
-	isMergedItemset = (node != htmlView_priv.node);
 
-	/* do the XML serialization */
-	doc = xmlNewDoc ("1.0");
-	xmlNode = xmlNewDocNode (doc, NULL, "itemset", NULL);
-	xmlDocSetRootElement (doc, xmlNode);
-				
-	item_to_xml(item, xmlDocGetRootElement (doc));
-
-	text_direction = htmlview_get_item_direction (item);
-			
-	if (IS_FEED (node)) {
-		xmlNodePtr feed;
-		feed = xmlNewChild (xmlDocGetRootElement (doc), NULL, "feed", NULL);
-		feed_to_xml (node, feed);
-	}
-	
-	/* do the XSLT rendering */
-	params = render_parameter_new ();
-	
-	if (NULL != node_get_base_url (node)) {
-		baseUrl = common_uri_escape (node_get_base_url (node));
-		render_parameter_add (params, "baseUrl='%s'", baseUrl);
+	baseUrl = htmlview_get_render_params (item, node, viewMode, summaryMode, &params);
+
+	if (cacheEntries)
+		digest = item_render_get_digest (item, node, &params);
+
+	if (digest)
+		output = db_html_cache_load (item->id, digest);
+
+	if (!output) {
+		output = item_render (item, node, &params);
+
+		if (digest && output) {
+			htmlCacheEntryPtr entry = g_new0 (struct htmlCacheEntry, 1);
+			entry->id = item->id;
+			entry->digest = digest;
+			entry->html = g_strdup (output);
+			*cacheEntries = g_slist_prepend (*cacheEntries, entry);
+			digest = NULL;
+		}
 	}
 
-	render_parameter_add (params, "summary='%d'", summaryMode?1:0);
-	render_parameter_add (params, "showFeedName='%d'", isMergedItemset?1:0);
-	render_parameter_add (params, "single='%d'", (viewMode == ITEMVIEW_SINGLE_ITEM)?1:0);
-	render_parameter_add (params, "txtDirection='%s'", text_direction);
-	render_parameter_add (params, "appDirection='%s'", common_get_app_direction ());
-	output = render_xml (doc, "item", params);
-	
-	/* For debugging use: xmlSaveFormatFile("/tmp/test.xml", doc, 1); */
-	xmlFreeDoc (doc);
+	g_free (digest);
 	g_free (baseUrl);
-	
+
+	return output;
+}
+
+static gchar *
+htmlview_render_item (itemPtr item, 
+                      guint viewMode,
+                      gboolean summaryMode) 
+{
+	gchar	*output;
+
+	debug_enter ("htmlview_render_item");
+
+	output = htmlview_render_item_cached (item, viewMode, summaryMode, NULL);
+
 	debug_exit ("htmlview_render_item");
 
 	return output;
 }
 
+/* Returns a key identifying the single item rendering of an item */
+static gchar *
+htmlview_prefetch_get_key (itemPtr item)
+{
+	struct itemRenderParams	params;
+	gchar		*baseUrl, *key;
+	nodePtr		node;
+
+	node = node_from_id (item->nodeId);
+	baseUrl = htmlview_get_render_params (item, node, ITEMVIEW_SINGLE_ITEM, FALSE, &params);
+
+	/* Single item renderings are not cacheable because of the comments,
+	   which is dealt with by not prefetching items with comment feeds.
+	   Everything else is covered by the combined view digest. */
+	params.single = FALSE;
+	key = item_render_get_digest (item, node, &params);
+
+	g_free (baseUrl);
+
+	return key;
+}
+
+static gboolean
+htmlview_prefetch_cb (gpointer user_data)
+{
+	itemPtr	item;
+	gint64	start;
+
+	htmlView_priv.prefetchSource = 0;
+
+	if (!htmlView_priv.displayedId || (htmlView_priv.displayedId != itemlist_get_selected_id ()))
+		return FALSE;
+
+	item = itemview_find_unread_item (htmlView_priv.displayedId);
+	if (!item)
+		return FALSE;
+
+	/* Items with comment feeds get their comments refreshed on selecting,
+	   the rendering then differs anyway. */
+	if ((item->id != htmlView_priv.displayedId) &&
+	    !(metadata_list_get (item->metadata, "commentFeedUri") &&
+	      !metadata_list_get (item->metadata, "commentFeedGone"))) {
+		/* selecting will mark it read before rendering */
+		item->readStatus = TRUE;
+
+		debug1 (DEBUG_HTML, "prefetching item \"%s\"", item_get_title (item));
+
+		start = g_get_monotonic_time ();
+		htmlView_priv.readyHtml = htmlview_render_item (item, ITEMVIEW_SINGLE_ITEM, FALSE);
+		htmlView_priv.readyUsecs = g_get_monotonic_time () - start;
+		htmlView_priv.readyKey = htmlview_prefetch_get_key (item);
+		htmlView_priv.readyId = item->id;
+	}
+
+	item_unload (item);
+
+	return FALSE;
+}
+
+/* Prefetches the next unread item once the UI is idle */
+static void
+htmlview_prefetch_schedule (void)
+{
+	htmlview_prefetch_cancel ();
+	htmlView_priv.prefetchSource = g_idle_add_full (G_PRIORITY_LOW, htmlview_prefetch_cb, NULL, NULL);
+}
+
+/* Returns the prefetched rendering if it is the one for the given
+   item, any other prefetched rendering is dropped */
+static gchar *
+htmlview_prefetch_take (itemPtr item)
+{
+	gchar	*html = NULL, *key;
+
+	if (!htmlView_priv.readyId)
+		return NULL;
+
+	if (item->id == htmlView_priv.readyId) {
+		key = htmlview_prefetch_get_key (item);
+		if (g_str_equal (key, htmlView_priv.readyKey)) {
+			html = htmlView_priv.readyHtml;
+			htmlView_priv.readyHtml = NULL;
+		}
+		g_free (key);
+	}
+
+	if (html) {
+		htmlView_priv.prefetchHits++;
+		htmlView_priv.prefetchSaved += htmlView_priv.readyUsecs;
+	} else {
+		htmlView_priv.prefetchMisses++;
+	}
+
+	debug4 (DEBUG_HTML, "item prefetching: %u hits, %u misses (%.0f%%), %.1fms saved",
+	        htmlView_priv.prefetchHits,
+	        htmlView_priv.prefetchMisses,
+	        100.0 * htmlView_priv.prefetchHits / (htmlView_priv.prefetchHits + htmlView_priv.prefetchMisses),
+	        htmlView_priv.prefetchSaved / 1000.0);
+
+	htmlview_prefetch_drop ();
+
+	return html;
+}
+
 void 
 htmlview_start_output (GString *buffer,
                        const gchar *base,
@@ -311,14 +650,432 @@ htmlview_finish_output (GString *buffer)
 	g_string_append (buffer, "</html>"); 
 }
 
+/* Quotes a string for use as a JavaScript string literal */
+static gchar *
+htmlview_escape_js_string (const gchar *str)
+{
+	GString	*escaped = g_string_sized_new (strlen (str) + 64);
+
+	for (; *str; str++) {
+		switch (*str) {
+			case '\\':
+				g_string_append (escaped, "\\\\");
+				break;
+			case '\'':
+				g_string_append (escaped, "\\'");
+				break;
+			case '\n':
+				g_string_append (escaped, "\\n");
+				break;
+			case '\r':
+				g_string_append (escaped, "\\r");
+				break;
+			default:
+				/* U+2028 and U+2029 would end the line */
+				if ((guchar)str[0] == 0xe2 && (guchar)str[1] == 0x80 &&
+				    ((guchar)str[2] == 0xa8 || (guchar)str[2] == 0xa9)) {
+					g_string_append (escaped, ((guchar)str[2] == 0xa8)?"\\u2028":"\\u2029");
+					str += 2;
+				} else {
+					g_string_append_c (escaped, *str);
+				}
+				break;
+		}
+	}
+
+	return g_string_free (escaped, FALSE);
+}
+
+/* Appends an item rendering tagged with the item id so it can be found in the document */
+static void
+htmlview_append_item_html (GString *output, gulong id, const gchar *html)
+{
+	if (g_str_has_prefix (html, "<body"))
+		g_string_append_printf (output, "<body id=\"item-%lu\"%s", id, html + strlen ("<body"));
+	else
+		g_string_append (output, html);
+}
+
+/* Saves all new renderings in the persistent cache at once */
+static void
+htmlview_store_cache_entries (GSList *cacheEntries)
+{
+	GSList	*iter;
+
+	db_html_cache_store (cacheEntries, HTML_CACHE_MAX_SIZE);
+	for (iter = cacheEntries; iter; iter = g_slist_next (iter)) {
+		htmlCacheEntryPtr entry = (htmlCacheEntryPtr)iter->data;
+		g_free (entry->digest);
+		g_free (entry->html);
+		g_free (entry);
+	}
+	g_slist_free (cacheEntries);
+}
+
+/* Gets the chunk HTML from the persistent cache or renders the item */
+static void
+htmlview_render_chunk (htmlChunkPtr chunk, GSList **cacheEntries)
+{
+	itemPtr	item;
+
+	g_free (chunk->html);
+	chunk->html = NULL;
+	chunk->state = HTML_CHUNK_CURRENT;
+
+	item = item_load (chunk->id);
+	if (item) {
+		debug1 (DEBUG_HTML, "rendering item to HTML view: >>>%s<<<", item_get_title (item));
+		chunk->html = htmlview_render_item_cached (item, ITEMVIEW_ALL_ITEMS, htmlView_priv.summaryMode, cacheEntries);
+		chunk->readStatus = item->readStatus;
+		item_unload (item);
+	}
+}
+
+/* Renders the chunks [start, end) of the combined view if not yet done */
+static void
+htmlview_render_chunks (GString *output, guint start, guint end)
+{
+	GSList	*iter, *cacheEntries = NULL;
+	guint	i;
+
+	for (iter = g_slist_nth (htmlView_priv.orderedChunks, start), i = start; iter && i < end; iter = g_slist_next (iter), i++) {
+		/* try to retrieve item HTML chunk from cache */
+		htmlChunkPtr chunk = (htmlChunkPtr)iter->data;
+		
+		/* if not found: get it from the persistent cache
+		   or render new item now and add to both caches */
+		if (!chunk->html || (HTML_CHUNK_CURRENT != chunk->state))
+			htmlview_render_chunk (chunk, &cacheEntries);
+		
+		if (!chunk->html)
+			continue;
+
+		chunk->inDocument = TRUE;
+		htmlview_append_item_html (output, chunk->id, chunk->html);
+	}
+
+	htmlview_store_cache_entries (cacheEntries);
+}
+
+/* Determines the chunks [start, end) in the document */
+static void
+htmlview_get_window (guint *start, guint *end, guint *length)
+{
+	GSList	*iter;
+	guint	i;
+
+	*start = *end = 0;
+	for (iter = htmlView_priv.orderedChunks, i = 0; iter; iter = g_slist_next (iter), i++) {
+		if (((htmlChunkPtr)iter->data)->inDocument) {
+			if (0 == *end)
+				*start = i;
+			*end = i + 1;
+		}
+	}
+	*length = i;
+}
+
+/* Marks the chunks [start, end) as removed from the document */
+static void
+htmlview_drop_chunks (guint start, guint end)
+{
+	GSList	*iter;
+	guint	i;
+
+	for (iter = g_slist_nth (htmlView_priv.orderedChunks, start), i = start; iter && i < end; iter = g_slist_next (iter), i++)
+		((htmlChunkPtr)iter->data)->inDocument = FALSE;
+}
+
+void
+htmlview_load_more_items (LifereaHtmlView *htmlview, gboolean previous)
+{
+	GString	*html;
+	gchar	*escaped, *script;
+	guint	length, start, end, windowStart, windowEnd, drop = 0;
+
+	/* the document will be reloaded anyway, but the
+	   script must not wait for an answer forever */
+	if (!htmlView_priv.paging || !htmlView_priv.patchable) {
+		liferea_htmlview_execute_script (htmlview, "lifereaLoading = false;");
+		return;
+	}
+
+	/* items might have been added or removed in the meantime */
+	htmlview_get_window (&windowStart, &windowEnd, &length);
+
+	if (previous) {
+		end = windowStart;
+		start = (end > HTMLVIEW_PAGE_SIZE)?end - HTMLVIEW_PAGE_SIZE:0;
+		windowStart = start;
+		if (windowEnd - start > HTMLVIEW_PAGE_SIZE * HTMLVIEW_MAX_PAGES) {
+			drop = windowEnd - start - HTMLVIEW_PAGE_SIZE * HTMLVIEW_MAX_PAGES;
+			windowEnd -= drop;
+			htmlview_drop_chunks (windowEnd, windowEnd + drop);
+		}
+	} else {
+		start = windowEnd;
+		end = MIN (length, start + HTMLVIEW_PAGE_SIZE);
+		windowEnd = end;
+		if (end - windowStart > HTMLVIEW_PAGE_SIZE * HTMLVIEW_MAX_PAGES) {
+			drop = end - windowStart - HTMLVIEW_PAGE_SIZE * HTMLVIEW_MAX_PAGES;
+			htmlview_drop_chunks (windowStart, windowStart + drop);
+			windowStart += drop;
+		}
+	}
+
+	debug4 (DEBUG_HTML, "HTML view: adding items %u-%u, window is now %u-%u", start, end, windowStart, windowEnd);
+
+	html = g_string_new (NULL);
+	htmlview_render_chunks (html, start, end);
+	escaped = htmlview_escape_js_string (html->str);
+	script = g_strdup_printf ("lifereaAddItems ('%s', %s, %u, %s, %s);",
+	                          escaped,
+	                          previous?"true":"false",
+	                          drop,
+	                          (windowStart > 0)?"true":"false",
+	                          (windowEnd < length)?"true":"false");
+	liferea_htmlview_execute_script (htmlview, script);
+
+	g_free (script);
+	g_free (escaped);
+	g_string_free (html, TRUE);
+}
+
+/* Output optimization for feeds without item content. This
+   is not done for folders, because we only support all items
+   in summary mode or all in detailed mode. With folder item 
+   sets displaying everything in summary because of only a
+   single feed without item descriptions would make no sense. */
+static gboolean
+htmlview_get_summary_mode (void)
+{
+	return (NULL != htmlView_priv.node) &&
+	       !IS_FOLDER (htmlView_priv.node) && 
+	       !IS_VFOLDER (htmlView_priv.node) && 
+	       (htmlView_priv.missingContent > 3);
+}
+
+/* Checks whether two renderings of an item only differ in the read state shading */
+static gboolean
+htmlview_differs_in_read_state_only (const gchar *old, const gchar *new)
+{
+	gchar		**tmp;
+	gchar		*oldShaded, *newShaded;
+	gboolean	result;
+
+	tmp = g_strsplit (old, "unshaded", -1);
+	oldShaded = g_strjoinv ("shaded", tmp);
+	g_strfreev (tmp);
+	tmp = g_strsplit (new, "unshaded", -1);
+	newShaded = g_strjoinv ("shaded", tmp);
+	g_strfreev (tmp);
+
+	result = g_str_equal (oldShaded, newShaded);
+
+	g_free (oldShaded);
+	g_free (newShaded);
+
+	return result;
+}
+
+/* Appends a call passing an item rendering tagged like in the document,
+   so that later patches can find the inserted or replaced item again */
+static void
+htmlview_append_js_call (GString *script, const gchar *func, gulong arg, gulong id, const gchar *html)
+{
+	GString	*tagged = g_string_new (NULL);
+	gchar	*escaped;
+
+	htmlview_append_item_html (tagged, id, html);
+	escaped = htmlview_escape_js_string (tagged->str);
+	g_string_append_printf (script, "%s (%lu, '%s');\n", func, arg, escaped);
+	g_free (escaped);
+	g_string_free (tagged, TRUE);
+}
+
+/* Creates the script applying all item changes to the combined view */
+static GString *
+htmlview_patch_all_items (void)
+{
+	GString		*script = g_string_new (NULL);
+	GSList		*iter, *cacheEntries = NULL;
+	htmlChunkPtr	chunk, prev = NULL;
+	gchar		*old;
+	gboolean	atStart = TRUE;
+	guint		start, end, length;
+
+	for (iter = htmlView_priv.removedIds; iter; iter = g_slist_next (iter))
+		g_string_append_printf (script, "lifereaRemoveItem (%lu);\n", (gulong)GPOINTER_TO_UINT (iter->data));
+	g_slist_free (htmlView_priv.removedIds);
+	htmlView_priv.removedIds = NULL;
+
+	/* New items are only inserted next to items in the document, all
+	   others will be added by the paging when scrolling there. */
+	for (iter = htmlView_priv.orderedChunks; iter; iter = g_slist_next (iter)) {
+		chunk = (htmlChunkPtr)iter->data;
+		if (HTML_CHUNK_NEW != chunk->state) {
+			atStart = chunk->inDocument;
+			break;
+		}
+	}
+
+	for (iter = htmlView_priv.orderedChunks; iter; prev = chunk, iter = g_slist_next (iter)) {
+		chunk = (htmlChunkPtr)iter->data;
+
+		switch (chunk->state) {
+			case HTML_CHUNK_NEW:
+				chunk->state = HTML_CHUNK_CURRENT;
+				if (prev?!prev->inDocument:!atStart)
+					break;
+
+				htmlview_render_chunk (chunk, &cacheEntries);
+				if (chunk->html) {
+					htmlview_append_js_call (script, "lifereaInsertItem", prev?prev->id:0, chunk->id, chunk->html);
+					chunk->inDocument = TRUE;
+				}
+				break;
+			case HTML_CHUNK_CHANGED:
+				if (!chunk->inDocument) {
+					/* dropped by the paging in the meantime */
+					g_free (chunk->html);
+					chunk->html = NULL;
+					chunk->state = HTML_CHUNK_CURRENT;
+					break;
+				}
+
+				old = chunk->html;
+				chunk->html = NULL;
+				htmlview_render_chunk (chunk, &cacheEntries);
+
+				if (!chunk->html)
+					g_string_append_printf (script, "lifereaRemoveItem (%lu);\n", chunk->id);
+				else if (g_str_equal (old, chunk->html))
+					;	/* e.g. flag changes are not rendered */
+				else if (htmlview_differs_in_read_state_only (old, chunk->html))
+					g_string_append_printf (script, "lifereaSetRead (%lu, %s);\n", chunk->id, chunk->readStatus?"true":"false");
+				else
+					htmlview_append_js_call (script, "lifereaReplaceItem", chunk->id, chunk->id, chunk->html);
+
+				chunk->inDocument = (NULL != chunk->html);
+				g_free (old);
+				break;
+			default:
+				break;
+		}
+	}
+
+	htmlview_store_cache_entries (cacheEntries);
+
+	if (htmlView_priv.paging) {
+		htmlview_get_window (&start, &end, &length);
+		g_string_append_printf (script, "lifereaHasPrev = %s;\nlifereaHasNext = %s;\n",
+		                        (start > 0)?"true":"false",
+		                        (end < length)?"true":"false");
+	}
+
+	return script;
+}
+
+/* Creates the script updating the single item view, or returns NULL
+   if another item is selected */
+static GString *
+htmlview_patch_single_item (void)
+{
+	GString	*script;
+	itemPtr	item;
+	gchar	*html;
+
+	item = itemlist_get_selected ();
+	if (!item)
+		return NULL;
+
+	if (item->id != htmlView_priv.displayedId) {
+		item_unload (item);
+		return NULL;
+	}
+
+	html = htmlview_render_item (item, ITEMVIEW_SINGLE_ITEM, FALSE);
+	item_unload (item);
+	if (!html)
+		return NULL;
+
+	script = g_string_new (NULL);
+	if (g_strcmp0 (html, htmlView_priv.displayedHtml)) {
+		htmlview_append_js_call (script, "lifereaReplaceItem", htmlView_priv.displayedId, htmlView_priv.displayedId, html);
+		g_free (htmlView_priv.displayedHtml);
+		htmlView_priv.displayedHtml = html;
+	} else {
+		g_free (html);
+	}
+
+	return script;
+}
+
+/* Tries to apply all changes to the document without reloading it */
+static gboolean
+htmlview_patch (LifereaHtmlView *htmlview, itemViewMode mode)
+{
+	GString		*script = NULL;
+	gboolean	success = TRUE;
+
+	if (!htmlView_priv.patchable || (mode != htmlView_priv.documentMode))
+		return FALSE;
+
+	if (!liferea_htmlview_can_execute_script (htmlview))
+		return FALSE;
+
+	debug_start_measurement (DEBUG_HTML);
+
+	switch (mode) {
+		case ITEMVIEW_ALL_ITEMS:
+			if (htmlview_get_summary_mode () == htmlView_priv.summaryMode)
+				script = htmlview_patch_all_items ();
+			break;
+		case ITEMVIEW_SINGLE_ITEM:
+			script = htmlview_patch_single_item ();
+			break;
+		default:
+			break;
+	}
+
+	if (!script)
+		return FALSE;
+
+	/* Guard against the document having been replaced (e.g. when browsing) */
+	if (script->len) {
+		g_string_prepend (script, "if (window.lifereaPatch) {\n");
+		g_string_append (script, "}");
+		success = liferea_htmlview_execute_script (htmlview, script->str);
+	}
+
+	debug1 (DEBUG_HTML, "patching HTML view with %d bytes of script", script->len);
+	debug_end_measurement (DEBUG_HTML, "HTML view patch");
+
+	g_string_free (script, TRUE);
+
+	return success;
+}
+
 void
 htmlview_update (LifereaHtmlView *htmlview, itemViewMode mode) 
 {
-	GSList		*iter;
 	GString		*output;
 	itemPtr		item = NULL;
 	gchar		*baseURL = NULL;
 	gboolean	summaryMode;
+	GSList		*iter;
+	guint		length;
+
+	if (htmlview_patch (htmlview, mode))
+		return;
+
+	debug_start_measurement (DEBUG_HTML);
+
+	htmlView_priv.paging = FALSE;
+	htmlView_priv.patchable = FALSE;
+	htmlView_priv.documentMode = mode;
+	g_slist_free (htmlView_priv.removedIds);
+	htmlView_priv.removedIds = NULL;
 
 	/* determine base URL */
 	switch (mode) {
@@ -346,50 +1103,50 @@ htmlview_update (LifereaHtmlView *htmlview, itemViewMode mode)
 	   concatenate everything from cache and output it */
 	switch (mode) {
 		case ITEMVIEW_SINGLE_ITEM:
+			g_free (htmlView_priv.displayedHtml);
+			htmlView_priv.displayedHtml = NULL;
 			item = itemlist_get_selected ();
 			if (item) {
-				gchar *html = htmlview_render_item (item, mode, FALSE);
+				gchar *html = htmlview_prefetch_take (item);
+				if (!html)
+					html = htmlview_render_item (item, mode, FALSE);
 				if (html) {
-					g_string_append (output, html);
-					g_free (html);
+					htmlview_append_item_html (output, item->id, html);
+					htmlView_priv.displayedId = item->id;
+					htmlView_priv.displayedHtml = html;
+					htmlView_priv.patchable = liferea_htmlview_can_execute_script (htmlview);
 				}
 				
 				item_unload (item);
 			}
+
+			if (htmlView_priv.patchable)
+				g_string_append (output, patchScript);
 			break;
 		case ITEMVIEW_ALL_ITEMS:
-			/* Output optimization for feeds without item content. This
-			   is not done for folders, because we only support all items
-			   in summary mode or all in detailed mode. With folder item 
-			   sets displaying everything in summary because of only a
-			   single feed without item descriptions would make no sense. */
-
-			summaryMode = (NULL != htmlView_priv.node) &&
-			              !IS_FOLDER (htmlView_priv.node) && 
-	        		      !IS_VFOLDER (htmlView_priv.node) && 
-	        		      (htmlView_priv.missingContent > 3);
-
-			/* concatenate all items */
-			iter = htmlView_priv.orderedChunks;
-			while (iter) {
-				/* try to retrieve item HTML chunk from cache */
+			summaryMode = htmlview_get_summary_mode ();
+
+			/* concatenate the first page of items, or all items if
+			   the HTML widget cannot run the paging scripts */
+			length = 0;
+			for (iter = htmlView_priv.orderedChunks; iter; iter = g_slist_next (iter)) {
 				htmlChunkPtr chunk = (htmlChunkPtr)iter->data;
-				
-				/* if not found: render new item now and add to cache */
-				if (!chunk->html) {
-					item = item_load (chunk->id);
-					if (item) {
-						debug1 (DEBUG_HTML, "rendering item to HTML view: >>>%s<<<", item_get_title (item));
-						chunk->html = htmlview_render_item (item, mode, summaryMode);
-						item_unload (item);
-					}
-				}
-				
-				if (chunk->html)
-					g_string_append (output, chunk->html);
-					
-				iter = g_slist_next (iter);
+				chunk->inDocument = FALSE;
+				chunk->state = HTML_CHUNK_CURRENT;
+				length++;
 			}
+			htmlView_priv.summaryMode = summaryMode;
+			htmlView_priv.patchable = liferea_htmlview_can_execute_script (htmlview);
+			htmlView_priv.paging = htmlView_priv.patchable && (length > HTMLVIEW_PAGE_SIZE);
+
+			g_string_append (output, "<div id=\"liferea-spacer\"></div>");
+			htmlview_render_chunks (output, 0, htmlView_priv.paging?HTMLVIEW_PAGE_SIZE:length);
+			g_string_append (output, "<div id=\"liferea-end\"></div>");
+
+			if (htmlView_priv.patchable)
+				g_string_append (output, patchScript);
+			if (htmlView_priv.paging)
+				g_string_append (output, pagingScript);
 			break;
 		case ITEMVIEW_NODE_INFO:
 			{
@@ -413,6 +1170,12 @@ htmlview_update (LifereaHtmlView *htmlview, itemViewMode mode)
 
 	debug1 (DEBUG_HTML, "writing %d bytes to HTML view", strlen (output->str));
 	liferea_htmlview_write (htmlview, output->str, baseURL);
+	debug_end_measurement (DEBUG_HTML, "HTML view update");
+
+	if (ITEMVIEW_SINGLE_ITEM == mode)
+		htmlview_prefetch_schedule ();
+	else
+		htmlview_prefetch_cancel ();
 	
 	g_string_free (output, TRUE);
 	g_free (baseURL);
@@ -96,6 +96,17 @@ void	htmlview_update_all_items (void);
  */
 void	htmlview_update (LifereaHtmlView *htmlview, itemViewMode mode);
 
+/**
+ * Adds the next or previous page of items to a combined view that
+ * shows only a window of all items. Items far off the new page are
+ * removed from the document. Triggered by the document scripts when
+ * scrolling close to the start or end of the window.
+ *
+ * @param htmlview	HTML view showing the combined view
+ * @param previous	TRUE to add the page before the window
+ */
+void	htmlview_load_more_items (LifereaHtmlView *htmlview, gboolean previous);
+
 /** helper methods for HTML output */
 
 /**
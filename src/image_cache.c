@@ -0,0 +1,469 @@
+/**
+ * @file image_cache.c  local cache for item images
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libsoup/soup.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "common.h"
+#include "debug.h"
+#include "image_cache.h"
+#include "net_monitor.h"
+#include "update.h"
+
+/* The image cache keeps the images of item descriptions on disk, so
+   they do not need to be refetched whenever an item is displayed and
+   are available offline.
+
+   Rendered items refer to images with liferea-cache:/// URIs containing
+   the escaped original URL. The HTML widget resolves them on loading
+   using image_cache_resolve_uri(). This keeps the rendered HTML stable
+   (and cacheable) no matter whether an image was downloaded already.
+   On a cache miss the HTML widget loads the original URL and passes
+   the downloaded data to image_cache_store(), so an image is never
+   downloaded twice.
+
+   Images are stored by URL hash in the "images" cache directory. The
+   file modification time is updated on every use, so it can be used
+   to drop the least recently used images when the cache gets too
+   large and images not used for a long time. */
+
+#define IMAGE_CACHE_MAX_SIZE	(100 * 1024 * 1024)	/**< size limit of the image cache in bytes */
+#define IMAGE_CACHE_MAX_AGE	(30 * 24 * 60 * 60)	/**< drop images not used for 30 days */
+#define IMAGE_CACHE_HOST_JOBS	2			/**< parallel downloads per host */
+
+typedef struct imageHost {
+	guint		running;	/**< number of running downloads */
+	GQueue		*pending;	/**< URLs waiting for a download slot */
+} *imageHostPtr;
+
+typedef struct imageFile {
+	gchar		*filename;
+	time_t		mtime;
+	goffset		size;
+} *imageFilePtr;
+
+static GHashTable	*hosts = NULL;		/**< host name -> imageHost */
+static GHashTable	*downloads = NULL;	/**< set of URLs queued or being downloaded */
+static GHashTable	*misses = NULL;		/**< set of URLs resolved on a cache miss */
+static guint64		cacheSize = 0;		/**< current size of all cached images */
+
+static void
+image_cache_host_free (gpointer data)
+{
+	imageHostPtr host = (imageHostPtr)data;
+
+	g_queue_free_full (host->pending, g_free);
+	g_free (host);
+}
+
+static gchar *
+image_cache_get_filename (const gchar *url)
+{
+	gchar	*hash, *filename;
+
+	hash = g_compute_checksum_for_string (G_CHECKSUM_MD5, url, -1);
+	filename = common_create_cache_filename ("images", hash, NULL);
+	g_free (hash);
+
+	return filename;
+}
+
+static gint
+image_cache_file_cmp (gconstpointer a, gconstpointer b)
+{
+	return ((imageFilePtr)a)->mtime - ((imageFilePtr)b)->mtime;
+}
+
+/* Drops images not used for a long time and the least recently
+   used images while the cache exceeds its size limit */
+static void
+image_cache_trim (void)
+{
+	GDir		*dir;
+	GSList		*files = NULL, *iter;
+	const gchar	*name;
+	gchar		*path;
+	time_t		now = time (NULL);
+	guint		removed = 0;
+
+	path = common_create_cache_filename ("images", "", NULL);
+	dir = g_dir_open (path, 0, NULL);
+	g_free (path);
+	if (!dir)
+		return;
+
+	debug_start_measurement (DEBUG_CACHE);
+
+	cacheSize = 0;
+	while (NULL != (name = g_dir_read_name (dir))) {
+		imageFilePtr	file;
+		struct stat	st;
+
+		path = common_create_cache_filename ("images", name, NULL);
+		if (0 != g_stat (path, &st) || !S_ISREG (st.st_mode)) {
+			g_free (path);
+			continue;
+		}
+
+		if (st.st_mtime < now - IMAGE_CACHE_MAX_AGE) {
+			g_unlink (path);
+			g_free (path);
+			removed++;
+			continue;
+		}
+
+		file = g_new0 (struct imageFile, 1);
+		file->filename = path;
+		file->mtime = st.st_mtime;
+		file->size = st.st_size;
+		files = g_slist_prepend (files, file);
+		cacheSize += st.st_size;
+	}
+	g_dir_close (dir);
+
+	/* oldest first */
+	files = g_slist_sort (files, image_cache_file_cmp);
+	for (iter = files; iter; iter = g_slist_next (iter)) {
+		imageFilePtr file = (imageFilePtr)iter->data;
+
+		if (cacheSize > IMAGE_CACHE_MAX_SIZE) {
+			g_unlink (file->filename);
+			cacheSize -= file->size;
+			removed++;
+		}
+
+		g_free (file->filename);
+		g_free (file);
+	}
+	g_slist_free (files);
+
+	debug2 (DEBUG_CACHE, "image cache: removed %u images, %" G_GUINT64_FORMAT " bytes left", removed, cacheSize);
+	debug_end_measurement (DEBUG_CACHE, "image cache trimming");
+}
+
+static gboolean
+image_cache_trim_cb (gpointer user_data)
+{
+	image_cache_trim ();
+
+	return FALSE;
+}
+
+void
+image_cache_init (void)
+{
+	hosts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, image_cache_host_free);
+	downloads = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	misses = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	g_idle_add (image_cache_trim_cb, NULL);
+}
+
+void
+image_cache_deinit (void)
+{
+	g_hash_table_destroy (hosts);
+	hosts = NULL;
+	g_hash_table_destroy (downloads);
+	downloads = NULL;
+	g_hash_table_destroy (misses);
+	misses = NULL;
+}
+
+/* Writes an image to the cache, HTML error pages are not stored */
+static void
+image_cache_save (const gchar *url, const gchar *data, gsize size, const gchar *contentType)
+{
+	gchar	*filename;
+	GError	*error = NULL;
+
+	if (!data || !size || (contentType && g_str_has_prefix (contentType, "text/")))
+		return;
+
+	filename = image_cache_get_filename (url);
+	if (g_file_set_contents (filename, data, size, &error)) {
+		debug2 (DEBUG_CACHE, "image cache: stored %s (%" G_GSIZE_FORMAT " bytes)", url, size);
+		cacheSize += size;
+		if (cacheSize > IMAGE_CACHE_MAX_SIZE)
+			image_cache_trim ();
+	} else {
+		debug2 (DEBUG_CACHE, "image cache: could not store %s: %s", url, error->message);
+		g_error_free (error);
+	}
+	g_free (filename);
+}
+
+static void image_cache_download_next (imageHostPtr host);
+
+static void
+image_cache_download_cb (const struct updateResult * const result, gpointer user_data, updateFlags flags)
+{
+	gchar		*url = (gchar *)user_data;
+	gchar		*hostname;
+	imageHostPtr	host;
+
+	if (200 == result->httpstatus)
+		image_cache_save (url, result->data, result->size, result->contentType);
+	else
+		debug2 (DEBUG_CACHE, "image cache: downloading %s failed (HTTP %d)", url, result->httpstatus);
+
+	hostname = g_strdup (g_hash_table_lookup (downloads, url));
+	g_hash_table_remove (downloads, url);
+
+	/* start the next download for this host */
+	host = g_hash_table_lookup (hosts, hostname);
+	if (host) {
+		host->running--;
+		image_cache_download_next (host);
+		if (!host->running)
+			g_hash_table_remove (hosts, hostname);
+	}
+
+	g_free (hostname);
+	g_free (url);
+}
+
+static void
+image_cache_download_next (imageHostPtr host)
+{
+	updateRequestPtr	request;
+	gchar			*url;
+
+	while (host->running < IMAGE_CACHE_HOST_JOBS) {
+		url = g_queue_pop_head (host->pending);
+		if (!url)
+			return;
+
+		debug1 (DEBUG_CACHE, "image cache: downloading %s", url);
+
+		request = update_request_new ();
+		request->source = g_strdup (url);
+		request->options = g_new0 (struct updateOptions, 1);
+		update_execute_request (hosts, request, image_cache_download_cb, url, 0);
+		host->running++;
+	}
+}
+
+/* Queues the download of an image, at most IMAGE_CACHE_HOST_JOBS
+   downloads per host are run at once to not hammer the servers */
+static void
+image_cache_fetch (const gchar *url)
+{
+	imageHostPtr	host;
+	SoupURI		*uri;
+
+	if (!downloads || !network_monitor_is_online ())
+		return;
+
+	if (g_hash_table_lookup (downloads, url))
+		return;
+
+	uri = soup_uri_new (url);
+	if (!uri)
+		return;
+
+	if (uri->host && (SOUP_URI_SCHEME_HTTP == uri->scheme || SOUP_URI_SCHEME_HTTPS == uri->scheme)) {
+		host = g_hash_table_lookup (hosts, uri->host);
+		if (!host) {
+			host = g_new0 (struct imageHost, 1);
+			host->pending = g_queue_new ();
+			g_hash_table_insert (hosts, g_strdup (uri->host), host);
+		}
+
+		/* remember the host to find its queue when done */
+		g_hash_table_insert (downloads, g_strdup (url), g_strdup (uri->host));
+		g_queue_push_tail (host->pending, g_strdup (url));
+		image_cache_download_next (host);
+	}
+
+	soup_uri_free (uri);
+}
+
+/* Decodes an attribute value, returns NULL for values with entities other than &amp; */
+static gchar *
+image_cache_decode_attribute (const gchar *value, gsize length)
+{
+	gchar	*result, *entity;
+
+	result = common_strreplace (g_strndup (value, length), "&amp;", "&");
+	entity = strchr (result, '&');
+	if (entity && strchr (entity, ';')) {
+		g_free (result);
+		return NULL;
+	}
+
+	return result;
+}
+
+/* Finds the next <img> tag with a src attribute, returns the position
+   after the tag or NULL if there is none */
+static const gchar *
+image_cache_find_img_src (const gchar *html, const gchar **valueStart, const gchar **valueEnd)
+{
+	const gchar	*tag, *tagEnd, *pos;
+	gchar		quote;
+
+	while (NULL != (tag = common_strcasestr (html, "<img"))) {
+		tagEnd = strchr (tag, '>');
+		if (!tagEnd)
+			return NULL;
+
+		for (pos = tag + strlen ("<img"); pos < tagEnd; pos++) {
+			if (!g_ascii_isspace (pos[0]) || g_ascii_strncasecmp (pos + 1, "src", 3))
+				continue;
+
+			pos += 4;
+			while (g_ascii_isspace (*pos))
+				pos++;
+			if (*pos != '=')
+				continue;
+			pos++;
+			while (g_ascii_isspace (*pos))
+				pos++;
+
+			quote = *pos;
+			if (quote != '"' && quote != '\'')
+				continue;
+
+			*valueStart = pos + 1;
+			*valueEnd = strchr (*valueStart, quote);
+			if (!*valueEnd)
+				return NULL;
+
+			return MAX (*valueEnd + 1, tagEnd + 1);
+		}
+
+		html = tagEnd + 1;
+	}
+
+	return NULL;
+}
+
+gchar *
+image_cache_rewrite_html (const gchar *html)
+{
+	GString		*result;
+	const gchar	*pos = html, *next, *valueStart, *valueEnd;
+	gchar		*url, *escaped;
+
+	result = g_string_sized_new (strlen (html));
+
+	while (NULL != (next = image_cache_find_img_src (pos, &valueStart, &valueEnd))) {
+		g_string_append_len (result, pos, valueStart - pos);
+
+		url = image_cache_decode_attribute (valueStart, valueEnd - valueStart);
+		if (url && (g_str_has_prefix (url, "http://") || g_str_has_prefix (url, "https://"))) {
+			/* all reserved characters are escaped, so it is a valid attribute value */
+			escaped = g_uri_escape_string (url, NULL, FALSE);
+			g_string_append (result, IMAGE_CACHE_SCHEME);
+			g_string_append (result, escaped);
+			g_free (escaped);
+		} else {
+			g_string_append_len (result, valueStart, valueEnd - valueStart);
+		}
+		g_free (url);
+
+		g_string_append_len (result, valueEnd, next - valueEnd);
+		pos = next;
+	}
+	g_string_append (result, pos);
+
+	return g_string_free (result, FALSE);
+}
+
+gchar *
+image_cache_resolve_uri (const gchar *uri)
+{
+	gchar	*url, *filename, *result;
+
+	if (!g_str_has_prefix (uri, IMAGE_CACHE_SCHEME))
+		return NULL;
+
+	url = g_uri_unescape_string (uri + strlen (IMAGE_CACHE_SCHEME), NULL);
+	if (!url)
+		return NULL;
+
+	/* the URI comes from feed content, never let it refer to local files */
+	if (!g_str_has_prefix (url, "http://") && !g_str_has_prefix (url, "https://")) {
+		debug1 (DEBUG_CACHE, "image cache: refusing to resolve %s", url);
+		g_free (url);
+		return NULL;
+	}
+
+	filename = image_cache_get_filename (url);
+	if (g_file_test (filename, G_FILE_TEST_IS_REGULAR)) {
+		/* mark as recently used */
+		g_utime (filename, NULL);
+		result = g_filename_to_uri (filename, NULL, NULL);
+		g_free (url);
+	} else {
+		/* the HTML widget downloads it and passes it to image_cache_store() */
+		if (misses)
+			g_hash_table_insert (misses, g_strdup (url), GINT_TO_POINTER (TRUE));
+		result = url;
+	}
+	g_free (filename);
+
+	return result;
+}
+
+void
+image_cache_store (const gchar *url, const gchar *data, gsize size, const gchar *contentType)
+{
+	if (!misses || !g_hash_table_remove (misses, url))
+		return;
+
+	image_cache_save (url, data, size, contentType);
+}
+
+void
+image_cache_prefetch_html (const gchar *html, const gchar *baseUrl)
+{
+	const gchar	*pos = html, *valueStart, *valueEnd;
+	gchar		*value, *url, *filename;
+
+	if (!html)
+		return;
+
+	while (NULL != (pos = image_cache_find_img_src (pos, &valueStart, &valueEnd))) {
+		value = image_cache_decode_attribute (valueStart, valueEnd - valueStart);
+		if (!value)
+			continue;
+
+		url = (gchar *)common_build_url (value, baseUrl);
+		if (url && (g_str_has_prefix (url, "http://") || g_str_has_prefix (url, "https://"))) {
+			filename = image_cache_get_filename (url);
+			if (!g_file_test (filename, G_FILE_TEST_IS_REGULAR))
+				image_cache_fetch (url);
+			g_free (filename);
+		}
+
+		xmlFree (url);
+		g_free (value);
+	}
+}
@@ -0,0 +1,82 @@
+/**
+ * @file image_cache.h  local cache for item images
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _IMAGE_CACHE_H
+#define _IMAGE_CACHE_H
+
+#include <glib.h>
+
+/** URI scheme of cached images in rendered items */
+#define IMAGE_CACHE_SCHEME	"liferea-cache:///"
+
+/**
+ * Initializes the image cache and drops outdated images.
+ */
+void image_cache_init (void);
+
+/**
+ * Frees the image cache structures. Pending downloads are
+ * cancelled by update_deinit().
+ */
+void image_cache_deinit (void);
+
+/**
+ * Rewrites the sources of all <img> tags with absolute HTTP URLs
+ * to the image cache URI scheme.
+ *
+ * @param html		the rendered HTML
+ *
+ * @returns new HTML (to be free'd using g_free)
+ */
+gchar * image_cache_rewrite_html (const gchar *html);
+
+/**
+ * Resolves an image cache URI for loading. If the image is cached
+ * this is a file:// URI, otherwise the original URL. Only HTTP and
+ * HTTPS URLs are resolved.
+ *
+ * @param uri		an URI with the image cache scheme
+ *
+ * @returns the URI to load (to be free'd using g_free) or NULL if
+ * the URI is invalid
+ */
+gchar * image_cache_resolve_uri (const gchar *uri);
+
+/**
+ * Stores an image the HTML widget loaded after a cache miss,
+ * so it is not downloaded a second time. Data of URLs not
+ * resolved by image_cache_resolve_uri() is ignored.
+ *
+ * @param url		the original URL returned on the cache miss
+ * @param data		the image data (or NULL if loading failed)
+ * @param size		size of the image data
+ * @param contentType	the MIME type (or NULL)
+ */
+void image_cache_store (const gchar *url, const gchar *data, gsize size, const gchar *contentType);
+
+/**
+ * Downloads all images of an item description not yet cached.
+ *
+ * @param html		the item description
+ * @param baseUrl	base URL for relative image URLs (or NULL)
+ */
+void image_cache_prefetch_html (const gchar *html, const gchar *baseUrl);
+
+#endif
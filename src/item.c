@@ -199,7 +199,6 @@ item_to_xml (itemPtr item, gpointer xmlNode)
 	xmlNodePtr	duplicatesNode;		
 	xmlNodePtr	itemNode;
 	gchar		*tmp;
-	gchar		*tmp2;
 	
 	itemNode = xmlNewChild (parentNode, NULL, "item", NULL);
 	g_return_if_fail (itemNode);
@@ -207,11 +206,9 @@ item_to_xml (itemPtr item, gpointer xmlNode)
 	xmlNewTextChild (itemNode, NULL, "title", item_get_title (item)?item_get_title (item):"");
 
 	if (item_get_description (item)) {
-		tmp = xhtml_strip_dhtml (item_get_description (item));
-		tmp2 = xhtml_strip_unsupported_tags (tmp);
-		xmlNewTextChild (itemNode, NULL, "description", tmp2);
+		tmp = xhtml_strip (item_get_description (item), XHTML_STRIP_DHTML | XHTML_STRIP_UNSUPPORTED);
+		xmlNewTextChild (itemNode, NULL, "description", tmp);
 		g_free (tmp);
-		g_free (tmp2);
 	}
 	
 	if (item_get_source (item))
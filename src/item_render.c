@@ -0,0 +1,644 @@
+/**
+ * @file item_render.c  item XHTML rendering
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "item_render.h"
+
+#include <locale.h>
+#include <string.h>
+#include <libxml/tree.h>
+#include <libxml/parserInternals.h>
+
+#include "comments.h"
+#include "common.h"
+#include "conf.h"
+#include "date.h"
+#include "db.h"
+#include "feed.h"
+#include "image_cache.h"
+#include "metadata.h"
+#include "render.h"
+#include "subscription.h"
+#include "xml.h"
+
+/* The native renderer is a C version of the "item" stylesheet
+   (xslt/item.xml). It creates the same result tree the stylesheet
+   would create, but directly from the item instead of from an XML
+   serialization of it, and uses the same libxml2 serializer. This
+   skips building the input document, the XPath evaluation of the
+   stylesheet and the extraction of the <body> from the output.
+
+   Whenever the stylesheet is changed this code has to follow! */
+
+gchar *
+item_render_xslt (itemPtr item, nodePtr node, itemRenderParamsPtr params)
+{
+	renderParamPtr	xsltParams;
+	gchar		*output;
+	xmlDocPtr 	doc;
+	xmlNodePtr 	xmlNode;
+
+	/* do the XML serialization */
+	doc = xmlNewDoc ("1.0");
+	xmlNode = xmlNewDocNode (doc, NULL, "itemset", NULL);
+	xmlDocSetRootElement (doc, xmlNode);
+
+	item_to_xml (item, xmlDocGetRootElement (doc));
+
+	if (node && IS_FEED (node)) {
+		xmlNodePtr feed;
+		feed = xmlNewChild (xmlDocGetRootElement (doc), NULL, "feed", NULL);
+		feed_to_xml (node, feed);
+	}
+
+	/* do the XSLT rendering */
+	xsltParams = render_parameter_new ();
+
+	if (params->baseUrl)
+		render_parameter_add (xsltParams, "baseUrl='%s'", params->baseUrl);
+
+	render_parameter_add (xsltParams, "summary='%d'", params->summary?1:0);
+	render_parameter_add (xsltParams, "showFeedName='%d'", params->showFeedName?1:0);
+	render_parameter_add (xsltParams, "single='%d'", params->single?1:0);
+	render_parameter_add (xsltParams, "txtDirection='%s'", params->txtDirection);
+	render_parameter_add (xsltParams, "appDirection='%s'", params->appDirection);
+	output = render_xml (doc, "item", xsltParams);
+
+	/* For debugging use: xmlSaveFormatFile("/tmp/test.xml", doc, 1); */
+	xmlFreeDoc (doc);
+
+	return output;
+}
+
+/* native rendering helpers, empty strings create no text node just like <xsl:value-of> */
+
+static xmlNodePtr
+item_render_element (xmlNodePtr parent, const gchar *name)
+{
+	return xmlNewChild (parent, NULL, name, NULL);
+}
+
+static void
+item_render_attribute (xmlNodePtr node, const gchar *name, const gchar *value)
+{
+	xmlNewProp (node, name, value?value:"");
+}
+
+static void
+item_render_text (xmlNodePtr node, const gchar *text)
+{
+	if (text && *text)
+		xmlAddChild (node, xmlNewText (text));
+}
+
+/* like <xsl:value-of disable-output-escaping="yes"> */
+static void
+item_render_html (xmlNodePtr node, const gchar *html)
+{
+	xmlNodePtr	text;
+
+	if (!html || !*html)
+		return;
+
+	text = xmlNewText (html);
+	text->name = xmlStringTextNoenc;
+	xmlAddChild (node, text);
+}
+
+static void
+item_render_label (xmlNodePtr parent, const gchar *label)
+{
+	item_render_text (item_render_element (parent, "span"), label);
+}
+
+static xmlNodePtr
+item_render_table (xmlNodePtr parent, const gchar *class, const gchar *dir)
+{
+	xmlNodePtr table = item_render_element (parent, "table");
+
+	if (class)
+		item_render_attribute (table, "class", class);
+	item_render_attribute (table, "cellspacing", "0");
+	item_render_attribute (table, "cellpadding", "0");
+	if (dir)
+		item_render_attribute (table, "dir", dir);
+
+	return table;
+}
+
+/* Adds a header metadata row and returns the value <span> */
+static xmlNodePtr
+item_render_meta_row (xmlNodePtr table, const gchar *class, const gchar *label)
+{
+	xmlNodePtr	td, span;
+
+	td = item_render_element (item_render_element (table, "tr"), "td");
+	item_render_attribute (td, "valign", "top");
+	item_render_attribute (td, "class", class);
+	item_render_label (td, label);
+
+	span = item_render_element (item_render_element (td, "b"), "span");
+	item_render_attribute (span, "class", class);
+
+	return span;
+}
+
+static void
+item_render_meta_link (xmlNodePtr table, const gchar *class, const gchar *label, const gchar *href, const gchar *text)
+{
+	xmlNodePtr a = item_render_element (item_render_meta_row (table, class, label), "a");
+
+	item_render_attribute (a, "href", href);
+	item_render_text (a, text);
+}
+
+static const gchar *mapScript =
+	"\n\t\t  var map;\n"
+	"        \t  function load() {\n"
+	"\t\t\tmap = new OpenLayers.Map(\"mapdiv\");\n"
+	"\t\t\tmap.addLayer(new OpenLayers.Layer.OSM());\n"
+	"\t\t\tvar lonLat = new OpenLayers.LonLat(lon,lat)\n"
+	"\t\t\t.transform(\n"
+	"\t\t\t\tnew OpenLayers.Projection(\"EPSG:4326\"), // transform from WGS 1984\n"
+	"\t\t\t\tmap.getProjectionObject() // to Spherical Mercator Projection\n"
+	"\t\t\t);\n"
+	"\t\t\tvar markers = new OpenLayers.Layer.Markers(\"Markers\");\n"
+	"\t\t\tmap.addLayer(markers);\n"
+	"\t\t\tmarkers.addMarker(new OpenLayers.Marker(lonLat));\n"
+	"\t\t\tmap.setCenter (lonLat, zoom);\n"
+	"        \t  }\n"
+	"\t";
+
+/* GeoRSS OpenStreet map, the stylesheet has two slightly different copies */
+static void
+item_render_map (xmlNodePtr parent, const gchar *point, gboolean inContent)
+{
+	xmlNodePtr	script;
+	const gchar	*space = strchr (point, ' ');
+	gchar		*lat, *code;
+
+	lat = space ? g_strndup (point, space - point) : g_strdup ("");
+
+	script = item_render_element (parent, "script");
+	item_render_attribute (script, "src", "http://www.openlayers.org/api/OpenLayers.js");
+
+	script = item_render_element (parent, "script");
+	item_render_attribute (script, "type", "text/javascript");
+	code = g_strdup_printf ("\n\t\t  var lat=%s\n\t\t  var lon=%s\n\t\t  var zoom=9\n%s%s%s",
+	                        lat, space ? space + 1 : "",
+	                        inContent ? "" : "\n", mapScript, inContent ? "  " : "");
+	item_render_text (script, code);
+
+	g_free (code);
+	g_free (lat);
+}
+
+static gint
+item_render_comment_compare (gconstpointer a, gconstpointer b)
+{
+	gchar	timeA[32], timeB[32];
+
+	/* <xsl:sort select="time"/> compares as text */
+	g_snprintf (timeA, sizeof (timeA), "%ld", ((itemPtr)a)->time);
+	g_snprintf (timeB, sizeof (timeB), "%ld", ((itemPtr)b)->time);
+
+	return strcmp (timeA, timeB);
+}
+
+static void
+item_render_comments (xmlNodePtr content, itemPtr item)
+{
+	const gchar	*error = NULL;
+	gboolean	updating = FALSE;
+	GList		*comments = NULL, *iter;
+	xmlNodePtr	p, div, body;
+
+	if (item->commentFeedId && comments_get_state (item->commentFeedId, &updating, &error)) {
+		itemSetPtr itemSet = db_itemset_load (item->commentFeedId);
+
+		for (iter = itemSet->ids; iter; iter = g_list_next (iter)) {
+			itemPtr comment = item_load (GPOINTER_TO_UINT (iter->data));
+			if (comment)
+				comments = g_list_prepend (comments, comment);
+		}
+		comments = g_list_sort (g_list_reverse (comments), item_render_comment_compare);
+		itemset_free (itemSet);
+	}
+
+	p = item_render_element (content, "p");
+	if (comments)
+		item_render_label (item_render_element (p, "b"), _("Comments"));
+	if (updating) {
+		item_render_text (p, "\n           (");
+		item_render_label (item_render_element (p, "span"), _("Updating..."));
+		item_render_text (p, ")\n\t");
+	}
+
+	if (error) {
+		div = item_render_element (item_render_element (content, "p"), "div");
+		item_render_attribute (div, "id", "errors");
+		div = item_render_element (div, "div");
+		item_render_attribute (div, "id", "updateError");
+		item_render_text (div, error);
+	}
+
+	p = item_render_element (content, "p");
+	for (iter = comments; iter; iter = g_list_next (iter)) {
+		itemPtr	comment = (itemPtr)iter->data;
+		gchar	*description = NULL;
+
+		if (item_get_description (comment))
+			description = xhtml_strip (item_get_description (comment), XHTML_STRIP_DHTML | XHTML_STRIP_UNSUPPORTED);
+
+		div = item_render_element (p, "div");
+		item_render_attribute (div, "class", "comment");
+		body = item_render_element (div, "div");
+		item_render_attribute (body, "class", "comment_title");
+		item_render_text (body, item_get_title (comment));
+
+		body = item_render_element (div, "div");
+		item_render_attribute (body, "class", "comment_body");
+		item_render_html (body, description);
+
+		g_free (description);
+		item_unload (comment);
+	}
+	g_list_free (comments);
+}
+
+static void
+item_render_summary (xmlNodePtr parent, itemPtr item, const gchar *title, const gchar *description, const gchar *timestr)
+{
+	xmlNodePtr	div, table, tr, td, a;
+
+	div = item_render_element (parent, "div");
+	item_render_attribute (div, "class", item->readStatus?"summaryunshaded":"summaryshaded");
+
+	table = item_render_table (div, NULL, NULL);
+	item_render_attribute (table, "width", "100%");
+	tr = item_render_element (table, "tr");
+
+	td = item_render_element (tr, "td");
+	item_render_attribute (td, "class", "summarytime");
+	item_render_attribute (td, "valign", "top");
+	item_render_text (td, timestr);
+
+	td = item_render_element (tr, "td");
+	item_render_attribute (td, "width", "100%");
+	a = item_render_element (td, "a");
+	item_render_attribute (a, "href", item_get_source (item));
+	item_render_text (a, title);
+
+	if (description) {
+		item_render_element (td, "br");
+		item_render_element (td, "br");
+		item_render_html (td, description);
+	}
+
+	item_render_attribute (item_render_element (div, "hr"), "class", "summary");
+}
+
+gchar *
+item_render_native (itemPtr item, nodePtr node, itemRenderParamsPtr params)
+{
+	xmlDocPtr		doc;
+	xmlNodePtr		body, top, outer, inner, table, tr, td, a, span, shading, content, p;
+	xmlOutputBufferPtr	buf;
+	GSList			*iter;
+	const gchar		*title, *point, *feedSource = NULL, *feedTitle = NULL, *homepage = NULL;
+	gchar			*description = NULL, *timestr, *favicon = NULL, *tmp, *output = NULL;
+	nodePtr			feedNode;
+	gboolean		commentsSuppressed = FALSE;
+
+	/* collect what the stylesheet takes from the item and feed XML */
+	title = item_get_title (item)?item_get_title (item):"";
+	if (item_get_description (item))
+		description = xhtml_strip (item_get_description (item), XHTML_STRIP_DHTML | XHTML_STRIP_UNSUPPORTED);
+	timestr = date_format (item->time, NULL);
+	point = metadata_list_get (item->metadata, "point");
+
+	if (node && IS_FEED (node)) {
+		feedTitle = node_get_title (node);
+		favicon = g_strdup_printf ("file://%s", node_get_favicon_file (node));
+		if (node->subscription) {
+			feedSource = subscription_get_source (node->subscription);
+			homepage = metadata_list_get (node->subscription->metadata, "homepage");
+		}
+	}
+
+	feedNode = node_from_id (item->parentNodeId);
+	if (feedNode && feedNode->data)
+		commentsSuppressed = ((feedPtr)feedNode->data)->ignoreComments;
+
+	/* <html> is needed as the serializer indents <body> as its child */
+	doc = xmlNewDoc ("1.0");
+	xmlDocSetRootElement (doc, xmlNewDocNode (doc, NULL, "html", NULL));
+	body = item_render_element (xmlDocGetRootElement (doc), "body");
+	if (point)
+		item_render_attribute (body, "onload", "load()");
+
+	top = item_render_element (body, "div");
+	item_render_attribute (top, "href", params->baseUrl);
+
+	if (params->summary) {
+		item_render_summary (top, item, title, description, timestr);
+		goto serialize;
+	}
+
+	outer = item_render_element (top, "div");
+	item_render_attribute (outer, "href", feedSource);
+
+	inner = item_render_element (outer, "div");
+	tmp = g_strdup_printf ("doShow('%s-%ld');", item->nodeId?item->nodeId:"", item->id);
+	item_render_attribute (inner, "onmouseover", tmp);
+	item_render_attribute (inner, "onmouseout", "stopShow();");
+	g_free (tmp);
+
+	/* header table */
+	table = item_render_table (inner, "itemhead", params->txtDirection);
+	tr = item_render_element (table, "tr");
+
+	td = item_render_element (tr, "td");
+	item_render_attribute (td, "valign", "middle");
+	item_render_attribute (td, "class", "headleft");
+	a = item_render_element (td, "a");
+	item_render_attribute (a, "class", "favicon");
+	item_render_attribute (a, "href", homepage);
+	item_render_attribute (item_render_element (a, "img"), "src", favicon);
+
+	td = item_render_element (tr, "td");
+	item_render_attribute (td, "width", "100%");
+	item_render_attribute (td, "valign", "middle");
+	item_render_attribute (td, "class", "headright");
+	a = item_render_element (td, "a");
+	item_render_attribute (a, "class", "itemhead");
+	item_render_attribute (a, "href", item_get_source (item));
+	item_render_text (a, *title?title:timestr);
+
+	/* header metadata */
+	table = item_render_table (inner, "headmeta", params->appDirection);
+
+	iter = metadata_list_get_values (item->metadata, "slash");
+	if (iter) {
+		td = item_render_element (item_render_element (table, "tr"), "td");
+		item_render_attribute (td, "valign", "top");
+		item_render_attribute (td, "class", "slash");
+	}
+	for (; iter; iter = g_slist_next (iter)) {
+		const gchar	*value = (const gchar *)iter->data;
+		const gchar	*comma = strchr (value, ',');
+
+		span = item_render_element (td, "span");
+		item_render_attribute (span, "class", "slashSection");
+		item_render_label (span, _("Section"));
+
+		span = item_render_element (td, "span");
+		item_render_attribute (span, "class", "slashValue");
+		tmp = comma ? g_strndup (value, comma - value) : NULL;
+		item_render_text (span, tmp);
+		g_free (tmp);
+
+		span = item_render_element (td, "span");
+		item_render_attribute (span, "class", "slashDepartment");
+		item_render_label (span, _("Department"));
+
+		span = item_render_element (td, "span");
+		item_render_attribute (span, "class", "slashValue");
+		item_render_text (span, comma ? comma + 1 : NULL);
+	}
+
+	if (metadata_list_get (item->metadata, "realSourceUrl"))
+		item_render_meta_link (table, "source", _("Source"),
+		                       metadata_list_get (item->metadata, "realSourceUrl"),
+		                       metadata_list_get (item->metadata, "realSourceTitle"));
+
+	if (params->showFeedName)
+		item_render_meta_link (table, "source", _("Feed"), homepage, feedTitle);
+
+	iter = metadata_list_get_values (item->metadata, "category");
+	if (iter) {
+		span = item_render_meta_row (table, "categories", _("Filed under"));
+		for (; iter; iter = g_slist_next (iter)) {
+			if (iter != metadata_list_get_values (item->metadata, "category"))
+				item_render_text (span, ", ");
+			item_render_html (span, (const gchar *)iter->data);
+		}
+	}
+
+	if (metadata_list_get (item->metadata, "author"))
+		item_render_html (item_render_meta_row (table, "author", _("Author")), metadata_list_get (item->metadata, "author"));
+
+	if (metadata_list_get (item->metadata, "sharedby"))
+		item_render_html (item_render_meta_row (table, "sharedby", _("Shared by")), metadata_list_get (item->metadata, "sharedby"));
+
+	for (iter = metadata_list_get_values (item->metadata, "via"); iter; iter = g_slist_next (iter))
+		item_render_meta_link (table, "source", _("Via"), iter->data, iter->data);
+
+	for (iter = metadata_list_get_values (item->metadata, "related"); iter; iter = g_slist_next (iter))
+		item_render_meta_link (table, "source", _("Related"), iter->data, iter->data);
+
+	if (item->validGuid) {
+		GSList *duplicates = db_item_get_duplicates (item->sourceId);
+
+		for (iter = duplicates; iter; iter = g_slist_next (iter)) {
+			itemPtr duplicate = item_load (GPOINTER_TO_UINT (iter->data));
+			if (duplicate) {
+				nodePtr duplicateNode = node_from_id (duplicate->nodeId);
+				if (duplicateNode && (item->id != duplicate->id))
+					item_render_text (item_render_meta_row (table, "source", _("Also posted in")),
+					                  node_get_title (duplicateNode));
+				item_unload (duplicate);
+			}
+		}
+		g_slist_free (duplicates);
+	}
+
+	if (metadata_list_get (item->metadata, "creator"))
+		item_render_html (item_render_meta_row (table, "creator", _("Creator")), metadata_list_get (item->metadata, "creator"));
+
+	/* content */
+	shading = item_render_element (inner, "div");
+	item_render_attribute (shading, "id", "shading");
+	item_render_attribute (shading, "class", params->single?"":(item->readStatus?"itemunshaded":"itemshaded"));
+
+	content = item_render_element (shading, "div");
+	item_render_attribute (content, "class", "content");
+
+	if (point) {
+		p = item_render_element (content, "p");
+		item_render_attribute (p, "id", "mapdiv");
+		item_render_attribute (p, "style", "width:400px;height:200px;float:right; border: 1px solid #000;");
+		item_render_map (content, point, TRUE);
+	}
+
+	p = item_render_element (content, "p");
+	item_render_attribute (p, "dir", params->txtDirection);
+	if (metadata_list_get (item->metadata, "gravatar")) {
+		xmlNodePtr img = item_render_element (p, "img");
+		item_render_attribute (img, "align", "left");
+		item_render_attribute (img, "class", "gravatar");
+		item_render_attribute (img, "src", metadata_list_get (item->metadata, "gravatar"));
+	}
+	item_render_html (p, description);
+
+	if (metadata_list_get (item->metadata, "photo")) {
+		const gchar *comma = strrchr (metadata_list_get (item->metadata, "photo"), ',');
+		item_render_attribute (item_render_element (content, "img"), "src", comma ? comma + 1 : NULL);
+	}
+
+	if (metadata_list_get (item->metadata, "commentFeedUri") && !commentsSuppressed && params->single)
+		item_render_comments (content, item);
+
+	if (point)
+		item_render_map (top, point, FALSE);
+
+serialize:
+	buf = xmlAllocOutputBuffer (NULL);
+	xmlNodeDumpOutput (buf, doc, body, 1, 1, NULL);
+	xmlOutputBufferFlush (buf);
+
+#ifdef LIBXML2_NEW_BUFFER
+	if (xmlOutputBufferGetSize (buf) > 0)
+		output = g_strdup (xmlOutputBufferGetContent (buf));
+#else
+	if (xmlBufferLength (buf->buffer) > 0)
+		output = g_strdup (xmlBufferContent (buf->buffer));
+#endif
+
+	xmlOutputBufferClose (buf);
+	xmlFreeDoc (doc);
+	g_free (description);
+	g_free (timestr);
+	g_free (favicon);
+
+	return output;
+}
+
+static void
+item_render_digest_add (GChecksum *checksum, const gchar *value)
+{
+	/* include the terminating zero so adjacent fields cannot run together */
+	g_checksum_update (checksum, value?value:"", value?strlen (value) + 1:1);
+}
+
+static void
+item_render_digest_add_metadata (const gchar *key, const gchar *value, guint index, gpointer user_data)
+{
+	item_render_digest_add ((GChecksum *)user_data, key);
+	item_render_digest_add ((GChecksum *)user_data, value);
+}
+
+gchar *
+item_render_get_digest (itemPtr item, nodePtr node, itemRenderParamsPtr params)
+{
+	GChecksum	*checksum;
+	gboolean	native, imageCache;
+	gchar		*tmp, *digest;
+
+	if (params->single)
+		return NULL;
+
+	conf_get_bool_value (NATIVE_ITEM_RENDERER, &native);
+	conf_get_bool_value (IMAGE_CACHE, &imageCache);
+
+	checksum = g_checksum_new (G_CHECKSUM_MD5);
+
+	/* renderer and stylesheet version */
+	item_render_digest_add (checksum, VERSION);
+	item_render_digest_add (checksum, native?"native":"xslt");
+	item_render_digest_add (checksum, imageCache?"image-cache":NULL);
+	tmp = g_strdup_printf ("%ld", (glong)render_get_stylesheet_mtime ("item"));
+	item_render_digest_add (checksum, tmp);
+	g_free (tmp);
+	item_render_digest_add (checksum, setlocale (LC_MESSAGES, NULL));
+
+	/* rendering options */
+	tmp = g_strdup_printf ("%d%d%d", params->summary?1:0, params->showFeedName?1:0, params->single?1:0);
+	item_render_digest_add (checksum, tmp);
+	g_free (tmp);
+	item_render_digest_add (checksum, params->baseUrl);
+	item_render_digest_add (checksum, params->txtDirection);
+	item_render_digest_add (checksum, params->appDirection);
+
+	/* item, the formatted date as it might be relative to today */
+	tmp = g_strdup_printf ("%ld%d", item->id, item->readStatus?1:0);
+	item_render_digest_add (checksum, tmp);
+	g_free (tmp);
+	item_render_digest_add (checksum, item->nodeId);
+	item_render_digest_add (checksum, item_get_title (item));
+	item_render_digest_add (checksum, item_get_description (item));
+	item_render_digest_add (checksum, item_get_source (item));
+	tmp = date_format (item->time, NULL);
+	item_render_digest_add (checksum, tmp);
+	g_free (tmp);
+	metadata_list_foreach (item->metadata, item_render_digest_add_metadata, checksum);
+
+	/* the "Also posted in" list changes when duplicates are merged or removed */
+	if (item->validGuid) {
+		GSList	*duplicates, *iter;
+
+		duplicates = db_item_get_duplicate_nodes (item->sourceId);
+
+		for (iter = duplicates; iter; iter = g_slist_next (iter)) {
+			nodePtr duplicateNode = node_from_id ((gchar *)iter->data);
+
+			item_render_digest_add (checksum, (gchar *)iter->data);
+			item_render_digest_add (checksum, duplicateNode?node_get_title (duplicateNode):NULL);
+		}
+		g_slist_free_full (duplicates, g_free);
+	}
+
+	/* feed */
+	if (node && IS_FEED (node)) {
+		item_render_digest_add (checksum, node_get_title (node));
+		item_render_digest_add (checksum, node_get_favicon_file (node));
+		if (node->subscription) {
+			item_render_digest_add (checksum, subscription_get_source (node->subscription));
+			item_render_digest_add (checksum, metadata_list_get (node->subscription->metadata, "homepage"));
+		}
+	}
+
+	digest = g_strdup (g_checksum_get_string (checksum));
+	g_checksum_free (checksum);
+
+	return digest;
+}
+
+gchar *
+item_render (itemPtr item, nodePtr node, itemRenderParamsPtr params)
+{
+	gboolean	native, imageCache;
+	gchar		*output, *tmp;
+
+	conf_get_bool_value (NATIVE_ITEM_RENDERER, &native);
+	conf_get_bool_value (IMAGE_CACHE, &imageCache);
+
+	if (native)
+		output = item_render_native (item, node, params);
+	else
+		output = item_render_xslt (item, node, params);
+
+	if (output && imageCache) {
+		tmp = output;
+		output = image_cache_rewrite_html (tmp);
+		g_free (tmp);
+	}
+
+	return output;
+}
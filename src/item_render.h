@@ -0,0 +1,96 @@
+/**
+ * @file item_render.h  item XHTML rendering
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _ITEM_RENDER_H
+#define _ITEM_RENDER_H
+
+#include <glib.h>
+
+#include "item.h"
+#include "node.h"
+
+/** item rendering options (the parameters of the "item" stylesheet) */
+typedef struct itemRenderParams {
+	const gchar	*baseUrl;	/**< escaped base URL of the item set (or NULL) */
+	gboolean	summary;	/**< TRUE for summary rendering */
+	gboolean	showFeedName;	/**< TRUE if the feed title is to be shown (merged item sets) */
+	gboolean	single;		/**< TRUE if only the selected item is shown (3 pane mode) */
+	const gchar	*txtDirection;	/**< item text direction, "ltr" or "rtl" */
+	const gchar	*appDirection;	/**< application text direction, "ltr" or "rtl" */
+} *itemRenderParamsPtr;
+
+/**
+ * Renders an item with the renderer selected in the preferences.
+ *
+ * @param item		the item to render
+ * @param node		the node the item belongs to
+ * @param params	rendering options
+ *
+ * @returns the XHTML <body> element (to be free'd using g_free)
+ */
+gchar * item_render (itemPtr item, nodePtr node, itemRenderParamsPtr params);
+
+/**
+ * Renders an item by serializing it to XML and applying the
+ * "item" XSLT stylesheet. Slow, but respects a customized
+ * stylesheet.
+ *
+ * @param item		the item to render
+ * @param node		the node the item belongs to
+ * @param params	rendering options
+ *
+ * @returns the XHTML <body> element (to be free'd using g_free)
+ */
+gchar * item_render_xslt (itemPtr item, nodePtr node, itemRenderParamsPtr params);
+
+/**
+ * Renders an item by building the result of the "item" stylesheet
+ * directly from the item fields and metadata. The output is identical
+ * to item_render_xslt() with the stylesheet shipped by Liferea (for
+ * translated labels only the xml:lang attribute is missing).
+ *
+ * @param item		the item to render
+ * @param node		the node the item belongs to
+ * @param params	rendering options
+ *
+ * @returns the XHTML <body> element (to be free'd using g_free)
+ */
+gchar * item_render_native (itemPtr item, nodePtr node, itemRenderParamsPtr params);
+
+/**
+ * Returns a digest of everything the rendering of an item depends on:
+ * the item and feed fields, the rendering options, the selected
+ * renderer, the stylesheet version and the locale. Two renderings
+ * with the same digest produce the same HTML, so it can be used as
+ * a cache key.
+ *
+ * Single item renderings include the comments which have their own
+ * update state, so they are never cacheable.
+ *
+ * @param item		the item to render
+ * @param node		the node the item belongs to
+ * @param params	rendering options
+ *
+ * @returns a digest (to be free'd using g_free) or NULL if the
+ * rendering must not be cached
+ */
+gchar * item_render_get_digest (itemPtr item, nodePtr node, itemRenderParamsPtr params);
+
+#endif
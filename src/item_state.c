@@ -21,6 +21,7 @@
 #include "db.h"
 #include "debug.h"
 #include "feedlist.h"
+#include "folder.h"
 #include "item.h"
 #include "item_state.h"
 #include "itemset.h"
@@ -28,6 +29,7 @@
 #include "node.h"
 #include "vfolder.h"
 #include "fl_sources/node_source.h"
+#include "ui/itemview.h"
 
 static void
 item_state_set_recount_flag (nodePtr node)
@@ -63,6 +65,60 @@ item_flag_state_changed (itemPtr item, gboolean newState)
 	   in the "Important" search folder */
 }
 
+/* Applies a read state change to all duplicates of an item with one DB
+   update instead of running the complete state change for each of them.
+   Duplicates are only loaded when they need more than that: remote
+   sync, a search folder depending on the read state or a GUI update. */
+static void
+item_state_propagate_read (itemPtr item, gboolean newState)
+{
+	GSList		*ids, *nodeIds, *iter;
+	gboolean	remote = FALSE, searchFolders;
+
+	ids = db_item_duplicates_set_read_state (item->sourceId, item->id, newState, &nodeIds);
+
+	for (iter = nodeIds; iter; iter = g_slist_next (iter)) {
+		nodePtr node = node_is_used_id ((gchar *)iter->data);
+		if (node) {
+			node_update_counters (node);
+			if (NODE_SOURCE_TYPE (node)->item_mark_read)
+				remote = TRUE;
+		}
+		g_free (iter->data);
+	}
+	g_slist_free (nodeIds);
+
+	searchFolders = vfolder_any_with_rule ("unread");
+
+	for (iter = ids; iter; iter = g_slist_next (iter)) {
+		gulong	id = GPOINTER_TO_UINT (iter->data);
+		itemPtr	duplicate;
+		nodePtr	node;
+
+		if (!remote && !searchFolders && !itemview_contains_id (id))
+			continue;
+
+		duplicate = item_load (id);
+		if (!duplicate)
+			continue;
+
+		node = node_is_used_id (duplicate->nodeId);
+		if (node && NODE_SOURCE_TYPE (node)->item_mark_read) {
+			/* runs the complete state change, which finds
+			   no further duplicates to propagate to */
+			NODE_SOURCE_TYPE (node)->item_mark_read (node, duplicate, newState);
+		} else {
+			if (searchFolders)
+				db_item_state_update (duplicate);
+			itemlist_update_item (duplicate);
+		}
+
+		item_unload (duplicate);
+	}
+
+	g_slist_free (ids);
+}
+
 void
 item_set_read_state (itemPtr item, gboolean newState) 
 {
@@ -102,28 +158,138 @@ item_read_state_changed (itemPtr item, gboolean newState)
 	node_update_counters (node);
 
 	/* 6. duplicate state propagation */
-	if (item->validGuid) {
-		GSList *duplicates, *iter;
-
-		duplicates = iter = db_item_get_duplicates (item->sourceId);
-		while (iter) {
-			itemPtr duplicate = item_load (GPOINTER_TO_UINT (iter->data));
-
-			/* The check on node_from_id() is an evil workaround
-			   to handle "lost" items in the DB that have no 
-			   associated node in the feed list. This should be 
-			   fixed by having the feed list in the DB too, so
-			   we can clean up correctly after crashes. */
-			if (duplicate && duplicate->id != item->id && node_from_id (duplicate->nodeId)) {
-				item_set_read_state (duplicate, newState);
-			}
-			if (duplicate) item_unload (duplicate);
-			iter = g_slist_next (iter);
+	if (item->validGuid)
+		item_state_propagate_read (item, newState);
+
+	debug_end_measurement (DEBUG_GUI, "set read status");
+}
+
+GSList *
+item_state_remote_prepend (GSList *states, const gchar *sourceId, gboolean read, gint flag)
+{
+	itemRemoteStatePtr state = g_new0 (struct itemRemoteState, 1);
+
+	state->sourceId = g_strdup (sourceId);
+	state->read = read;
+	state->flag = (flag < 0)?-1:(flag?1:0);
+
+	return g_slist_prepend (states, state);
+}
+
+void
+item_state_reconcile (nodePtr node, GSList *states)
+{
+	GSList	*changes, *iter;
+
+	debug_start_measurement (DEBUG_GUI);
+
+	changes = db_itemset_get_state_changes (node->id, states);
+	for (iter = changes; iter; iter = g_slist_next (iter)) {
+		itemRemoteStatePtr state = (itemRemoteStatePtr)iter->data;
+		itemPtr item = item_load (state->itemId);
+
+		if (!item)
+			continue;
+
+		if (item->readStatus != state->read)
+			item_read_state_changed (item, state->read);
+		if (state->flag >= 0 && item->flagStatus != state->flag)
+			item_flag_state_changed (item, state->flag);
+
+		item_unload (item);
+	}
+
+	debug1 (DEBUG_UPDATE, "reconciled %d remote item states, %d changed", g_slist_length (states), g_slist_length (changes));
+	g_slist_free (changes);
+
+	for (iter = states; iter; iter = g_slist_next (iter)) {
+		itemRemoteStatePtr state = (itemRemoteStatePtr)iter->data;
+		g_free (state->sourceId);
+		g_free (state);
+	}
+	g_slist_free (states);
+
+	debug_end_measurement (DEBUG_GUI, "reconcile remote item states");
+}
+
+/* Re-evaluates search folder membership of items whose read state
+   was changed in bulk. Only needed when a search folder filters on
+   the read state, all other rules are not affected. */
+static void
+item_state_search_folders_update (GList *ids)
+{
+	GList	*iter;
+
+	for (iter = ids; iter; iter = g_list_next (iter)) {
+		itemPtr item = item_load (GPOINTER_TO_UINT (iter->data));
+		if (item) {
+			db_item_state_update (item);
+			item_unload (item);
 		}
-		g_slist_free (duplicates);
 	}
+}
 
-	debug_end_measurement (DEBUG_GUI, "set read status");
+/* Marks all items of a feed read with one DB update and one duplicate
+   propagation statement instead of loading and saving every item. */
+/* Returns TRUE if items of the node are in the displayed item list */
+static gboolean
+item_state_node_is_displayed (nodePtr node)
+{
+	nodePtr displayed = itemlist_get_displayed_node ();
+
+	return displayed && (displayed == node || IS_VFOLDER (displayed) || node_is_ancestor (displayed, node));
+}
+
+static void
+itemset_mark_read_bulk (nodePtr node)
+{
+	GList		*ids, *duplicates, *iter;
+	gboolean	displayed;
+
+	debug_start_measurement (DEBUG_GUI);
+
+	ids = db_itemset_mark_all_read (node->id, &duplicates);
+	item_state_set_recount_flag (node);
+	displayed = (NULL != ids) && item_state_node_is_displayed (node);
+
+	if (NODE_SOURCE_TYPE (node)->item_mark_all_read)
+		NODE_SOURCE_TYPE (node)->item_mark_all_read (node);
+
+	/* Duplicates are already read in the DB, but their nodes need
+	   a recount and remote sources still have to be told */
+	for (iter = duplicates; iter; iter = g_list_next (iter)) {
+		itemPtr duplicate = item_load (GPOINTER_TO_UINT (iter->data));
+		if (!duplicate)
+			continue;
+
+		nodePtr affectedNode = node_from_id (duplicate->nodeId);
+		if (affectedNode) {
+			item_state_set_recount_flag (affectedNode);
+			displayed |= item_state_node_is_displayed (affectedNode);
+			if (NODE_SOURCE_TYPE (affectedNode)->item_mark_read)
+				NODE_SOURCE_TYPE (affectedNode)->item_mark_read (affectedNode, duplicate, TRUE);
+		}
+		item_unload (duplicate);
+	}
+
+	if (vfolder_any_with_rule ("unread")) {
+		item_state_search_folders_update (ids);
+		item_state_search_folders_update (duplicates);
+	}
+	vfolder_foreach (item_state_set_recount_flag);
+
+	/* The items were not loaded, so the item list and the
+	   HTML view do not know yet and are refreshed once */
+	if (displayed) {
+		itemview_update_all_items ();
+		itemview_update ();
+	}
+
+	debug2 (DEBUG_GUI, "marked %u items and %u duplicates read in bulk", g_list_length (ids), g_list_length (duplicates));
+	g_list_free (ids);
+	g_list_free (duplicates);
+
+	debug_end_measurement (DEBUG_GUI, "bulk mark read");
 }
 
 /**
@@ -139,6 +305,19 @@ itemset_mark_read (nodePtr node)
 {
 	itemSetPtr	itemSet;
 
+	/* Folders and sources have no items of their own,
+	   node_mark_all_read() processes their children */
+	if (IS_FOLDER (node) || IS_NODE_SOURCE (node))
+		return;
+
+	/* Search folders span several feeds, everything else can
+	   be done in bulk unless the source syncs per item only */
+	if (!IS_VFOLDER (node) &&
+	    (!NODE_SOURCE_TYPE (node)->item_mark_read || NODE_SOURCE_TYPE (node)->item_mark_all_read)) {
+		itemset_mark_read_bulk (node);
+		return;
+	}
+
 	itemSet = node_get_itemset (node);
 	GList *iter = itemSet->ids;
 	while (iter) {
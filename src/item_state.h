@@ -58,6 +58,29 @@ void item_set_read_state (itemPtr item, gboolean newState);
  */
 void item_read_state_changed (itemPtr item, gboolean newState);
 
+/**
+ * Adds a remote item state to a list to be passed to
+ * item_state_reconcile().
+ *
+ * @param states	the list (or NULL)
+ * @param sourceId	the remote item id
+ * @param read		remote read state
+ * @param flag		remote flag state (or -1 if the source does not sync it)
+ *
+ * @returns the new list start
+ */
+GSList * item_state_remote_prepend (GSList *states, const gchar *sourceId, gboolean read, gint flag);
+
+/**
+ * Applies a batch of remote item states to the items of the
+ * given node. Only items whose state differs are loaded and
+ * changed. Takes ownership of the passed list.
+ *
+ * @param node		the node
+ * @param states	list created with item_state_remote_prepend()
+ */
+void item_state_reconcile (nodePtr node, GSList *states);
+
 /**
  * Requests to mark read all items in the given nodes item list.
  *
@@ -309,6 +309,8 @@ itemlist_load (nodePtr node)
 		if (!folder_display_mode)
 			return;
 	
+		/* The folder item set is already filtered by the DB, the
+		   rule only applies to items merged after loading */
 		conf_get_bool_value (FOLDER_DISPLAY_HIDE_READ, &folder_display_hide_read);
 		if (folder_display_hide_read) {
 			itemlist->priv->filter = g_new0(struct itemSet, 1);
@@ -377,8 +379,10 @@ itemlist_select_next_unread (void)
 	   read or else we would never jump to the next feed,
 	   because no item will be selected and marked read... */
 	if (itemlist->priv->currentNode) {
-		if (NODE_VIEW_MODE_COMBINED == node_get_view_mode (itemlist->priv->currentNode))
+		if (NODE_VIEW_MODE_COMBINED == node_get_view_mode (itemlist->priv->currentNode)) {
+			node_update_counters_flush ();	/* unread counters decide which nodes to process */
 			node_mark_all_read (itemlist->priv->currentNode);
+		}
 	}
 
 	itemlist->priv->loading++;	/* prevent unwanted selections */
@@ -518,6 +522,41 @@ itemlist_remove_items (itemSetPtr itemSet, GList *items)
 	node_update_counters (node_from_id (itemSet->nodeId));
 }
 
+void
+itemlist_remove_oldest_items (itemSetPtr itemSet, guint count)
+{
+	GList	*ids, *iter;
+	gulong	keepId = 0;
+
+	ids = db_itemset_get_oldest (itemSet->nodeId, count, 0);
+	for (iter = ids; iter; iter = g_list_next (iter)) {
+		/* only the dropped items need to be loaded for the GUI */
+		itemPtr item = item_load (GPOINTER_TO_UINT (iter->data));
+		if (!item)
+			continue;
+
+		if (itemlist->priv->selectedId == item->id) {
+			/* go the selection-safe way to avoid disturbing the user,
+			   the item is removed when it gets unselected */
+			keepId = item->id;
+			itemlist_request_remove_item (item);
+		} else {
+			debug2 (DEBUG_UPDATE, "dropping item nr %u (%s)....", item->id, item_get_title (item));
+			itemview_remove_item (item);
+			itemSet->ids = g_list_remove (itemSet->ids, iter->data);
+		}
+		item_unload (item);
+	}
+
+	/* the deferred item is skipped, so one item less is left to delete */
+	db_itemset_remove_oldest (itemSet->nodeId, keepId?count - 1:count, keepId);
+	g_list_free (ids);
+
+	itemview_update ();
+	vfolder_foreach (node_update_counters);
+	node_update_counters (node_from_id (itemSet->nodeId));
+}
+
 void
 itemlist_remove_all_items (nodePtr node)
 {	
@@ -168,6 +168,17 @@ void itemlist_remove_item(itemPtr item);
  */
 void itemlist_remove_items(itemSetPtr itemSet, GList *items);
 
+/**
+ * To be called when the cache limit of an item set is exceeded.
+ * Removes the given number of oldest unflagged items of the item
+ * set from the DB and the GUI. The currently selected item is
+ * never removed.
+ *
+ * @param itemSet	the item set from which items are to be removed
+ * @param count		the number of items to remove
+ */
+void itemlist_remove_oldest_items (itemSetPtr itemSet, guint count);
+
 /**
  * To be called whenever the user wants to remove 
  * all items of a node. Item list selection will be
@@ -22,10 +22,12 @@
 #include <string.h>
 
 #include "common.h"
+#include "conf.h"
 #include "db.h"
 #include "debug.h"
 #include "enclosure.h"
 #include "feed.h"
+#include "image_cache.h"
 #include "itemlist.h"
 #include "itemset.h"
 #include "metadata.h"
@@ -251,6 +253,15 @@ itemset_merge_item (itemSetPtr itemSet, GList *items, itemPtr item, gint maxChec
 				enclosure_free (enc);
 			}
 		}
+
+		/* step 5: Download images for offline reading */
+		if (node) {
+			gboolean prefetchImages;
+
+			conf_get_bool_value (PREFETCH_IMAGES, &prefetchImages);
+			if (prefetchImages)
+				image_cache_prefetch_html (item_get_description (item), node_get_base_url (node));
+		}
 	} else {
 		debug2 (DEBUG_UPDATE, "-> not adding \"%s\" to node id \"%s\"...", item_get_title (item), itemSet->nodeId);
 		item_unload (item);
@@ -259,41 +270,11 @@ itemset_merge_item (itemSetPtr itemSet, GList *items, itemPtr item, gint maxChec
 	return merge;
 }
 
-static gint
-itemset_sort_by_date (gconstpointer a, gconstpointer b)
-{
-	itemPtr item1 = (itemPtr)a;
-	itemPtr item2 = (itemPtr)b;
-	
-	g_assert(item1 && item2);
-	
-	/* We have a problem here if all items of the feed
-	   do have no date, then this comparison is useless.
-	   To avoid such a case we alternatively compare by
-	   item id (which should be an ever-increasing number)
-	   and thereby indicate merge order as a secondary
-	   order criterion */
-	if (item1->time == item2->time) {
-		if (item1->id < item2->id)
-			return 1;
-		if (item1->id > item2->id) 
-			return -1;
-		return 0;
-	}
-		
-	if (item1->time < item2->time)
-		return 1;
-	if (item1->time > item2->time)
-		return -1;
-	
-	return 0;
-}
-
 guint
 itemset_merge_items (itemSetPtr itemSet, GList *list, gboolean allowUpdates, gboolean markAsRead)
 {
-	GList	*iter, *droppedItems = NULL, *items = NULL;
-	guint	i, max, length, toBeDropped, newCount = 0, flagCount = 0;
+	GList	*iter, *items;
+	guint	i, max, length, itemCount, toBeDropped, newCount = 0, flagCount;
 
 	debug_start_measurement (DEBUG_UPDATE);
 	
@@ -308,17 +289,11 @@ itemset_merge_items (itemSetPtr itemSet, GList *list, gboolean allowUpdates, gbo
 	length = g_list_length (list);
 	max = itemset_get_max_item_count (itemSet);
 
-	/* Preload all items for flag counting and later merging comparison */
-	iter = itemSet->ids;
-	while (iter) {
-		itemPtr item = item_load (GPOINTER_TO_UINT (iter->data));
-		if (item) {
-			items = g_list_append (items, item);
-			if (item->flagStatus)
-				flagCount++;
-		}
-		iter = g_list_next (iter);
-	}
+	/* Load the existing items (without metadata) for merging comparison,
+	   everything else needed for the cache limit is done in the DB */
+	items = db_itemset_load_items_for_merge (itemSet->nodeId);
+	flagCount = db_itemset_get_flag_count (itemSet->nodeId);
+
 	debug1(DEBUG_UPDATE, "current cache size: %d", g_list_length(itemSet->ids));
 	debug1(DEBUG_UPDATE, "current cache limit: %d", max);
 	debug1(DEBUG_UPDATE, "downloaded feed size: %d", g_list_length(list));
@@ -385,47 +360,32 @@ itemset_merge_items (itemSetPtr itemSet, GList *list, gboolean allowUpdates, gbo
 	}
 	g_list_free (list);
 
+	/* new items were added to the DB, the merge list is not needed anymore */
+	itemCount = g_list_length (items);
+	g_list_free_full (items, (GDestroyNotify)item_unload);
+
 	vfolder_foreach (node_update_counters);
 	
 	debug1(DEBUG_UPDATE, "added %d new items", newCount);
 	
 	/* 4. Apply cache limit for effective item set size
-	      and unload older items as necessary. In this step
+	      and drop older items as necessary. In this step
 	      it is important never to drop flagged items and 
 	      to drop the oldest items only. */
 	
-	if (g_list_length (items) > max)
-		toBeDropped = g_list_length (items) - max;
+	if (itemCount > max)
+		toBeDropped = itemCount - max;
 	else
 		toBeDropped = 0;
 	
 	debug3 (DEBUG_UPDATE, "%u new items, cache limit is %u -> dropping %u items", newCount, max, toBeDropped);
-	items = g_list_sort (items, itemset_sort_by_date);
-	iter = g_list_last (items);
-	while (iter) {
-		itemPtr item = (itemPtr) iter->data;
-		if (toBeDropped > 0 && !item->flagStatus) {
-			debug2 (DEBUG_UPDATE, "dropping item nr %u (%s)....", item->id, item_get_title (item));
-			droppedItems = g_list_append (droppedItems, item);
-			/* no unloading here, it's done in itemlist_remove_items() */
-			toBeDropped--;
-		} else {
-			item_unload (item);
-		}
-		iter = g_list_previous (iter);
-	}
-	
-	if (droppedItems) {
-		itemlist_remove_items (itemSet, droppedItems);
-		g_list_free (droppedItems);
-	}
+	if (toBeDropped > 0)
+		itemlist_remove_oldest_items (itemSet, toBeDropped);
 	
 	/* 5. Sanity check to detect merging bugs */
-	if (g_list_length (items) > itemset_get_max_item_count (itemSet) + flagCount)
+	if (g_list_length (itemSet->ids) > itemset_get_max_item_count (itemSet) + flagCount)
 		debug0 (DEBUG_CACHE, "Fatal: Item merging bug! Resulting item list is too long! Cache limit does not work. This is a severe program bug!");
 	
-	g_list_free (items);
-	
 	debug_end_measurement (DEBUG_UPDATE, "merge itemset");
 	
 	return newCount;
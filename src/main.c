@@ -42,6 +42,7 @@
 #include "dbus.h"
 #include "debug.h"
 #include "feedlist.h"
+#include "image_cache.h"
 #include "social.h"
 #include "update.h"
 #include "xml.h"
@@ -240,6 +241,7 @@ main (int argc, char *argv[])
 	db_init ();			/* initialize sqlite */
 	xml_init ();			/* initialize libxml2 */
 	social_init ();			/* initialize social bookmarking */
+	image_cache_init ();		/* initialize item image cache */
 
 	dbus = liferea_dbus_new ();
 
@@ -291,6 +293,7 @@ on_shutdown (gpointer user_data)
 
 	db_deinit ();
 	social_free ();
+	image_cache_deinit ();
 	conf_deinit ();
 	
 	debug_exit ("liferea_shutdown");
@@ -39,6 +39,10 @@
 
 static GHashTable *nodes = NULL;	/**< node id -> node lookup table */
 
+static GHashTable *dirtyNodes = NULL;	/**< ids of nodes waiting for a counter update */
+static guint dirtyFlushId = 0;		/**< idle source flushing the counter updates */
+static guint recountsAvoided = 0;	/**< recounts saved by coalescing counter updates */
+
 #define NODE_ID_LEN	7
 
 nodePtr
@@ -211,44 +215,173 @@ node_calc_counters (nodePtr node)
 	NODE_TYPE (node)->update_counters (node);
 }
 
-static void
-node_update_parent_counters (nodePtr node)
+/* Counter updates are only recorded here and applied once per main
+   loop iteration. Item state changes typically request an update for
+   the same feed, all search folders and (via propagation) all parent
+   folders again and again. This way each affected node is recounted
+   and its feed list row updated exactly once. */
+
+static guint
+node_get_depth (nodePtr node)
 {
-	guint old;
+	guint depth = 0;
 
-	if (!node)
+	while ((node = node->parent))
+		depth++;
+
+	return depth;
+}
+
+static gint
+node_depth_compare (gconstpointer a, gconstpointer b)
+{
+	return (gint)node_get_depth ((nodePtr)b) - (gint)node_get_depth ((nodePtr)a);
+}
+
+static gboolean
+node_has_dirty_parent (nodePtr node)
+{
+	while ((node = node->parent)) {
+		if (g_hash_table_lookup (dirtyNodes, node->id))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Applies the counters of a node and returns TRUE if they have changed */
+static gboolean
+node_apply_counters (nodePtr node, gboolean recursive)
+{
+	guint	oldUnreadCount = node->unreadCount;
+	guint	oldItemCount = node->itemCount;
+
+	if (recursive)
+		node_calc_counters (node);
+	else
+		NODE_TYPE (node)->update_counters (node);
+
+	if ((oldUnreadCount == node->unreadCount) &&
+	    (oldItemCount == node->itemCount))
+		return FALSE;
+
+	feed_list_node_update (node->id);
+	return TRUE;
+}
+
+void
+node_update_counters_flush (void)
+{
+	GHashTableIter	hiter;
+	GHashTable	*parents;
+	GList		*dirty = NULL, *skipped = NULL, *sorted, *iter;
+	gpointer	key;
+	gboolean	changed = FALSE;
+	guint		count = 0;
+
+	if (dirtyFlushId) {
+		g_source_remove (dirtyFlushId);
+		dirtyFlushId = 0;
+	}
+
+	if (!dirtyNodes || !g_hash_table_size (dirtyNodes))
 		return;
-		
-	old = node->unreadCount;
 
-	NODE_TYPE (node)->update_counters (node);
-	
-	if (old != node->unreadCount) {
-		feed_list_node_update (node->id);
-		liferea_shell_update_unread_stats ();
+	debug_start_measurement (DEBUG_GUI);
+
+	/* Nodes below another dirty node are recounted with it */
+	g_hash_table_iter_init (&hiter, dirtyNodes);
+	while (g_hash_table_iter_next (&hiter, &key, NULL)) {
+		nodePtr node = node_is_used_id ((gchar *)key);
+		if (!node)
+			continue;
+		if (node_has_dirty_parent (node)) {
+			skipped = g_list_prepend (skipped, node);
+			recountsAvoided++;
+		} else {
+			dirty = g_list_prepend (dirty, node);
+		}
 	}
-	
-	if (node->parent)
-		node_update_parent_counters (node->parent);
+	g_hash_table_remove_all (dirtyNodes);
+
+	/* 1. recount dirty nodes and collect their parents once */
+	parents = g_hash_table_new (g_direct_hash, g_direct_equal);
+	for (iter = dirty; iter; iter = g_list_next (iter)) {
+		nodePtr node = (nodePtr)iter->data;
+
+		changed |= node_apply_counters (node, TRUE);
+		count++;
+
+		/* search folders have no parent propagation */
+		if (IS_VFOLDER (node))
+			continue;
+
+		while ((node = node->parent)) {
+			if (g_hash_table_lookup (parents, node))
+				recountsAvoided++;
+			else
+				g_hash_table_insert (parents, node, node);
+		}
+	}
+	g_list_free (dirty);
+
+	/* the recursive recount changed the skipped nodes too,
+	   but only refreshed the feed list row of their ancestor */
+	for (iter = skipped; iter; iter = g_list_next (iter))
+		feed_list_node_update (((nodePtr)iter->data)->id);
+	g_list_free (skipped);
+
+	/* 2. parents usually just sum up their children,
+	      so the deepest ones have to be done first */
+	sorted = g_list_sort (g_hash_table_get_values (parents), node_depth_compare);
+	for (iter = sorted; iter; iter = g_list_next (iter)) {
+		changed |= node_apply_counters ((nodePtr)iter->data, FALSE);
+		count++;
+	}
+	g_list_free (sorted);
+	g_hash_table_destroy (parents);
+
+	/* 3. one update of the global statistics */
+	if (changed)
+		liferea_shell_update_unread_stats ();
+
+	debug2 (DEBUG_GUI, "updated counters of %u nodes, %u recounts avoided so far", count, recountsAvoided);
+	debug_end_measurement (DEBUG_GUI, "counter update");
+}
+
+static gboolean
+node_update_counters_idle (gpointer user_data)
+{
+	dirtyFlushId = 0;
+	node_update_counters_flush ();
+
+	return FALSE;
 }
 
 void
 node_update_counters (nodePtr node)
 {
-	guint oldUnreadCount = node->unreadCount;
-	guint oldItemCount = node->itemCount;
+	if (!node)
+		return;
 
-	/* Update the node itself and its children */
-	node_calc_counters (node);
-	
-	if ((oldUnreadCount != node->unreadCount) ||
-	    (oldItemCount != node->itemCount))
-		feed_list_node_update (node->id);
-		
-	/* Update the unread count of the parent nodes,
-	   usually they just add all child unread counters */
-	if (!IS_VFOLDER (node))
-		node_update_parent_counters (node->parent);
+	if (!dirtyNodes)
+		dirtyNodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	if (g_hash_table_lookup (dirtyNodes, node->id)) {
+		recountsAvoided++;
+		return;
+	}
+
+	g_hash_table_insert (dirtyNodes, g_strdup (node->id), GINT_TO_POINTER (TRUE));
+
+	if (!dirtyFlushId)
+		dirtyFlushId = g_idle_add (node_update_counters_idle, NULL);
+}
+
+guint
+node_get_recounts_avoided (void)
+{
+	return recountsAvoided;
 }
 
 void
@@ -324,6 +457,9 @@ node_reparent (nodePtr node, nodePtr new_parent)
 
 	new_parent->children = g_slist_insert (new_parent->children, node, -1);
 	node->parent = new_parent;
+
+	/* folder item lists are loaded using the parent ids in the DB */
+	db_node_update (node);
 	
 	feed_list_node_remove_node (node);
 	feed_list_node_add (node);
@@ -202,10 +202,28 @@ void node_set_title(nodePtr node, const gchar *title);
  * Update the number of items and unread items of a node from
  * the DB. This method ensures propagation to parent folders.
  *
+ * The update is deferred to the next main loop iteration, so
+ * that repeated requests for the same node and its parents
+ * result in only one recount and feed list row update.
+ *
  * @param node	the node
  */
 void node_update_counters(nodePtr node);
 
+/**
+ * Immediately applies all deferred counter updates. To be used
+ * before node counters are read for decisions.
+ */
+void node_update_counters_flush (void);
+
+/**
+ * Returns the number of node recounts that were saved by
+ * coalescing deferred counter updates (for debugging).
+ *
+ * @returns number of avoided recounts
+ */
+guint node_get_recounts_avoided (void);
+
 /**
  * Recursively marks all items of the given node as read.
  *
@@ -28,8 +28,10 @@
 #include <libxslt/xsltInternals.h>
 #include <libxslt/transform.h>
 #include <libxslt/xsltutils.h>
+#include <glib/gstdio.h>
 #include <locale.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #include "conf.h"
 #include "common.h"
@@ -58,6 +60,8 @@ static renderParamPtr	langParams = NULL;	/* the current locale settings (for loc
 
 static GHashTable	*stylesheets = NULL;	/* XSLT stylesheet cache */
 
+static gchar		*xsltDir = NULL;	/* stylesheet directory (or NULL for the installed ones) */
+
 static void
 render_parameter_free (renderParamPtr paramSet)
 {
@@ -98,6 +102,12 @@ render_init (void)
 		stylesheets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 }
 
+static const gchar *
+render_get_xslt_dir (void)
+{
+	return xsltDir?xsltDir:PACKAGE_DATA_DIR G_DIR_SEPARATOR_S PACKAGE G_DIR_SEPARATOR_S "xslt";
+}
+
 static xsltStylesheetPtr
 render_load_stylesheet (const gchar *xsltName)
 {
@@ -105,6 +115,7 @@ render_load_stylesheet (const gchar *xsltName)
 	xsltStylesheetPtr	xslt;
 	xmlDocPtr		xsltDoc, resDoc;
 	gchar			*filename;
+	const gchar		*dir;
 
 	if (!stylesheets)
 		render_init ();
@@ -116,15 +127,19 @@ render_load_stylesheet (const gchar *xsltName)
 
 	/* or load and translate it... */
 
+	dir = render_get_xslt_dir ();
+
 	/* 1. load localization stylesheet */
-	i18n_filter = xsltParseStylesheetFile (PACKAGE_DATA_DIR G_DIR_SEPARATOR_S PACKAGE G_DIR_SEPARATOR_S "xslt" G_DIR_SEPARATOR_S "i18n-filter.xslt");
+	filename = g_build_filename (dir, "i18n-filter.xslt", NULL);
+	i18n_filter = xsltParseStylesheetFile (filename);
+	g_free (filename);
 	if (!i18n_filter) {
 		g_warning ("fatal: could not load localization stylesheet!");
 		return NULL;
 	}
 
 	/* 2. load and localize the rendering stylesheet */
-	filename = g_strjoin (NULL, PACKAGE_DATA_DIR G_DIR_SEPARATOR_S PACKAGE G_DIR_SEPARATOR_S "xslt" G_DIR_SEPARATOR_S, xsltName, ".xml", NULL);
+	filename = g_strjoin (NULL, dir, G_DIR_SEPARATOR_S, xsltName, ".xml", NULL);
 	xsltDoc = xmlParseFile (filename);
 	if (!xsltDoc)
 		g_warning ("fatal: could not load rendering stylesheet (%s)!", xsltName);
@@ -151,6 +166,28 @@ render_load_stylesheet (const gchar *xsltName)
 	return xslt;
 }
 
+void
+render_set_xslt_dir (const gchar *dir)
+{
+	g_free (xsltDir);
+	xsltDir = g_strdup (dir);
+}
+
+time_t
+render_get_stylesheet_mtime (const gchar *xsltName)
+{
+	struct stat	st;
+	gchar		*filename;
+	time_t		mtime = 0;
+
+	filename = g_strjoin (NULL, render_get_xslt_dir (), G_DIR_SEPARATOR_S, xsltName, ".xml", NULL);
+	if (0 == g_stat (filename, &st))
+		mtime = st.st_mtime;
+	g_free (filename);
+
+	return mtime;
+}
+
 /** cached CSS definitions */
 static GString	*css = NULL;
 
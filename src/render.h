@@ -55,6 +55,24 @@ renderParamPtr render_parameter_new (void);
  */
 void render_parameter_add (renderParamPtr paramSet, const gchar *fmt, ...);
 
+/**
+ * Loads stylesheets from the given directory instead of the
+ * installed ones. Must be called before the first rendering.
+ *
+ * @param dir		stylesheet directory (or NULL for default)
+ */
+void render_set_xslt_dir (const gchar *dir);
+
+/**
+ * Returns the modification time of a stylesheet file. Used to
+ * detect stylesheet changes between sessions.
+ *
+ * @param xsltName	name of a stylesheet
+ *
+ * @returns the modification time (or 0 if the file does not exist)
+ */
+time_t render_get_stylesheet_mtime (const gchar *xsltName);
+
 /**
  * Returns CSS definitions for inclusion in XHTML output.
  *
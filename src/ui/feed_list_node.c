@@ -36,6 +36,10 @@
 static GHashTable	*flIterHash = NULL;	/**< hash table used for fast node id <-> tree iter lookup */
 static GtkWidget	*nodenamedialog = NULL;
 
+static GHashTable	*flUpdateSet = NULL;	/**< ids of nodes whose row waits for an update */
+static guint		flUpdateId = 0;		/**< idle source flushing the row updates */
+static guint		flUpdatesSuppressed = 0;	/**< row updates saved by coalescing or being no-ops */
+
 GtkTreeIter *
 feed_list_node_to_iter (const gchar *nodeId)
 {
@@ -279,20 +283,23 @@ feed_list_node_remove_node (nodePtr node)
 	}
 }
 
-void
-feed_list_node_update (const gchar *nodeId)
+static gboolean
+feed_list_node_update_row (const gchar *nodeId)
 {
 	GtkTreeIter	*iter;
 	gchar		*label, *count = NULL;
-	guint		labeltype;
+	gchar		*oldLabel, *oldCount;
+	guint		labeltype, oldUnread;
+	gpointer	icon, oldIcon;
+	gboolean	changed;
 	nodePtr		node;
 
 	static gchar	*countColor = NULL;
 
-	node = node_from_id (nodeId);
+	node = node_is_used_id (nodeId);
 	iter = feed_list_node_to_iter (nodeId);
-	if (!iter)
-		return;
+	if (!node || !iter)
+		return FALSE;
 
 	/* Initialize unread item color Pango CSS */
 	if (!countColor) {
@@ -345,16 +352,92 @@ feed_list_node_update (const gchar *nodeId)
 		}
 	}
 
-	gtk_tree_store_set (feedstore, iter,
-	                    FS_LABEL, label,
-	                    FS_UNREAD, node->unreadCount,
-	                    FS_ICON, node->available?node_get_icon (node):icon_get (ICON_UNAVAILABLE),
-	                    FS_COUNT, count,
+	icon = node->available?node_get_icon (node):(gpointer)icon_get (ICON_UNAVAILABLE);
+
+	/* Setting unchanged values still emits "row-changed" and
+	   causes a redraw, so compare with the current row first */
+	gtk_tree_model_get (GTK_TREE_MODEL (feedstore), iter,
+	                    FS_LABEL, &oldLabel,
+	                    FS_UNREAD, &oldUnread,
+	                    FS_ICON, &oldIcon,
+	                    FS_COUNT, &oldCount,
 	                    -1);
+
+	changed = (oldUnread != node->unreadCount) ||
+	          (oldIcon != icon) ||
+	          g_strcmp0 (oldLabel, label) ||
+	          g_strcmp0 (oldCount, count);
+
+	if (changed)
+		gtk_tree_store_set (feedstore, iter,
+		                    FS_LABEL, label,
+		                    FS_UNREAD, node->unreadCount,
+		                    FS_ICON, icon,
+		                    FS_COUNT, count,
+		                    -1);
+
+	if (oldIcon)
+		g_object_unref (oldIcon);
+	g_free (oldLabel);
+	g_free (oldCount);
 	g_free (label);
+	g_free (count);
 
-	if (node->parent)
-		feed_list_node_update (node->parent->id);
+	return changed;
+}
+
+static gboolean
+feed_list_node_update_idle (gpointer user_data)
+{
+	GHashTable	*updates = flUpdateSet;
+	GHashTableIter	hiter;
+	gpointer	key;
+	guint		count = 0;
+
+	flUpdateId = 0;
+	flUpdateSet = NULL;
+	if (!updates)
+		return FALSE;
+
+	debug_start_measurement (DEBUG_GUI);
+
+	g_hash_table_iter_init (&hiter, updates);
+	while (g_hash_table_iter_next (&hiter, &key, NULL)) {
+		if (feed_list_node_update_row ((gchar *)key))
+			count++;
+		else
+			flUpdatesSuppressed++;
+	}
+
+	debug3 (DEBUG_GUI, "updated %u of %u feed list rows, %u updates suppressed so far", count, g_hash_table_size (updates), flUpdatesSuppressed);
+	debug_end_measurement (DEBUG_GUI, "feed list row update");
+
+	g_hash_table_destroy (updates);
+
+	return FALSE;
+}
+
+void
+feed_list_node_update (const gchar *nodeId)
+{
+	nodePtr	node;
+
+	if (!flUpdateSet)
+		flUpdateSet = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	/* Queue the row and all parent rows, whose counts depend on it */
+	node = node_is_used_id (nodeId);
+	while (node && node->parent) {
+		if (g_hash_table_lookup (flUpdateSet, node->id))
+			flUpdatesSuppressed++;
+		else
+			g_hash_table_insert (flUpdateSet, g_strdup (node->id), GINT_TO_POINTER (TRUE));
+		node = node->parent;
+	}
+
+	/* Flush before GTK+ redraws the feed list */
+	if (!flUpdateId)
+		flUpdateId = g_idle_add_full (G_PRIORITY_HIGH_IDLE, feed_list_node_update_idle, NULL, NULL);
 }
 
 /* node renaming dialog */
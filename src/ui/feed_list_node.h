@@ -91,7 +91,9 @@ gboolean feed_list_node_is_expanded (const gchar *nodeId);
 void feed_list_node_set_expansion (nodePtr folder, gboolean expanded);
 
 /**
- * Updates the tree view entry of the given node.
+ * Schedules an update of the tree view entry of the given node
+ * and its parents. All scheduled rows are updated at once before
+ * the feed list is redrawn, unchanged rows are skipped.
  *
  * @param nodeId	the node id
  */
@@ -0,0 +1,880 @@
+/**
+ * @file item_list_model.c  virtual GtkTreeModel for the item list
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ui/item_list_model.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "common.h"
+#include "date.h"
+#include "db.h"
+#include "debug.h"
+#include "node.h"
+#include "ui/icons.h"
+
+/**
+ * The model is a flat list of item ids. Loading a feed with tens of
+ * thousands of items into a GtkTreeStore cost a GtkTreeIter, a hash
+ * entry and the strings of all columns per item. Here only the id
+ * array and an id -> position hash are kept for all items.
+ *
+ * Column values are loaded with db_item_list_load() in pages of
+ * ITEM_LIST_MODEL_PAGE_SIZE rows when a row is first displayed and
+ * kept in a row cache limited to ITEM_LIST_MODEL_CACHE_SIZE rows
+ * dropping the least recently used rows. As the tree view is used in
+ * fixed height mode only the visible rows are ever requested.
+ *
+ * Sorting is done by db_item_list_sort(). As item sets are loaded newest
+ * first, which is the default descending date order, the model checks
+ * whether items are appended in sort order and skips the sorting if
+ * they are.
+ *
+ * Iters hold the row position, so they are invalidated by each
+ * insertion, removal and reordering.
+ */
+
+#define ITEM_LIST_MODEL_PAGE_SIZE	100
+#define ITEM_LIST_MODEL_CACHE_SIZE	1000
+
+/** the column values of a row */
+typedef struct itemListRow {
+	gulong		id;
+	guint64		time;
+	gchar		*timeStr;
+	gchar		*title;
+	gchar		*nodeId;
+	gboolean	readStatus;
+	gboolean	flagStatus;
+	gboolean	hasEnclosure;
+	gfloat		align;
+	GList		*link;		/**< position in the LRU list */
+} *itemListRowPtr;
+
+/** the values an item is sorted by */
+typedef struct itemListSortKey {
+	gulong		id;
+	guint64		time;
+	guint		state;
+	gchar		*nodeId;
+	gchar		*titleKey;	/**< title collation key, only for title sorting */
+} *itemListSortKeyPtr;
+
+#define ITEM_LIST_MODEL_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE ((object), ITEM_LIST_MODEL_TYPE, ItemListModelPrivate))
+
+struct ItemListModelPrivate {
+	gint		stamp;			/**< iter validity stamp */
+
+	GArray		*ids;			/**< item ids in display order */
+	GHashTable	*positions;		/**< item id -> position + 1 */
+	gboolean	positionsValid;		/**< FALSE if positions need to be recalculated */
+
+	GHashTable	*rows;			/**< item id -> itemListRow */
+	GQueue		*lru;			/**< cached rows, most recently used first */
+
+	gint		sortColumn;		/**< current sort column (IS_*) */
+	GtkSortType	sortOrder;		/**< current sort order */
+	gboolean	sorted;			/**< FALSE if rows were added out of order since the last sorting */
+	struct itemListSortKey lastKey;		/**< sort key of the last appended item */
+	gboolean	lastKeyValid;		/**< FALSE if lastKey is unknown */
+};
+
+static GObjectClass *parent_class = NULL;
+
+static void item_list_model_tree_model_init (GtkTreeModelIface *iface);
+static void item_list_model_tree_sortable_init (GtkTreeSortableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (ItemListModel, item_list_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL, item_list_model_tree_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_SORTABLE, item_list_model_tree_sortable_init));
+
+static void
+item_list_model_row_free (gpointer data)
+{
+	itemListRowPtr row = (itemListRowPtr)data;
+
+	g_free (row->timeStr);
+	g_free (row->title);
+	g_free (row->nodeId);
+	g_free (row);
+}
+
+static void
+item_list_model_finalize (GObject *object)
+{
+	ItemListModelPrivate *priv = ITEM_LIST_MODEL_GET_PRIVATE (object);
+
+	g_array_free (priv->ids, TRUE);
+	g_hash_table_destroy (priv->positions);
+	g_queue_free (priv->lru);
+	g_hash_table_destroy (priv->rows);
+	g_free (priv->lastKey.nodeId);
+	g_free (priv->lastKey.titleKey);
+
+	G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+item_list_model_class_init (ItemListModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+
+	object_class->finalize = item_list_model_finalize;
+
+	g_type_class_add_private (object_class, sizeof(ItemListModelPrivate));
+}
+
+static void
+item_list_model_init (ItemListModel *ilm)
+{
+	ilm->priv = ITEM_LIST_MODEL_GET_PRIVATE (ilm);
+	ilm->priv->stamp = g_random_int ();
+	ilm->priv->ids = g_array_new (FALSE, FALSE, sizeof (gulong));
+	ilm->priv->positions = g_hash_table_new (g_direct_hash, g_direct_equal);
+	ilm->priv->positionsValid = TRUE;
+	ilm->priv->rows = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, item_list_model_row_free);
+	ilm->priv->lru = g_queue_new ();
+	ilm->priv->sortColumn = IS_TIME;
+	ilm->priv->sortOrder = GTK_SORT_ASCENDING;
+	ilm->priv->sorted = TRUE;
+}
+
+ItemListModel *
+item_list_model_new (void)
+{
+	return g_object_new (ITEM_LIST_MODEL_TYPE, NULL);
+}
+
+/* row cache */
+
+static gfloat
+item_list_model_title_alignment (const gchar *title)
+{
+	if (!title || strlen(title) == 0)
+		return 0.;
+
+	int txt_direction = pango_find_base_dir (title, -1);
+  	int app_direction = gtk_widget_get_default_direction ();
+	if ((txt_direction == PANGO_DIRECTION_LTR &&
+	     app_direction == GTK_TEXT_DIR_LTR) ||
+	    (txt_direction == PANGO_DIRECTION_RTL &&
+	     app_direction == GTK_TEXT_DIR_RTL))
+		return 0.; /* same direction, regular ("left") alignment */
+	else
+		return 1.;
+}
+
+static void
+item_list_model_row_set (itemListRowPtr row, itemPtr item)
+{
+	const gchar *title;
+
+	g_free (row->timeStr);
+	g_free (row->title);
+	g_free (row->nodeId);
+
+	title = item->title && strlen (item->title) ? item->title : _("*** No title ***");
+
+	row->id = item->id;
+	row->time = (guint64)item->time;
+	row->timeStr = (0 != item->time) ? date_format ((time_t)item->time, NULL) : g_strdup ("");
+	row->title = g_strstrip (g_strdup (title));
+	row->nodeId = g_strdup (item->nodeId);
+	row->readStatus = item->readStatus;
+	row->flagStatus = item->flagStatus;
+	row->hasEnclosure = item->hasEnclosure;
+	row->align = item_list_model_title_alignment (row->title);
+}
+
+static void
+item_list_model_row_drop (ItemListModel *ilm, gulong id)
+{
+	itemListRowPtr row;
+
+	row = g_hash_table_lookup (ilm->priv->rows, GUINT_TO_POINTER (id));
+	if (row) {
+		g_queue_delete_link (ilm->priv->lru, row->link);
+		g_hash_table_remove (ilm->priv->rows, GUINT_TO_POINTER (id));
+	}
+}
+
+/* Returns the cached row of an item, creating an empty one if needed */
+static itemListRowPtr
+item_list_model_row_add (ItemListModel *ilm, gulong id)
+{
+	itemListRowPtr row;
+
+	row = g_hash_table_lookup (ilm->priv->rows, GUINT_TO_POINTER (id));
+	if (row)
+		return row;
+
+	row = g_new0 (struct itemListRow, 1);
+	row->id = id;
+	row->readStatus = TRUE;
+	g_queue_push_head (ilm->priv->lru, row);
+	row->link = g_queue_peek_head_link (ilm->priv->lru);
+	g_hash_table_insert (ilm->priv->rows, GUINT_TO_POINTER (id), row);
+
+	return row;
+}
+
+static void
+item_list_model_row_trim (ItemListModel *ilm)
+{
+	while (g_queue_get_length (ilm->priv->lru) > ITEM_LIST_MODEL_CACHE_SIZE) {
+		itemListRowPtr row = g_queue_pop_tail (ilm->priv->lru);
+		g_hash_table_remove (ilm->priv->rows, GUINT_TO_POINTER (row->id));
+	}
+}
+
+/* Loads the page of rows around the given position */
+static void
+item_list_model_load_page (ItemListModel *ilm, guint position)
+{
+	GSList	*items, *iter;
+	gulong	*ids;
+	guint	start, count, i;
+
+	start = position - position % ITEM_LIST_MODEL_PAGE_SIZE;
+	count = MIN (ITEM_LIST_MODEL_PAGE_SIZE, ilm->priv->ids->len - start);
+	ids = &g_array_index (ilm->priv->ids, gulong, start);
+
+	debug2 (DEBUG_GUI, "item list model: loading %u rows at %u", count, start);
+
+	/* Items missing in the DB keep an empty row, so they are not
+	   requested again and again. */
+	for (i = 0; i < count; i++)
+		item_list_model_row_add (ilm, ids[i]);
+
+	items = db_item_list_load (ids, count);
+	for (iter = items; iter; iter = g_slist_next (iter)) {
+		itemPtr item = (itemPtr)iter->data;
+		item_list_model_row_set (item_list_model_row_add (ilm, item->id), item);
+		item_unload (item);
+	}
+	g_slist_free (items);
+
+	item_list_model_row_trim (ilm);
+}
+
+static itemListRowPtr
+item_list_model_get_row (ItemListModel *ilm, guint position)
+{
+	itemListRowPtr	row;
+	gulong		id;
+
+	id = g_array_index (ilm->priv->ids, gulong, position);
+	row = g_hash_table_lookup (ilm->priv->rows, GUINT_TO_POINTER (id));
+	if (!row) {
+		item_list_model_load_page (ilm, position);
+		row = g_hash_table_lookup (ilm->priv->rows, GUINT_TO_POINTER (id));
+		g_assert (NULL != row);
+	} else if (row->link != g_queue_peek_head_link (ilm->priv->lru)) {
+		g_queue_unlink (ilm->priv->lru, row->link);
+		g_queue_push_head_link (ilm->priv->lru, row->link);
+	}
+
+	return row;
+}
+
+/* sort order checks */
+
+static void
+item_list_model_set_last_key (ItemListModel *ilm, itemPtr item)
+{
+	itemListSortKeyPtr key = &ilm->priv->lastKey;
+
+	g_free (key->nodeId);
+	g_free (key->titleKey);
+
+	key->id = item->id;
+	key->time = (guint64)item->time;
+	key->state = (item->flagStatus ? 2 : 0) + (item->readStatus ? 0 : 1);
+	key->nodeId = g_strdup (item->nodeId);
+	key->titleKey = (IS_LABEL == ilm->priv->sortColumn && item->title) ? g_utf8_collate_key (item->title, -1) : NULL;
+	ilm->priv->lastKeyValid = TRUE;
+}
+
+/* Compares sort keys in the order of db_item_list_sort() */
+static gint
+item_list_model_compare_keys (ItemListModel *ilm, itemListSortKeyPtr a, itemListSortKeyPtr b)
+{
+	gint result = 0;
+
+	switch (ilm->priv->sortColumn) {
+		case IS_LABEL:
+			result = g_strcmp0 (a->titleKey, b->titleKey);
+			break;
+		case IS_PARENT:
+		case IS_SOURCE:
+			result = g_strcmp0 (a->nodeId, b->nodeId);
+			break;
+		case IS_STATE:
+			result = (a->state > b->state) - (a->state < b->state);
+			break;
+	}
+
+	/* oldest first */
+	if (!result)
+		result = (a->time > b->time) - (a->time < b->time);
+	if (!result)
+		result = (a->id > b->id) - (a->id < b->id);
+
+	return (GTK_SORT_DESCENDING == ilm->priv->sortOrder) ? -result : result;
+}
+
+/* Updates the sorted flag for an item appended to the model */
+static void
+item_list_model_check_order (ItemListModel *ilm, itemPtr item)
+{
+	struct itemListSortKey last;
+
+	if (1 == ilm->priv->ids->len) {
+		item_list_model_set_last_key (ilm, item);
+		return;
+	}
+
+	if (!ilm->priv->lastKeyValid) {
+		ilm->priv->sorted = FALSE;
+		return;
+	}
+
+	last = ilm->priv->lastKey;
+	last.nodeId = g_strdup (last.nodeId);
+	last.titleKey = g_strdup (last.titleKey);
+
+	item_list_model_set_last_key (ilm, item);
+	if (item_list_model_compare_keys (ilm, &last, &ilm->priv->lastKey) > 0)
+		ilm->priv->sorted = FALSE;
+
+	g_free (last.nodeId);
+	g_free (last.titleKey);
+}
+
+/* position lookup */
+
+static void
+item_list_model_update_positions (ItemListModel *ilm)
+{
+	guint i;
+
+	if (ilm->priv->positionsValid)
+		return;
+
+	for (i = 0; i < ilm->priv->ids->len; i++)
+		g_hash_table_insert (ilm->priv->positions,
+		                     GUINT_TO_POINTER (g_array_index (ilm->priv->ids, gulong, i)),
+		                     GUINT_TO_POINTER (i + 1));
+
+	ilm->priv->positionsValid = TRUE;
+}
+
+static gboolean
+item_list_model_get_position (ItemListModel *ilm, gulong id, guint *position)
+{
+	gpointer value;
+
+	item_list_model_update_positions (ilm);
+
+	value = g_hash_table_lookup (ilm->priv->positions, GUINT_TO_POINTER (id));
+	if (!value)
+		return FALSE;
+
+	*position = GPOINTER_TO_UINT (value) - 1;
+	return TRUE;
+}
+
+static void
+item_list_model_set_iter (ItemListModel *ilm, GtkTreeIter *iter, guint position)
+{
+	iter->stamp = ilm->priv->stamp;
+	iter->user_data = GUINT_TO_POINTER (position);
+}
+
+static gboolean
+item_list_model_iter_is_valid (ItemListModel *ilm, GtkTreeIter *iter)
+{
+	return iter && iter->stamp == ilm->priv->stamp &&
+	       GPOINTER_TO_UINT (iter->user_data) < ilm->priv->ids->len;
+}
+
+/* public methods */
+
+void
+item_list_model_add_item (ItemListModel *ilm, itemPtr item)
+{
+	GtkTreeIter	iter;
+	GtkTreePath	*path;
+	gulong		id = item->id;
+	guint		position;
+
+	if (item_list_model_contains_id (ilm, id)) {
+		item_list_model_update_item (ilm, item);
+		return;
+	}
+
+	position = ilm->priv->ids->len;
+	g_array_append_val (ilm->priv->ids, id);
+	g_hash_table_insert (ilm->priv->positions, GUINT_TO_POINTER (id), GUINT_TO_POINTER (position + 1));
+	ilm->priv->stamp++;
+	if (ilm->priv->sorted)
+		item_list_model_check_order (ilm, item);
+
+	/* The item is at hand, so there is no need to load the row later */
+	item_list_model_row_set (item_list_model_row_add (ilm, id), item);
+	item_list_model_row_trim (ilm);
+
+	item_list_model_set_iter (ilm, &iter, position);
+	path = gtk_tree_path_new_from_indices (position, -1);
+	gtk_tree_model_row_inserted (GTK_TREE_MODEL (ilm), path, &iter);
+	gtk_tree_path_free (path);
+}
+
+void
+item_list_model_remove_item (ItemListModel *ilm, gulong id)
+{
+	GtkTreePath	*path;
+	guint		position;
+
+	if (!item_list_model_get_position (ilm, id, &position))
+		return;
+
+	g_array_remove_index (ilm->priv->ids, position);
+	g_hash_table_remove (ilm->priv->positions, GUINT_TO_POINTER (id));
+	/* only the positions of the following rows change */
+	if (position != ilm->priv->ids->len)
+		ilm->priv->positionsValid = FALSE;
+	ilm->priv->stamp++;
+	item_list_model_row_drop (ilm, id);
+
+	path = gtk_tree_path_new_from_indices (position, -1);
+	gtk_tree_model_row_deleted (GTK_TREE_MODEL (ilm), path);
+	gtk_tree_path_free (path);
+}
+
+void
+item_list_model_update_item (ItemListModel *ilm, itemPtr item)
+{
+	GtkTreeIter	iter;
+	GtkTreePath	*path;
+	guint		position;
+
+	if (!item_list_model_get_position (ilm, item->id, &position))
+		return;
+
+	item_list_model_row_set (item_list_model_row_add (ilm, item->id), item);
+	item_list_model_row_trim (ilm);
+
+	/* title and state changes might affect the sorting */
+	if (IS_TIME != ilm->priv->sortColumn)
+		ilm->priv->sorted = FALSE;
+
+	item_list_model_set_iter (ilm, &iter, position);
+	path = gtk_tree_path_new_from_indices (position, -1);
+	gtk_tree_model_row_changed (GTK_TREE_MODEL (ilm), path, &iter);
+	gtk_tree_path_free (path);
+}
+
+void
+item_list_model_reload (ItemListModel *ilm)
+{
+	g_queue_clear (ilm->priv->lru);
+	g_hash_table_remove_all (ilm->priv->rows);
+}
+
+gboolean
+item_list_model_contains_id (ItemListModel *ilm, gulong id)
+{
+	return (NULL != g_hash_table_lookup (ilm->priv->positions, GUINT_TO_POINTER (id)));
+}
+
+gboolean
+item_list_model_get_iter_by_id (ItemListModel *ilm, gulong id, GtkTreeIter *iter)
+{
+	guint position;
+
+	if (!item_list_model_get_position (ilm, id, &position))
+		return FALSE;
+
+	item_list_model_set_iter (ilm, iter, position);
+	return TRUE;
+}
+
+gulong
+item_list_model_get_id (ItemListModel *ilm, GtkTreeIter *iter)
+{
+	g_return_val_if_fail (item_list_model_iter_is_valid (ilm, iter), 0);
+
+	return g_array_index (ilm->priv->ids, gulong, GPOINTER_TO_UINT (iter->user_data));
+}
+
+gboolean
+item_list_model_get_read_status (ItemListModel *ilm, GtkTreeIter *iter)
+{
+	g_return_val_if_fail (item_list_model_iter_is_valid (ilm, iter), TRUE);
+
+	return item_list_model_get_row (ilm, GPOINTER_TO_UINT (iter->user_data))->readStatus;
+}
+
+/* sorting */
+
+static nodeViewSortType
+item_list_model_get_sort_type (gint sortColumn)
+{
+	switch (sortColumn) {
+		case IS_LABEL:
+			return NODE_VIEW_SORT_BY_TITLE;
+		case IS_STATE:
+			return NODE_VIEW_SORT_BY_STATE;
+		case IS_PARENT:
+		case IS_SOURCE:
+			return NODE_VIEW_SORT_BY_PARENT;
+		case IS_TIME:
+		default:
+			return NODE_VIEW_SORT_BY_TIME;
+	}
+}
+
+void
+item_list_model_sort (ItemListModel *ilm)
+{
+	GtkTreePath	*path;
+	gint		*newOrder;
+	guint		i, count = ilm->priv->ids->len;
+
+	if (ilm->priv->sorted)
+		return;
+
+	ilm->priv->sorted = TRUE;
+	ilm->priv->lastKeyValid = FALSE;
+	if (count < 2)
+		return;
+
+	debug_start_measurement (DEBUG_GUI);
+
+	item_list_model_update_positions (ilm);
+	db_item_list_sort ((gulong *)ilm->priv->ids->data, count,
+	                   item_list_model_get_sort_type (ilm->priv->sortColumn),
+	                   GTK_SORT_DESCENDING == ilm->priv->sortOrder);
+
+	/* new_order[new position] = old position */
+	newOrder = g_new (gint, count);
+	for (i = 0; i < count; i++) {
+		gulong id = g_array_index (ilm->priv->ids, gulong, i);
+		newOrder[i] = GPOINTER_TO_UINT (g_hash_table_lookup (ilm->priv->positions, GUINT_TO_POINTER (id))) - 1;
+	}
+	ilm->priv->positionsValid = FALSE;
+	ilm->priv->stamp++;
+
+	path = gtk_tree_path_new ();
+	gtk_tree_model_rows_reordered (GTK_TREE_MODEL (ilm), path, NULL, newOrder);
+	gtk_tree_path_free (path);
+	g_free (newOrder);
+
+	debug_end_measurement (DEBUG_GUI, "item list sorting");
+}
+
+static gboolean
+item_list_model_get_sort_column_id (GtkTreeSortable *sortable, gint *sortColumn, GtkSortType *order)
+{
+	ItemListModel *ilm = ITEM_LIST_MODEL (sortable);
+
+	if (sortColumn)
+		*sortColumn = ilm->priv->sortColumn;
+	if (order)
+		*order = ilm->priv->sortOrder;
+
+	return TRUE;
+}
+
+static void
+item_list_model_set_sort_column_id (GtkTreeSortable *sortable, gint sortColumn, GtkSortType order)
+{
+	ItemListModel *ilm = ITEM_LIST_MODEL (sortable);
+
+	/* there is no unsorted state */
+	if (GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID == sortColumn ||
+	    GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID == sortColumn)
+		sortColumn = IS_TIME;
+
+	if (ilm->priv->sortColumn == sortColumn && ilm->priv->sortOrder == order) {
+		item_list_model_sort (ilm);
+		return;
+	}
+
+	/* Re-query the order instead of resorting rows in memory */
+	ilm->priv->sortColumn = sortColumn;
+	ilm->priv->sortOrder = order;
+	ilm->priv->sorted = (0 == ilm->priv->ids->len);
+	ilm->priv->lastKeyValid = FALSE;
+	item_list_model_sort (ilm);
+
+	gtk_tree_sortable_sort_column_changed (sortable);
+}
+
+static void
+item_list_model_set_sort_func (GtkTreeSortable *sortable, gint sortColumn,
+                               GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy)
+{
+	g_warning ("item list model: custom sort functions are not supported");
+}
+
+static void
+item_list_model_set_default_sort_func (GtkTreeSortable *sortable,
+                                       GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy)
+{
+	g_warning ("item list model: custom sort functions are not supported");
+}
+
+static gboolean
+item_list_model_has_default_sort_func (GtkTreeSortable *sortable)
+{
+	return FALSE;
+}
+
+static void
+item_list_model_tree_sortable_init (GtkTreeSortableIface *iface)
+{
+	iface->get_sort_column_id = item_list_model_get_sort_column_id;
+	iface->set_sort_column_id = item_list_model_set_sort_column_id;
+	iface->set_sort_func = item_list_model_set_sort_func;
+	iface->set_default_sort_func = item_list_model_set_default_sort_func;
+	iface->has_default_sort_func = item_list_model_has_default_sort_func;
+}
+
+/* GtkTreeModel implementation */
+
+static GtkTreeModelFlags
+item_list_model_get_flags (GtkTreeModel *model)
+{
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+item_list_model_get_n_columns (GtkTreeModel *model)
+{
+	return ITEMSTORE_LEN;
+}
+
+static GType
+item_list_model_get_column_type (GtkTreeModel *model, gint column)
+{
+	switch (column) {
+		case IS_TIME:		return G_TYPE_UINT64;
+		case IS_TIME_STR:	return G_TYPE_STRING;
+		case IS_LABEL:		return G_TYPE_STRING;
+		case IS_STATEICON:	return GDK_TYPE_PIXBUF;
+		case IS_NR:		return G_TYPE_ULONG;
+		case IS_PARENT:		return G_TYPE_POINTER;
+		case IS_FAVICON:	return GDK_TYPE_PIXBUF;
+		case IS_ENCICON:	return GDK_TYPE_PIXBUF;
+		case IS_ENCLOSURE:	return G_TYPE_BOOLEAN;
+		case IS_SOURCE:		return G_TYPE_POINTER;
+		case IS_STATE:		return G_TYPE_UINT;
+		case ITEMSTORE_UNREAD:	return G_TYPE_INT;
+		case ITEMSTORE_ALIGN:	return G_TYPE_FLOAT;
+		default:		return G_TYPE_INVALID;
+	}
+}
+
+static gboolean
+item_list_model_get_iter (GtkTreeModel *model, GtkTreeIter *iter, GtkTreePath *path)
+{
+	ItemListModel	*ilm = ITEM_LIST_MODEL (model);
+	gint		position;
+
+	if (1 != gtk_tree_path_get_depth (path))
+		return FALSE;
+
+	position = gtk_tree_path_get_indices (path)[0];
+	if (position < 0 || (guint)position >= ilm->priv->ids->len)
+		return FALSE;
+
+	item_list_model_set_iter (ilm, iter, position);
+	return TRUE;
+}
+
+static GtkTreePath *
+item_list_model_get_path (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	ItemListModel *ilm = ITEM_LIST_MODEL (model);
+
+	g_return_val_if_fail (item_list_model_iter_is_valid (ilm, iter), NULL);
+
+	return gtk_tree_path_new_from_indices (GPOINTER_TO_UINT (iter->user_data), -1);
+}
+
+static void
+item_list_model_get_value (GtkTreeModel *model, GtkTreeIter *iter, gint column, GValue *value)
+{
+	ItemListModel	*ilm = ITEM_LIST_MODEL (model);
+	itemListRowPtr	row;
+	nodePtr		node;
+
+	g_return_if_fail (item_list_model_iter_is_valid (ilm, iter));
+
+	g_value_init (value, item_list_model_get_column_type (model, column));
+
+	/* the id is the only column not needing the row */
+	if (IS_NR == column) {
+		g_value_set_ulong (value, item_list_model_get_id (ilm, iter));
+		return;
+	}
+
+	row = item_list_model_get_row (ilm, GPOINTER_TO_UINT (iter->user_data));
+	switch (column) {
+		case IS_TIME:
+			g_value_set_uint64 (value, row->time);
+			break;
+		case IS_TIME_STR:
+			g_value_set_string (value, row->timeStr);
+			break;
+		case IS_LABEL:
+			g_value_set_string (value, row->title);
+			break;
+		case IS_STATEICON:
+			g_value_set_object (value, (gpointer)(row->flagStatus ? icon_get (ICON_FLAG) :
+			                                      !row->readStatus ? icon_get (ICON_UNREAD) :
+			                                      NULL));
+			break;
+		case IS_PARENT:
+		case IS_SOURCE:
+			g_value_set_pointer (value, row->nodeId ? node_from_id (row->nodeId) : NULL);
+			break;
+		case IS_FAVICON:
+			node = row->nodeId ? node_from_id (row->nodeId) : NULL;
+			g_value_set_object (value, node ? node->icon : NULL);
+			break;
+		case IS_ENCICON:
+			g_value_set_object (value, row->hasEnclosure ? (gpointer)icon_get (ICON_ENCLOSURE) : NULL);
+			break;
+		case IS_ENCLOSURE:
+			g_value_set_boolean (value, row->hasEnclosure);
+			break;
+		case IS_STATE:
+			g_value_set_uint (value, (row->flagStatus ? 2 : 0) + (row->readStatus ? 0 : 1));
+			break;
+		case ITEMSTORE_UNREAD:
+			g_value_set_int (value, row->readStatus ? PANGO_WEIGHT_NORMAL : PANGO_WEIGHT_BOLD);
+			break;
+		case ITEMSTORE_ALIGN:
+			g_value_set_float (value, row->align);
+			break;
+	}
+}
+
+static gboolean
+item_list_model_iter_next (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	ItemListModel	*ilm = ITEM_LIST_MODEL (model);
+	guint		position;
+
+	g_return_val_if_fail (item_list_model_iter_is_valid (ilm, iter), FALSE);
+
+	position = GPOINTER_TO_UINT (iter->user_data) + 1;
+	if (position >= ilm->priv->ids->len) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+
+	item_list_model_set_iter (ilm, iter, position);
+	return TRUE;
+}
+
+static gboolean
+item_list_model_iter_previous (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	ItemListModel	*ilm = ITEM_LIST_MODEL (model);
+	guint		position;
+
+	g_return_val_if_fail (item_list_model_iter_is_valid (ilm, iter), FALSE);
+
+	position = GPOINTER_TO_UINT (iter->user_data);
+	if (0 == position) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+
+	item_list_model_set_iter (ilm, iter, position - 1);
+	return TRUE;
+}
+
+static gboolean
+item_list_model_iter_nth_child (GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent, gint n)
+{
+	ItemListModel *ilm = ITEM_LIST_MODEL (model);
+
+	/* this is a list, nodes have no children */
+	if (parent || n < 0 || (guint)n >= ilm->priv->ids->len)
+		return FALSE;
+
+	item_list_model_set_iter (ilm, iter, n);
+	return TRUE;
+}
+
+static gboolean
+item_list_model_iter_children (GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+	return item_list_model_iter_nth_child (model, iter, parent, 0);
+}
+
+static gboolean
+item_list_model_iter_has_child (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+static gint
+item_list_model_iter_n_children (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	if (iter)
+		return 0;
+
+	return ITEM_LIST_MODEL (model)->priv->ids->len;
+}
+
+static gboolean
+item_list_model_iter_parent (GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *child)
+{
+	return FALSE;
+}
+
+static void
+item_list_model_tree_model_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags = item_list_model_get_flags;
+	iface->get_n_columns = item_list_model_get_n_columns;
+	iface->get_column_type = item_list_model_get_column_type;
+	iface->get_iter = item_list_model_get_iter;
+	iface->get_path = item_list_model_get_path;
+	iface->get_value = item_list_model_get_value;
+	iface->iter_next = item_list_model_iter_next;
+	iface->iter_previous = item_list_model_iter_previous;
+	iface->iter_children = item_list_model_iter_children;
+	iface->iter_has_child = item_list_model_iter_has_child;
+	iface->iter_n_children = item_list_model_iter_n_children;
+	iface->iter_nth_child = item_list_model_iter_nth_child;
+	iface->iter_parent = item_list_model_iter_parent;
+}
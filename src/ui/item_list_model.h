@@ -0,0 +1,174 @@
+/**
+ * @file item_list_model.h  virtual GtkTreeModel for the item list
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _ITEM_LIST_MODEL_H
+#define _ITEM_LIST_MODEL_H
+
+#include <glib-object.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "item.h"
+
+/* This class is the GtkTreeModel of the item list. It only keeps the
+   ids of the listed items in display order. The column values are
+   loaded from the DB on demand, a page of rows at a time, and only
+   a limited number of rows is kept in memory. Sorting is done by
+   the DB too, using the item title collation keys stored there. */
+
+G_BEGIN_DECLS
+
+/** Enumeration of the columns in the item list model. */
+enum is_columns {
+	IS_TIME,		/**< Time of item creation */
+	IS_TIME_STR,		/**< Time of item creation as a string*/
+	IS_LABEL,		/**< Displayed name */
+	IS_STATEICON,		/**< Pixbuf reference to the item's state icon */
+	IS_NR,			/**< Item id, to lookup item ptr from parent feed */
+	IS_PARENT,		/**< Parent node pointer */
+	IS_FAVICON,		/**< Pixbuf reference to the item's feed's icon */
+	IS_ENCICON,		/**< Pixbuf reference to the item's enclosure icon */
+	IS_ENCLOSURE,		/**< Flag whether enclosure is attached or not */
+	IS_SOURCE,		/**< Source node pointer */
+	IS_STATE,		/**< Original item state (unread, flagged...) for sorting */
+	ITEMSTORE_UNREAD,	/**< Flag whether "unread" icon is to be shown */
+	ITEMSTORE_ALIGN,        /**< How to align title (RTL support) */
+	ITEMSTORE_LEN		/**< Number of columns in the itemstore */
+};
+
+#define ITEM_LIST_MODEL_TYPE		(item_list_model_get_type ())
+#define ITEM_LIST_MODEL(obj)		(G_TYPE_CHECK_INSTANCE_CAST ((obj), ITEM_LIST_MODEL_TYPE, ItemListModel))
+#define ITEM_LIST_MODEL_CLASS(klass)	(G_TYPE_CHECK_CLASS_CAST ((klass), ITEM_LIST_MODEL_TYPE, ItemListModelClass))
+#define IS_ITEM_LIST_MODEL(obj)		(G_TYPE_CHECK_INSTANCE_TYPE ((obj), ITEM_LIST_MODEL_TYPE))
+#define IS_ITEM_LIST_MODEL_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE ((klass), ITEM_LIST_MODEL_TYPE))
+
+typedef struct ItemListModel		ItemListModel;
+typedef struct ItemListModelClass	ItemListModelClass;
+typedef struct ItemListModelPrivate	ItemListModelPrivate;
+
+struct ItemListModel
+{
+	GObject		parent;
+
+	/*< private >*/
+	ItemListModelPrivate	*priv;
+};
+
+struct ItemListModelClass
+{
+	GObjectClass parent_class;
+};
+
+GType item_list_model_get_type (void);
+
+/**
+ * Creates a new empty item list model sorted by date.
+ *
+ * @returns a new ItemListModel
+ */
+ItemListModel * item_list_model_new (void);
+
+/**
+ * Appends an item to the model. If this breaks the sort order
+ * item_list_model_sort() moves it to its sorted position.
+ *
+ * @param ilm		the model
+ * @param item		the item
+ */
+void item_list_model_add_item (ItemListModel *ilm, itemPtr item);
+
+/**
+ * Removes an item from the model.
+ *
+ * @param ilm		the model
+ * @param id		the item id
+ */
+void item_list_model_remove_item (ItemListModel *ilm, gulong id);
+
+/**
+ * Updates the row of an item with the given item fields.
+ *
+ * @param ilm		the model
+ * @param item		the item
+ */
+void item_list_model_update_item (ItemListModel *ilm, itemPtr item);
+
+/**
+ * Drops all cached rows, so they are reloaded from the DB
+ * when they are displayed the next time.
+ *
+ * @param ilm		the model
+ */
+void item_list_model_reload (ItemListModel *ilm);
+
+/**
+ * Sorts the rows if items were added out of order or changed
+ * since the last sorting.
+ *
+ * @param ilm		the model
+ */
+void item_list_model_sort (ItemListModel *ilm);
+
+/**
+ * Checks whether an item is in the model.
+ *
+ * @param ilm		the model
+ * @param id		the item id
+ *
+ * @returns TRUE if the item is listed
+ */
+gboolean item_list_model_contains_id (ItemListModel *ilm, gulong id);
+
+/**
+ * Returns the iter of the row of an item.
+ *
+ * @param ilm		the model
+ * @param id		the item id
+ * @param iter		the iter to set
+ *
+ * @returns TRUE if the item is listed
+ */
+gboolean item_list_model_get_iter_by_id (ItemListModel *ilm, gulong id, GtkTreeIter *iter);
+
+/**
+ * Returns the item id of a row. Unlike gtk_tree_model_get() this
+ * never loads the row from the DB.
+ *
+ * @param ilm		the model
+ * @param iter		the row
+ *
+ * @returns the item id
+ */
+gulong item_list_model_get_id (ItemListModel *ilm, GtkTreeIter *iter);
+
+/**
+ * Returns the read state of a row.
+ *
+ * @param ilm		the model
+ * @param iter		the row
+ *
+ * @returns TRUE if the item is read
+ */
+gboolean item_list_model_get_read_status (ItemListModel *ilm, GtkTreeIter *iter);
+
+G_END_DECLS
+
+#endif
@@ -42,6 +42,7 @@
 #include "social.h"
 #include "ui/browser_tabs.h"
 #include "ui/icons.h"
+#include "ui/item_list_model.h"
 #include "ui/liferea_shell.h"
 #include "ui/popup_menu.h"
 #include "ui/ui_common.h"
@@ -53,29 +54,16 @@
  * 1.) Mass-adding items to a sorting enabled tree store.
  * 2.) Mass-loading items to an attached tree store.
  *
- * To avoid both problems we merge against a visible tree store only for single
+ * To avoid both problems we merge against a visible model only for single
  * items that are added/removed by background updates and load complete feeds or
- * collections of feeds only by adding items to a new unattached tree store.
+ * collections of feeds only by adding items to a new unattached model.
+ *
+ * The model (see item_list_model.c) only keeps the item ids and loads the
+ * column values of the visible rows from the DB. For this to work the tree
+ * view is in fixed height mode, otherwise it would request all rows to
+ * measure them.
  */
 
-/** Enumeration of the columns in the itemstore. */
-enum is_columns {
-	IS_TIME,		/**< Time of item creation */
-	IS_TIME_STR,		/**< Time of item creation as a string*/
-	IS_LABEL,		/**< Displayed name */
-	IS_STATEICON,		/**< Pixbuf reference to the item's state icon */
-	IS_NR,			/**< Item id, to lookup item ptr from parent feed */
-	IS_PARENT,		/**< Parent node pointer */
-	IS_FAVICON,		/**< Pixbuf reference to the item's feed's icon */
-	IS_ENCICON,		/**< Pixbuf reference to the item's enclosure icon */
-	IS_ENCLOSURE,		/**< Flag whether enclosure is attached or not */
-	IS_SOURCE,		/**< Source node pointer */
-	IS_STATE,		/**< Original item state (unread, flagged...) for sorting */
-	ITEMSTORE_UNREAD,	/**< Flag whether "unread" icon is to be shown */
-	ITEMSTORE_ALIGN,        /**< How to align title (RTL support) */
-	ITEMSTORE_LEN		/**< Number of columns in the itemstore */
-};
-
 typedef enum {
 	DEFAULT,
 	INTERNAL,
@@ -124,10 +112,8 @@ launch_item_selected (open_link_target_type open_link_target)
 struct ItemListViewPrivate {
 	GtkTreeView	*treeview;
 	
-	GHashTable 	*item_id_to_iter;	/**< hash table used for fast item id->tree iter lookup */
-
 	gboolean	batch_mode;		/**< TRUE if we are in batch adding mode */
-	GtkTreeStore	*batch_itemstore;	/**< GtkTreeStore prepared unattached and to be set on update() */
+	ItemListModel	*batch_model;		/**< model prepared unattached and to be set on update() */
 };
 
 static GObjectClass *parent_class = NULL;
@@ -139,10 +125,8 @@ item_list_view_finalize (GObject *object)
 {
 	ItemListViewPrivate *priv = ITEM_LIST_VIEW_GET_PRIVATE (object);
 
-	if (priv->item_id_to_iter)
-		g_hash_table_destroy (priv->item_id_to_iter);
-	if (priv->batch_itemstore)
-		g_object_unref (priv->batch_itemstore);
+	if (priv->batch_model)
+		g_object_unref (priv->batch_model);
 
 	G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -161,65 +145,32 @@ item_list_view_class_init (ItemListViewClass *klass)
 
 /* helper functions for item <-> iter conversion */
 
+/* Returns the model items are added to: the unattached one in batch mode */
+static ItemListModel *
+item_list_view_get_model (ItemListView *ilv)
+{
+	if (ilv->priv->batch_mode)
+		return ilv->priv->batch_model;
+
+	return ITEM_LIST_MODEL (gtk_tree_view_get_model (ilv->priv->treeview));
+}
+
 gboolean
 item_list_view_contains_id (ItemListView *ilv, gulong id)
 {
-	return (NULL != g_hash_table_lookup (ilv->priv->item_id_to_iter, GUINT_TO_POINTER (id)));
+	return item_list_model_contains_id (item_list_view_get_model (ilv), id);
 }
 
 static gulong
 item_list_view_iter_to_id (ItemListView *ilv, GtkTreeIter *iter)
 {
-	gulong	id = 0;
-	
-	gtk_tree_model_get (gtk_tree_view_get_model (ilv->priv->treeview), iter, IS_NR, &id, -1);
-	return id;
+	return item_list_model_get_id (ITEM_LIST_MODEL (gtk_tree_view_get_model (ilv->priv->treeview)), iter);
 }
 
 static gboolean
 item_list_view_id_to_iter (ItemListView *ilv, gulong id, GtkTreeIter *iter)
 {
-	GtkTreeIter *old_iter;
-
-	old_iter = g_hash_table_lookup (ilv->priv->item_id_to_iter, GUINT_TO_POINTER (id));
-	if (!old_iter)
-		return FALSE;
-	
-	*iter = *old_iter;
-	return TRUE;
-}
-
-static gint
-item_list_view_date_sort_func (GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpointer user_data)
-{
-	guint64	timea, timeb;
-	double	diff;
-
-	gtk_tree_model_get (model, a, IS_TIME, &timea, -1);
-	gtk_tree_model_get (model, b, IS_TIME, &timeb, -1);
-	diff = difftime ((time_t)timeb, (time_t)timea);
-	
-	if (diff < 0)
-		return 1;
-		
-	if (diff > 0)
-		return -1;
-	
-	return 0;
-}
-
-static gint
-item_list_view_favicon_sort_func (GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpointer user_data)
-{
-	nodePtr	node1, node2;
-	
-	gtk_tree_model_get (model, a, IS_SOURCE, &node1, -1);
-	gtk_tree_model_get (model, b, IS_SOURCE, &node2, -1);
-	
-	if (!node1->id || !node2->id)
-		return 0;
-		
-	return strcmp (node1->id, node2->id);
+	return item_list_model_get_iter_by_id (ITEM_LIST_MODEL (gtk_tree_view_get_model (ilv->priv->treeview)), id, iter);
 }
 
 void
@@ -243,33 +194,28 @@ item_list_view_set_sort_column (ItemListView *ilv, nodeViewSortType sortType, gb
 			break;
 	}
 	
-	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (gtk_tree_view_get_model (ilv->priv->treeview)),
+	/* In batch mode this sorts the model before it is attached */
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (item_list_view_get_model (ilv)),
 	                                      sortColumn, 
 	                                      sortReversed?GTK_SORT_DESCENDING:GTK_SORT_ASCENDING);
 }
 
-/**
- * Creates a GtkTreeStore to be filled with ui_itemlist_set_items
- * and to be set with ui_itemlist_set_tree_store().
- */
-static GtkTreeStore *
-item_list_view_create_tree_store (void)
-{
-	return gtk_tree_store_new (ITEMSTORE_LEN,
-	                    G_TYPE_UINT64,	/* IS_TIME */
-	                    G_TYPE_STRING, 	/* IS_TIME_STR */
-	                    G_TYPE_STRING,	/* IS_LABEL */
-	                    GDK_TYPE_PIXBUF,	/* IS_STATEICON */
-	                    G_TYPE_ULONG,	/* IS_NR */
-	                    G_TYPE_POINTER,	/* IS_PARENT */
-	                    GDK_TYPE_PIXBUF,	/* IS_FAVICON */
-	                    GDK_TYPE_PIXBUF,	/* IS_ENCICON */
-	                    G_TYPE_BOOLEAN,	/* IS_ENCLOSURE */
-	                    G_TYPE_POINTER,	/* IS_SOURCE */
-	                    G_TYPE_UINT,	/* IS_STATE */
-			    G_TYPE_INT,		/* ITEMSTORE_UNREAD */
-			    G_TYPE_FLOAT        /* ITEMSTORE_ALIGN */
-	);
+/* Creates an empty model with the sorting of the current one */
+static ItemListModel *
+item_list_view_create_model (ItemListView *ilv)
+{
+	ItemListModel	*model;
+	GtkTreeModel	*current;
+	gint		sortColumn;
+	GtkSortType	sortType;
+
+	model = item_list_model_new ();
+
+	current = gtk_tree_view_get_model (ilv->priv->treeview);
+	if (current && gtk_tree_sortable_get_sort_column_id (GTK_TREE_SORTABLE (current), &sortColumn, &sortType))
+		gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (model), sortColumn, sortType);
+
+	return model;
 }
 
 static void
@@ -324,29 +270,28 @@ itemlist_sort_column_changed_cb (GtkTreeSortable *treesortable, gpointer user_da
 }
 
 /**
- * Sets a GtkTreeView to the active GtkTreeView.
+ * Sets the model of the GtkTreeView, the view takes ownership.
  */
 static void
-item_list_view_set_tree_store (ItemListView *ilv, GtkTreeStore *itemstore)
+item_list_view_set_model (ItemListView *ilv, ItemListModel *itemModel)
 {
 	GtkTreeModel    	*model;
 	GtkTreeSelection	*select;
 
-	/* drop old tree store */
+	/* drop old model */
 	model = gtk_tree_view_get_model (ilv->priv->treeview);
 	gtk_tree_view_set_model (ilv->priv->treeview, NULL);
 	if (model)
 		g_object_unref (model);
 	
-	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (itemstore), IS_TIME, item_list_view_date_sort_func, NULL, NULL);
-	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (itemstore), IS_SOURCE, item_list_view_favicon_sort_func, NULL, NULL);
-	g_signal_connect (G_OBJECT (itemstore), "sort-column-changed", G_CALLBACK (itemlist_sort_column_changed_cb), NULL);
+	g_signal_connect (G_OBJECT (itemModel), "sort-column-changed", G_CALLBACK (itemlist_sort_column_changed_cb), NULL);
 	
-	gtk_tree_view_set_model (ilv->priv->treeview, GTK_TREE_MODEL (itemstore));
+	gtk_tree_view_set_model (ilv->priv->treeview, GTK_TREE_MODEL (itemModel));
 
 	/* Setup the selection handler */
 	select = gtk_tree_view_get_selection (ilv->priv->treeview);
 	gtk_tree_selection_set_mode (select, GTK_SELECTION_SINGLE);
+	g_signal_handlers_disconnect_by_func (G_OBJECT (select), G_CALLBACK (on_itemlist_selection_changed), ilv);
 	g_signal_connect (G_OBJECT (select), "changed",
 	                  G_CALLBACK (on_itemlist_selection_changed), ilv);
 }
@@ -354,34 +299,29 @@ item_list_view_set_tree_store (ItemListView *ilv, GtkTreeStore *itemstore)
 void
 item_list_view_remove_item (ItemListView *ilv, itemPtr item)
 {
-	GtkTreeIter	*iter;
+	GtkTreeIter	iter;
 
 	g_assert (NULL != item);
-	iter = g_hash_table_lookup (ilv->priv->item_id_to_iter, GUINT_TO_POINTER (item->id));
-	if (iter) {
+	if (item_list_view_id_to_iter (ilv, item->id, &iter)) {
 		/* Using the GtkTreeIter check if it is currently selected. If yes,
 		   scroll down by one in the sorted GtkTreeView to ensure something
 		   is selected after removing the GtkTreeIter */
-		if (gtk_tree_selection_iter_is_selected (gtk_tree_view_get_selection (ilv->priv->treeview), iter))
+		if (gtk_tree_selection_iter_is_selected (gtk_tree_view_get_selection (ilv->priv->treeview), &iter))
 			ui_common_treeview_move_cursor (ilv->priv->treeview, 1);
 	
-		gtk_tree_store_remove (GTK_TREE_STORE (gtk_tree_view_get_model (ilv->priv->treeview)), iter);
-		g_hash_table_remove (ilv->priv->item_id_to_iter, GUINT_TO_POINTER (item->id));
+		item_list_model_remove_item (ITEM_LIST_MODEL (gtk_tree_view_get_model (ilv->priv->treeview)), item->id);
 	} else {
 		g_warning ("Fatal: item to be removed not found in iter lookup hash!");
 	}
 }
 
-/* cleans up the item list, sets up the iter hash when called for the first time */
+/* cleans up the item list and prepares a model for batch adding */
 void
 item_list_view_clear (ItemListView *ilv)
 {
 	GtkAdjustment		*adj;
-	GtkTreeStore		*itemstore;
 	GtkTreeSelection	*select;
 
-	itemstore = GTK_TREE_STORE (gtk_tree_view_get_model (ilv->priv->treeview));
-
 	/* unselecting all items is important to remove items
 	   whose removal is deferred until unselecting */
 	select = gtk_tree_view_get_selection (ilv->priv->treeview);
@@ -394,94 +334,28 @@ item_list_view_clear (ItemListView *ilv)
 	/* Disconnect signal handler to be safe */
 	g_signal_handlers_disconnect_by_func (G_OBJECT (select), G_CALLBACK (on_itemlist_selection_changed), ilv);
 
-	if (itemstore)
-		gtk_tree_store_clear (itemstore);
-	if (ilv->priv->item_id_to_iter)
-		g_hash_table_destroy (ilv->priv->item_id_to_iter);
-	
-	ilv->priv->item_id_to_iter = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
-	
 	/* enable batch mode for following item adds */
+	if (ilv->priv->batch_model)
+		g_object_unref (ilv->priv->batch_model);
+	ilv->priv->batch_model = item_list_view_create_model (ilv);
 	ilv->priv->batch_mode = TRUE;
-	ilv->priv->batch_itemstore = item_list_view_create_tree_store ();
-}
 
-static gfloat
-item_list_title_alignment (gchar *title)
-{
-	if (!title || strlen(title) == 0)
-		return 0.;
-
-	/* debug5 (DEBUG_HTML, "title ***%s*** first bytes %02hhx%02hhx%02hhx pango %d",
-		title, title[0], title[1], title[2], pango_find_base_dir (title, -1)); */
-	int txt_direction = pango_find_base_dir (title, -1);
-  	int app_direction = gtk_widget_get_default_direction ();
-	if ((txt_direction == PANGO_DIRECTION_LTR &&
-	     app_direction == GTK_TEXT_DIR_LTR) ||
-	    (txt_direction == PANGO_DIRECTION_RTL &&
-	     app_direction == GTK_TEXT_DIR_RTL))
-		return 0.; /* same direction, regular ("left") alignment */
-	else
-		return 1.;
+	/* Replacing the model is cheaper than removing all rows */
+	item_list_view_set_model (ilv, item_list_view_create_model (ilv));
 }
 
 void
 item_list_view_update_item (ItemListView *ilv, itemPtr item)
 {
-	GtkTreeStore	*itemstore;
-	GtkTreeIter	iter;
-	gchar		*title, *time_str;
-	const GdkPixbuf	*state_icon;
-	
-	if (!item_list_view_id_to_iter (ilv, item->id, &iter))
-		return;
-	
-	time_str = (0 != item->time) ? date_format ((time_t)item->time, NULL) : g_strdup ("");
-
-	title = item->title && strlen (item->title) ? item->title : _("*** No title ***");
-	title = g_strstrip (g_strdup (title));
-
-	state_icon = item->flagStatus ? icon_get (ICON_FLAG) :
-	             !item->readStatus ? icon_get (ICON_UNREAD) :
-		     NULL;
-
-	if (ilv->priv->batch_mode)
-		itemstore = ilv->priv->batch_itemstore;
-	else
-		itemstore = GTK_TREE_STORE (gtk_tree_view_get_model (ilv->priv->treeview));
-	gtk_tree_store_set (itemstore,
-	                    &iter,
-		            IS_LABEL, title,
-			    IS_TIME_STR, time_str,
-			    IS_STATEICON, state_icon,
-			    ITEMSTORE_UNREAD, item->readStatus ? PANGO_WEIGHT_NORMAL : PANGO_WEIGHT_BOLD,
-			    ITEMSTORE_ALIGN, item_list_title_alignment (title),
-			    -1);
-
-	g_free (time_str);
-	g_free (title);
-}
-
-static void
-item_list_view_update_item_foreach (gpointer key,
-                                    gpointer value,
-                                    gpointer user_data)
-{
-	itemPtr 	item;
-	
-	item = item_load (GPOINTER_TO_UINT (key) /* id */);
-	if (!item)
-		return;
-
-	item_list_view_update_item (ITEM_LIST_VIEW (user_data), item);
-	
-	item_unload (item);
+	item_list_model_update_item (item_list_view_get_model (ilv), item);
 }
 
 void 
 item_list_view_update_all_items (ItemListView *ilv) 
 {
-	g_hash_table_foreach (ilv->priv->item_id_to_iter, item_list_view_update_item_foreach, (gpointer)ilv);
+	/* rows are reloaded from the DB when redrawn */
+	item_list_model_reload (item_list_view_get_model (ilv));
+	gtk_widget_queue_draw (GTK_WIDGET (ilv->priv->treeview));
 }
 
 void
@@ -491,11 +365,14 @@ item_list_view_update (ItemListView *ilv, gboolean hasEnclosures)
 	gtk_tree_view_column_set_visible (gtk_tree_view_get_column (ilv->priv->treeview, 1), hasEnclosures);
 
 	if (ilv->priv->batch_mode) {
-		item_list_view_set_tree_store (ilv, ilv->priv->batch_itemstore);
+		item_list_model_sort (ilv->priv->batch_model);
 		ilv->priv->batch_mode = FALSE;
+		item_list_view_set_model (ilv, ilv->priv->batch_model);
+		ilv->priv->batch_model = NULL;
 	} else {
-		/* Nothing to do in non-batch mode as items were added
-		   and updated one-by-one in ui_itemlist_add_item() */
+		/* Items were added and updated one-by-one in
+		   item_list_view_add_item(), move them into place */
+		item_list_model_sort (item_list_view_get_model (ilv));
 	}
 }
 
@@ -662,7 +539,35 @@ static void
 item_list_view_init (ItemListView *ilv)
 {
 	ilv->priv = ITEM_LIST_VIEW_GET_PRIVATE (ilv);
-	ilv->priv->item_id_to_iter = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+}
+
+/* Fixed height mode needs fixed width columns */
+static void
+item_list_view_set_fixed_width (GtkTreeViewColumn *column, GtkCellRenderer *renderer, gint width)
+{
+	gint xpad = 0;
+
+	gtk_cell_renderer_get_padding (renderer, &xpad, NULL);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, width + 2 * xpad);
+}
+
+/* Returns the width needed for the longest date format */
+static gint
+item_list_view_get_date_width (GtkWidget *widget, GtkCellRenderer *renderer)
+{
+	time_t	now = time (NULL);
+	gint	days[] = { 0, 1, 3, 400 };	/* today, yesterday, weekday and full date */
+	gint	width = 0;
+	guint	i;
+
+	for (i = 0; i < G_N_ELEMENTS (days); i++) {
+		gchar *date = date_format (now - days[i] * 24 * 60 * 60, NULL);
+		width = MAX (width, get_cell_renderer_width (widget, renderer, date, PANGO_WEIGHT_BOLD));
+		g_free (date);
+	}
+
+	return width;
 }
 
 ItemListView *
@@ -672,6 +577,7 @@ item_list_view_create (GtkWidget *window)
 	GtkCellRenderer		*renderer;
 	GtkTreeViewColumn 	*column, *headline_column;
 	GtkWidget 		*ilscrolledwindow;
+	gint			iconWidth = 16;
 
 	ilv = g_object_new (ITEM_LIST_VIEW_TYPE, NULL);
 		
@@ -688,15 +594,19 @@ item_list_view_create (GtkWidget *window)
 	
 	g_object_set_data (G_OBJECT (window), "itemlist", ilv->priv->treeview);
 
-	item_list_view_set_tree_store (ilv, item_list_view_create_tree_store ());
+	item_list_view_set_model (ilv, item_list_model_new ());
+
+	gtk_icon_size_lookup (GTK_ICON_SIZE_MENU, &iconWidth, NULL);
 
 	renderer = gtk_cell_renderer_pixbuf_new ();
 	column = gtk_tree_view_column_new_with_attributes ("", renderer, "pixbuf", IS_STATEICON, NULL);
+	item_list_view_set_fixed_width (column, renderer, iconWidth);
 	gtk_tree_view_append_column (ilv->priv->treeview, column);
 	gtk_tree_view_column_set_sort_column_id (column, IS_STATE);	
 	
 	renderer = gtk_cell_renderer_pixbuf_new ();
 	column = gtk_tree_view_column_new_with_attributes ("", renderer, "pixbuf", IS_ENCICON, NULL);
+	item_list_view_set_fixed_width (column, renderer, iconWidth);
 	gtk_tree_view_append_column (ilv->priv->treeview, column);
 
 	renderer = gtk_cell_renderer_text_new ();
@@ -704,12 +614,14 @@ item_list_view_create (GtkWidget *window)
 	                                                   "text", IS_TIME_STR,
 							   "weight", ITEMSTORE_UNREAD,
 							   NULL);
+	item_list_view_set_fixed_width (column, renderer, item_list_view_get_date_width (GTK_WIDGET (ilv->priv->treeview), renderer));
 	gtk_tree_view_append_column (ilv->priv->treeview, column);
 	gtk_tree_view_column_set_sort_column_id(column, IS_TIME);
 	g_object_set (column, "resizable", TRUE, NULL);
 	
 	renderer = gtk_cell_renderer_pixbuf_new ();
 	column = gtk_tree_view_column_new_with_attributes ("", renderer, "pixbuf", IS_FAVICON, NULL);
+	item_list_view_set_fixed_width (column, renderer, iconWidth);
 	gtk_tree_view_column_set_sort_column_id (column, IS_SOURCE);
 	gtk_tree_view_append_column (ilv->priv->treeview, column);
 	
@@ -721,9 +633,14 @@ item_list_view_create (GtkWidget *window)
 							   NULL);
 	gtk_tree_view_append_column (ilv->priv->treeview, headline_column);
 	gtk_tree_view_column_set_sort_column_id (headline_column, IS_LABEL);
+	gtk_tree_view_column_set_sizing (headline_column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_expand (headline_column, TRUE);
 	g_object_set (headline_column, "resizable", TRUE, NULL);
 	g_object_set (renderer, "ellipsize", PANGO_ELLIPSIZE_END, NULL);
 
+	/* Only the visible rows are loaded from the DB in fixed height mode */
+	gtk_tree_view_set_fixed_height_mode (ilv->priv->treeview, TRUE);
+
 	/* And connect signals */
 	g_signal_connect (G_OBJECT (ilv->priv->treeview), "button_press_event", G_CALLBACK (on_item_list_view_button_press_event), ilv);
 	g_signal_connect (G_OBJECT (ilv->priv->treeview), "row_activated", G_CALLBACK (on_Itemlist_row_activated), ilv);
@@ -736,61 +653,14 @@ item_list_view_create (GtkWidget *window)
 	return ilv;
 }
 
-static void
-item_list_view_add_item_to_tree_store (ItemListView *ilv, GtkTreeStore *itemstore, itemPtr item)
-{
-	gint		state = 0;
-	nodePtr		node;
-	GtkTreeIter	*iter;
-	GtkTreeIter	old_iter;
-	gboolean	exists;
-		
-	if (item->flagStatus)
-		state += 2;
-	if (!item->readStatus)
-		state += 1;
-		
-	node = node_from_id (item->nodeId);
-	if(!node)
-		return;	/* comment items do cause this... maybe filtering them earlier would be a good idea... */
-		
-	exists = item_list_view_id_to_iter (ilv, item->id, &old_iter);
-	iter = &old_iter;
-	
-	if (!exists) 
-	{
-		iter = g_new0 (GtkTreeIter, 1);
-		gtk_tree_store_prepend (itemstore, iter, NULL);
-		g_hash_table_insert (ilv->priv->item_id_to_iter, GUINT_TO_POINTER (item->id), (gpointer)iter);
-	}
-
-	gtk_tree_store_set (itemstore, iter,
-		                       IS_TIME, (guint64)item->time,
-		                       IS_NR, item->id,
-				       IS_PARENT, node,
-		                       IS_FAVICON, node->icon,
-		                       IS_ENCICON, item->hasEnclosure?icon_get (ICON_ENCLOSURE):NULL,
-				       IS_ENCLOSURE, item->hasEnclosure,
-				       IS_SOURCE, node,
-				       IS_STATE, state,
-		                       -1);		                       
-}
-
 void 
 item_list_view_add_item (ItemListView *ilv, itemPtr item)
 {
-	GtkTreeStore	*itemstore;
+	if (!node_from_id (item->nodeId))
+		return;	/* comment items do cause this... maybe filtering them earlier would be a good idea... */
 
-	if (ilv->priv->batch_mode) {
-		/* either merge to new unattached GtkTreeStore */
-		item_list_view_add_item_to_tree_store (ilv, ilv->priv->batch_itemstore, item);
-	} else {
-		/* or merge to visible item store */	
-		itemstore = GTK_TREE_STORE (gtk_tree_view_get_model (ilv->priv->treeview));
-		item_list_view_add_item_to_tree_store (ilv, itemstore, item);
-	}
-	
-	item_list_view_update_item (ilv, item);
+	/* either merge to new unattached model or to the visible one */
+	item_list_model_add_item (item_list_view_get_model (ilv), item);
 }
 
 void
@@ -932,11 +802,14 @@ item_list_view_find_unread_item (ItemListView *ilv, gulong startId)
 		valid = gtk_tree_model_get_iter_first (model, &iter);
 	
 	while (valid) {
-		itemPtr	item = item_load (item_list_view_iter_to_id (ilv, &iter));
-		if (item) {
-			if (!item->readStatus)
-				return item;
-			item_unload (item);
+		/* the read state is known from the list rows */
+		if (!item_list_model_get_read_status (ITEM_LIST_MODEL (model), &iter)) {
+			itemPtr	item = item_load (item_list_view_iter_to_id (ilv, &iter));
+			if (item) {
+				if (!item->readStatus)
+					return item;
+				item_unload (item);
+			}
 		}
 		valid = gtk_tree_model_iter_next (model, &iter);
 	}
@@ -135,6 +135,11 @@ itemview_set_displayed_node (nodePtr node)
 	/* 1. Reset view state */
 	itemview_clear ();
 
+	/* Items are loaded newest first, with the sort column set early
+	   the item list knows whether it needs to be sorted at all */
+	if (node)
+		item_list_view_set_sort_column (itemview->priv->itemListView, node->sortColumn, node->sortReversed);
+
 	/* 2. And prepare HTML view */
 	htmlview_set_displayed_node (node);
 }
@@ -199,6 +204,12 @@ itemview_select_enclosure (guint position)
 	enclosure_list_view_select (itemview->priv->enclosureView, position);
 }
 
+gboolean
+itemview_contains_id (gulong id)
+{
+	return item_list_view_contains_id (itemview->priv->itemListView, id);
+}
+
 void
 itemview_update_item (itemPtr item)
 {
@@ -266,12 +277,14 @@ itemview_update_node_info (nodePtr node)
 void
 itemview_update (void)
 {
-	item_list_view_update (itemview->priv->itemListView, itemview->priv->hasEnclosures);
-	
+	/* Set the sort column first, so a newly loaded item list
+	   is sorted once before it is shown */
 	if (itemview->priv->node) {
 		item_list_view_enable_favicon_column (itemview->priv->itemListView, NODE_TYPE (itemview->priv->node)->capabilities & NODE_CAPABILITY_SHOW_ITEM_FAVICONS);
 		item_list_view_set_sort_column (itemview->priv->itemListView, itemview->priv->node->sortColumn, itemview->priv->node->sortReversed);
 	}
+
+	item_list_view_update (itemview->priv->itemListView, itemview->priv->hasEnclosures);
 	
 	if (itemview->priv->needsHTMLViewUpdate) {
 		itemview->priv->needsHTMLViewUpdate = FALSE;
@@ -139,6 +139,17 @@ void itemview_select_item (itemPtr item);
  */
 void itemview_select_enclosure (guint position);
 
+/**
+ * itemview_contains_id:
+ *
+ * Checks if an item is currently presented by the item view.
+ *
+ * @param id	the item id
+ *
+ * @returns TRUE if the item is in the item list
+ */
+gboolean itemview_contains_id (gulong id);
+
 /**
  * itemview_update_item:
  *
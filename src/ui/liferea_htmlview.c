@@ -410,6 +410,12 @@ liferea_htmlview_handle_URL (LifereaHtmlView *htmlview, const gchar *url)
 	/* first catch all links with special URLs... */
 	if (liferea_htmlview_is_special_url (url)) {
 		if (htmlview->priv->internal) {
+
+			/* paging requests of the combined view scripts */
+			if (g_str_has_prefix (url, "liferea-more-items://")) {
+				htmlview_load_more_items (htmlview, g_str_has_suffix (url, "previous"));
+				return TRUE;
+			}
 	
 			/* it is a generic item list URI type */		
 			uriType = internalUriTypes;
@@ -493,6 +499,30 @@ liferea_htmlview_scroll (LifereaHtmlView *htmlview)
 	return (RENDERER (htmlview)->scrollPagedown) (htmlview->priv->renderWidget);
 }
 
+gboolean
+liferea_htmlview_can_execute_script (LifereaHtmlView *htmlview)
+{
+	gboolean disable_javascript;
+
+	if (!htmlview || !RENDERER (htmlview)->executeScript)
+		return FALSE;
+
+	conf_get_bool_value (DISABLE_JAVASCRIPT, &disable_javascript);
+
+	return !disable_javascript;
+}
+
+gboolean
+liferea_htmlview_execute_script (LifereaHtmlView *htmlview, const gchar *script)
+{
+	if (!liferea_htmlview_can_execute_script (htmlview))
+		return FALSE;
+
+	(RENDERER (htmlview)->executeScript) (htmlview->priv->renderWidget, script);
+
+	return TRUE;
+}
+
 void
 liferea_htmlview_do_zoom (LifereaHtmlView *htmlview, gboolean in)
 {
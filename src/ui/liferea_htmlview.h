@@ -155,6 +155,28 @@ gfloat liferea_htmlview_get_zoom (LifereaHtmlView *htmlview);
  */
 gboolean liferea_htmlview_scroll (LifereaHtmlView *htmlview);
 
+/**
+ * Checks whether scripts can be run in the given HTML view. This
+ * is not the case if the rendering widget does not support it or
+ * JavaScript is disabled in the preferences.
+ *
+ * @param htmlview	the html view
+ *
+ * @return TRUE if liferea_htmlview_execute_script() can be used
+ */
+gboolean liferea_htmlview_can_execute_script (LifereaHtmlView *htmlview);
+
+/**
+ * Runs a script in the context of the document currently displayed
+ * without reloading it.
+ *
+ * @param htmlview	the html view
+ * @param script	the JavaScript code to run
+ *
+ * @return FALSE if scripts cannot be run in this HTML view
+ */
+gboolean liferea_htmlview_execute_script (LifereaHtmlView *htmlview, const gchar *script);
+
 /**
  * Prepares a GtkMenu to be used as a context menu for the HTML view.
  *
@@ -191,6 +213,7 @@ typedef struct htmlviewImpl {
 	gboolean	(*scrollPagedown)	(GtkWidget *widget);
 	void		(*setProxy)		(const gchar *hostname, guint port, const gchar *username, const gchar *password);
 	void		(*setOffLine)		(gboolean offline);
+	void		(*executeScript)	(GtkWidget *widget, const gchar *script);
 } *htmlviewImplPtr;
 
 extern htmlviewImplPtr htmlview_get_impl(void);
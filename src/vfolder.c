@@ -158,6 +158,22 @@ vfolder_get_all_without_item_id (itemPtr item)
 	return result;
 }
 
+gboolean
+vfolder_any_with_rule (const gchar *ruleId)
+{
+	GSList	*iter, *rule;
+
+	for (iter = vfolders; iter; iter = g_slist_next (iter)) {
+		vfolderPtr vfolder = (vfolderPtr)iter->data;
+		for (rule = vfolder->itemset->rules; rule; rule = g_slist_next (rule)) {
+			if (g_str_equal (((rulePtr)rule->data)->ruleInfo->ruleId, ruleId))
+				return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
 static void
 vfolder_import (nodePtr node,
                 nodePtr parent,
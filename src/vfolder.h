@@ -81,6 +81,15 @@ GSList * vfolder_get_all_with_item_id (itemPtr item);
  */
 GSList * vfolder_get_all_without_item_id (itemPtr item);
 
+/**
+ * Checks if any search folder uses a rule of the given type.
+ *
+ * @param ruleId	the rule type id (e.g. "unread")
+ *
+ * @returns TRUE if at least one search folder has such a rule
+ */
+gboolean vfolder_any_with_rule (const gchar *ruleId);
+
 /**
  * Resets vfolder state. Drops all items from it.
  * To be called after vfolder_(add|remove)_rule().
@@ -28,6 +28,7 @@
 #include "browser.h"
 #include "conf.h"
 #include "common.h"
+#include "image_cache.h"
 #include "ui/browser_tabs.h"
 #include "ui/liferea_htmlview.h"
 
@@ -266,12 +267,19 @@ liferea_webkit_link_clicked (WebKitWebView *view,
 
 	reason = webkit_web_navigation_action_get_reason (navigation_action);
 
+	uri = webkit_network_request_get_uri (request);
+
 	/* iframes in items return WEBKIT_WEB_NAVIGATION_REASON_OTHER
-	   and shouldn't be handled as clicks                          */
-	if (reason != WEBKIT_WEB_NAVIGATION_REASON_LINK_CLICKED)
-		return FALSE;
+	   and shouldn't be handled as clicks. The only exception are
+	   the paging requests of the combined view scripts. */
+	if (reason != WEBKIT_WEB_NAVIGATION_REASON_LINK_CLICKED) {
+		if (!g_str_has_prefix (uri, "liferea-more-items://"))
+			return FALSE;
 
-	uri = webkit_network_request_get_uri (request);
+		liferea_htmlview_handle_URL (g_object_get_data (G_OBJECT (view), "htmlview"), uri);
+		webkit_web_policy_decision_ignore (policy_decision);
+		return TRUE;
+	}
 
 	if (webkit_web_navigation_action_get_button (navigation_action) == 2) { /* middle click */
 		browser_tabs_add_new (uri, uri, FALSE);
@@ -384,6 +392,70 @@ liferea_webkit_javascript_message  (WebKitWebView *view,
 	return TRUE;
 }
 
+/**
+ * WebKitWebView::resource-request-starting:
+ * A resource is about to be loaded.
+ *
+ * Item images are referenced by image cache URIs, which are
+ * mapped to the cached file or the original URL here.
+ */
+static void
+liferea_webkit_resource_request_starting (WebKitWebView *view,
+					  WebKitWebFrame *frame,
+					  WebKitWebResource *resource,
+					  WebKitNetworkRequest *request,
+					  WebKitNetworkResponse *response,
+					  gpointer user_data)
+{
+	const gchar	*uri;
+	gchar		*resolved;
+
+	uri = webkit_network_request_get_uri (request);
+	if (!g_str_has_prefix (uri, IMAGE_CACHE_SCHEME))
+		return;
+
+	resolved = image_cache_resolve_uri (uri);
+	if (resolved) {
+		webkit_network_request_set_uri (request, resolved);
+		g_free (resolved);
+	}
+}
+
+/**
+ * WebKitWebView::resource-load-finished:
+ * A resource has been loaded.
+ *
+ * Images loaded after an image cache miss are passed to the
+ * image cache, so it does not need to download them again.
+ */
+static void
+liferea_webkit_resource_load_finished (WebKitWebView *view,
+				       WebKitWebFrame *frame,
+				       WebKitWebResource *resource,
+				       gpointer user_data)
+{
+	GString	*data = webkit_web_resource_get_data (resource);
+
+	image_cache_store (webkit_web_resource_get_uri (resource),
+	                   data?data->str:NULL,
+	                   data?data->len:0,
+	                   webkit_web_resource_get_mime_type (resource));
+}
+
+/**
+ * WebKitWebView::resource-load-failed:
+ * A resource could not be loaded.
+ */
+static void
+liferea_webkit_resource_load_failed (WebKitWebView *view,
+				     WebKitWebFrame *frame,
+				     WebKitWebResource *resource,
+				     GError *error,
+				     gpointer user_data)
+{
+	image_cache_store (webkit_web_resource_get_uri (resource), NULL, 0, NULL);
+}
+
 /**
  * Initializes WebKit
  *
@@ -477,6 +549,24 @@ liferea_webkit_new (LifereaHtmlView *htmlview)
 		G_CALLBACK (webkit_create_web_view),
 		view
 	);
+	g_signal_connect (
+		view,
+		"resource-request-starting",
+		G_CALLBACK (liferea_webkit_resource_request_starting),
+		view
+	);
+	g_signal_connect (
+		view,
+		"resource-load-finished",
+		G_CALLBACK (liferea_webkit_resource_load_finished),
+		view
+	);
+	g_signal_connect (
+		view,
+		"resource-load-failed",
+		G_CALLBACK (liferea_webkit_resource_load_failed),
+		view
+	);
 
 	gtk_widget_show (GTK_WIDGET (view));
 	return scrollpane;
@@ -589,6 +679,17 @@ liferea_webkit_scroll_pagedown (GtkWidget *scrollpane)
 	return (new_value > old_value);
 }
 
+/**
+ * Run a script in the currently displayed document
+ */
+static void
+liferea_webkit_execute_script (GtkWidget *scrollpane, const gchar *script)
+{
+	WebKitWebView *view;
+	view = WEBKIT_WEB_VIEW (gtk_bin_get_child (GTK_BIN (scrollpane)));
+	webkit_web_view_execute_script (view, script);
+}
+
 static void
 liferea_webkit_set_proxy (const gchar *host, guint port, const gchar *user, const gchar *pwd)
 {
@@ -620,7 +721,8 @@ htmlviewImpl webkitImpl = {
 	.copySelection	= liferea_webkit_copy_selection,
 	.scrollPagedown	= liferea_webkit_scroll_pagedown,
 	.setProxy	= liferea_webkit_set_proxy,
-	.setOffLine	= NULL // FIXME: blocked on https://bugs.webkit.org/show_bug.cgi?id=18893
+	.setOffLine	= NULL, // FIXME: blocked on https://bugs.webkit.org/show_bug.cgi?id=18893
+	.executeScript	= liferea_webkit_execute_script
 };
 
 DECLARE_HTMLVIEW_IMPL (webkitImpl);
@@ -222,70 +222,236 @@ xhtml_is_well_formed (const gchar *data)
 	return result;
 }
 
-static GSList *dhtml_strippers = NULL;
-static GSList *unsupported_tag_strippers = NULL;
+/* Single pass HTML stripper. Instead of running one regular expression
+   per unwanted construct over the whole description we walk the markup
+   once, copy all text and harmless tags into a single output buffer and
+   drop everything that matches one of the strip rules. */
 
+static gboolean
+xhtml_strip_is_space (gchar c)
+{
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f');
+}
+
+static gboolean
+xhtml_strip_tag_is (const gchar *name, gsize len, const gchar *tag)
+{
+	return (len == strlen (tag)) && (0 == g_ascii_strncasecmp (name, tag, len));
+}
+
+/* Returns a pointer to the closing '>' of the tag starting at p or
+   NULL if the tag is not terminated. Quoted attribute values are
+   skipped so that a '>' inside them does not end the tag. */
+static const gchar *
+xhtml_strip_find_tag_end (const gchar *p)
+{
+	gchar quote = 0;
+
+	for (; *p; p++) {
+		if (quote) {
+			if (*p == quote)
+				quote = 0;
+		} else if (*p == '"' || *p == '\'') {
+			quote = *p;
+		} else if (*p == '>') {
+			return p;
+		}
+	}
+
+	return NULL;
+}
+
+/* Returns a pointer behind the end tag of the element named tag
+   following p or NULL if there is no such end tag. */
+static const gchar *
+xhtml_strip_skip_element (const gchar *p, const gchar *tag, gsize len)
+{
+	while (NULL != (p = strchr (p, '<'))) {
+		const gchar *q = p + 1;
+
+		while (xhtml_strip_is_space (*q))
+			q++;
+		if (*q == '/') {
+			q++;
+			while (xhtml_strip_is_space (*q))
+				q++;
+			if (0 == g_ascii_strncasecmp (q, tag, len) &&
+			    !g_ascii_isalnum (q[len])) {
+				q = strchr (q + len, '>');
+				return q?q + 1:NULL;
+			}
+		}
+		p++;
+	}
+
+	return NULL;
+}
+
+/* Copies the attributes of a tag (everything between the tag name and
+   the closing '>') skipping all DHTML event handlers like onload. */
+static void
+xhtml_strip_copy_attributes (GString *out, const gchar *p, const gchar *end)
+{
+	while (p < end) {
+		const gchar	*attrStart = p;
+		const gchar	*name;
+		gsize		nameLen;
+
+		while (p < end && xhtml_strip_is_space (*p))
+			p++;
+
+		name = p;
+		while (p < end && !xhtml_strip_is_space (*p) && *p != '=' && *p != '/')
+			p++;
+		nameLen = p - name;
+
+		if (nameLen == 0) {
+			/* self-closing slash or stray characters */
+			if (p < end)
+				p++;
+			g_string_append_len (out, attrStart, p - attrStart);
+			continue;
+		}
+
+		/* skip an optional value */
+		{
+			const gchar *q = p;
+			while (q < end && xhtml_strip_is_space (*q))
+				q++;
+			if (q < end && *q == '=') {
+				q++;
+				while (q < end && xhtml_strip_is_space (*q))
+					q++;
+				if (q < end && (*q == '"' || *q == '\'')) {
+					const gchar *close = memchr (q + 1, *q, end - q - 1);
+					p = close?close + 1:end;
+				} else {
+					while (q < end && !xhtml_strip_is_space (*q))
+						q++;
+					p = q;
+				}
+			}
+		}
+
+		if (nameLen > 2 && 0 == g_ascii_strncasecmp (name, "on", 2))
+			continue;	/* drop event handler including leading whitespace */
+
+		g_string_append_len (out, attrStart, p - attrStart);
+	}
+}
+
+/* Appends p to out with all '<' escaped */
 static void
-xhtml_stripper_add (GSList **strippers, const gchar *pattern)
+xhtml_strip_escape_tags (GString *out, const gchar *p)
 {
-	GError *err = NULL;
-	GRegex *expr;
-	
-	expr = g_regex_new (pattern, G_REGEX_CASELESS | G_REGEX_UNGREEDY | G_REGEX_DOTALL | G_REGEX_OPTIMIZE, 0, &err);
-	if (err) {
-		g_warning ("xhtml_strip_setup: %s\n", err->message);
-		g_error_free (err);
-		return;
+	const gchar *lt;
+
+	while (NULL != (lt = strchr (p, '<'))) {
+		g_string_append_len (out, p, lt - p);
+		g_string_append (out, "&lt;");
+		p = lt + 1;
 	}
-	*strippers = g_slist_append (*strippers, expr);
+	g_string_append (out, p);
 }
 
-static gchar *
-xhtml_strip (const gchar *html, GSList *strippers)
+gchar *
+xhtml_strip (const gchar *html, guint flags)
 {
-	gchar *result = g_strdup (html);
-	GSList *iter = strippers;
-	
-	while (iter) {
-		GError *err = NULL;
-		GRegex *expr = (GRegex *)iter->data;
-		gchar *tmp = result;
-		result = g_regex_replace (expr, tmp, -1, 0, "", 0, &err);
-		if (err) {
-			g_warning ("xhtml_strip: %s\n", err->message);
-			g_error_free (err);
-			err = NULL;
+	GString		*out;
+	const gchar	*p = html;
+
+	if (!html)
+		return NULL;
+
+	out = g_string_sized_new (strlen (html));
+
+	while (*p) {
+		const gchar	*lt, *q, *name, *end;
+		gsize		nameLen;
+		gboolean	closing = FALSE;
+
+		lt = strchr (p, '<');
+		if (!lt) {
+			g_string_append (out, p);
+			break;
+		}
+		g_string_append_len (out, p, lt - p);
+
+		q = lt + 1;
+		while (xhtml_strip_is_space (*q))
+			q++;
+		if (*q == '/') {
+			closing = TRUE;
+			q++;
+			while (xhtml_strip_is_space (*q))
+				q++;
+		}
+
+		name = q;
+		while (g_ascii_isalnum (*q))
+			q++;
+		nameLen = q - name;
+
+		/* Not a tag (e.g. comments, doctype or a literal '<') */
+		if (nameLen == 0) {
+			g_string_append_c (out, '<');
+			p = lt + 1;
+			continue;
+		}
+
+		end = xhtml_strip_find_tag_end (q);
+		if (!end) {
+			/* Unterminated tag (e.g. an unbalanced quote). Looking
+			   for the end of every following tag would scan to the
+			   end of the input again each time, so escape all the
+			   remaining '<' to keep the browser from creating tags. */
+			xhtml_strip_escape_tags (out, lt);
+			break;
+		}
+		p = end + 1;
+
+		if (flags & XHTML_STRIP_DHTML) {
+			if (xhtml_strip_tag_is (name, nameLen, "script") ||
+			    xhtml_strip_tag_is (name, nameLen, "iframe")) {
+				if (!closing && *(end - 1) != '/') {
+					p = xhtml_strip_skip_element (p, name, nameLen);
+					if (!p)
+						break;	/* unterminated, drop the rest */
+				}
+				continue;
+			}
+			if (xhtml_strip_tag_is (name, nameLen, "meta"))
+				continue;
+		}
+
+		if (flags & XHTML_STRIP_UNSUPPORTED) {
+			if (xhtml_strip_tag_is (name, nameLen, "wbr") ||
+			    xhtml_strip_tag_is (name, nameLen, "body"))
+				continue;
+		}
+
+		if (flags & XHTML_STRIP_DHTML) {
+			g_string_append_len (out, lt, q - lt);
+			xhtml_strip_copy_attributes (out, q, end);
+			g_string_append_c (out, '>');
+		} else {
+			g_string_append_len (out, lt, p - lt);
 		}
-		g_free (tmp);
-		iter = g_slist_next (iter);
 	}
 
-	return result;
+	return g_string_free (out, FALSE);
 }
 
 gchar *
 xhtml_strip_dhtml (const gchar *html)
 {
-	if (!dhtml_strippers) {
-		xhtml_stripper_add (&dhtml_strippers, "\\s+onload='[^']+'");
-		xhtml_stripper_add (&dhtml_strippers, "\\s+onload=\"[^\"]+\"");
-		xhtml_stripper_add (&dhtml_strippers, "<\\s*script\\s*>.*</\\s*script\\s*>");
-		xhtml_stripper_add (&dhtml_strippers, "<\\s*meta\\s*>.*</\\s*meta\\s*>");
-		xhtml_stripper_add (&dhtml_strippers, "<\\s*iframe[^>]*\\s*>.*</\\s*iframe\\s*>");
-	}
-	
-	return xhtml_strip (html, dhtml_strippers);
+	return xhtml_strip (html, XHTML_STRIP_DHTML);
 }
 
 gchar *
 xhtml_strip_unsupported_tags (const gchar *html)
 {
-	if (!unsupported_tag_strippers) {
-		xhtml_stripper_add(&unsupported_tag_strippers, "<\\s*/?wbr[^>]*/?\\s*>");
-		xhtml_stripper_add(&unsupported_tag_strippers, "<\\s*/?body[^>]*/?\\s*>");
-	}
-	
-	return xhtml_strip(html, unsupported_tag_strippers);
+	return xhtml_strip (html, XHTML_STRIP_UNSUPPORTED);
 }
 
 typedef struct {
@@ -348,10 +514,6 @@ unmarkupize (gchar *string, void(*parse)(gchar *string, result_buffer *buffer))
 	if (!string)
 		return NULL;
 		
-	/* only do something if there are any entities or tags */
-	if(NULL == (strpbrk (string, "&<>")))
-		return string;
-
 	buffer = g_new0 (result_buffer, 1);
 	parse (string, buffer);
 	result = buffer->data;
@@ -368,8 +530,117 @@ unmarkupize (gchar *string, void(*parse)(gchar *string, result_buffer *buffer))
  	}
 }
 
-gchar * unhtmlize (gchar * string) { return unmarkupize (string, _unhtmlize); }
-gchar * unxmlize (gchar * string) { return unmarkupize (string, _unxmlize); }
+#define MAX_ENTITY_NAME_LENGTH	32
+
+/* Decodes all entity and character references of a string
+   without tags using the libxml2 HTML entity table. Returns
+   NULL if there is a reference we cannot decode in exactly
+   the way the HTML parser would, so the caller can fall back
+   to running the parser. */
+static gchar *
+unhtmlize_entities (const gchar *string)
+{
+	GString		*result;
+	const gchar	*p = string;
+	const gchar	*amp;
+
+	/* like the HTML parser drop leading blanks */
+	while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+		p++;
+
+	result = g_string_sized_new (strlen (p));
+	while (NULL != (amp = strchr (p, '&'))) {
+		const gchar	*end;
+		gunichar	c = 0;
+
+		g_string_append_len (result, p, amp - p);
+
+		end = strchr (amp + 1, ';');
+		if (!end || end - amp - 1 > MAX_ENTITY_NAME_LENGTH)
+			goto fallback;
+
+		if (amp[1] == '#') {
+			gchar	*numEnd = NULL;
+			guint64	value = 0;
+
+			if ((amp[2] == 'x' || amp[2] == 'X') && g_ascii_isxdigit (amp[3]))
+				value = g_ascii_strtoull (amp + 3, &numEnd, 16);
+			else if (g_ascii_isdigit (amp[2]))
+				value = g_ascii_strtoull (amp + 2, &numEnd, 10);
+
+			if (numEnd != end || value > G_MAXUINT32)
+				goto fallback;
+			c = (gunichar)value;
+		} else {
+			const htmlEntityDesc	*desc;
+			gchar			name[MAX_ENTITY_NAME_LENGTH + 1];
+
+			memcpy (name, amp + 1, end - amp - 1);
+			name[end - amp - 1] = 0;
+			desc = htmlEntityLookup (BAD_CAST name);
+			if (!desc)
+				goto fallback;
+			c = desc->value;
+		}
+
+		if (c == 0 || !g_unichar_validate (c))
+			goto fallback;
+
+		g_string_append_unichar (result, c);
+		p = end + 1;
+	}
+	g_string_append (result, p);
+
+	return g_string_free (result, FALSE);
+
+fallback:
+	g_string_free (result, TRUE);
+	return NULL;
+}
+
+gchar *
+unhtmlize (gchar *string)
+{
+	const gchar	*markup;
+	gchar		*result;
+
+	if (!string)
+		return NULL;
+
+	/* Fast path: only do something if there are any entities or tags */
+	markup = strpbrk (string, "&<");
+	if (!markup)
+		return string;
+
+	/* Plain text with entities does not need a parser instance */
+	if (*markup == '&' && !strchr (markup, '<')) {
+		result = unhtmlize_entities (string);
+		if (result) {
+			if (*result) {
+				g_free (string);
+				return result;
+			}
+			g_free (result);
+			return string;
+		}
+	}
+
+	return unmarkupize (string, _unhtmlize);
+}
+
+gchar *
+unxmlize (gchar *string)
+{
+	if (!string)
+		return NULL;
+
+	/* Without any tag the XML parser finds no document element
+	   and we would return the original string anyway. */
+	if (!strchr (string, '<'))
+		return string;
+
+	return unmarkupize (string, _unxmlize);
+}
 
 #define MAX_PARSE_ERROR_LINES	10
 
@@ -77,6 +77,23 @@ gchar * xhtml_extract_from_string (const gchar *html, const gchar *nodeBase);
  */
 gchar * xhtml_extract (xmlNodePtr cur, gint xhtmlMode, const gchar *defaultBase);
 
+/** Flags for xhtml_strip() */
+typedef enum {
+	XHTML_STRIP_DHTML	= (1 << 0),	/**< remove scripts, iframes, meta tags and event handlers */
+	XHTML_STRIP_UNSUPPORTED	= (1 << 1)	/**< remove tags we cannot render (wbr, body) */
+} xhtmlStripFlags;
+
+/**
+ * Strips unwanted constructs from the given HTML string in
+ * a single pass over the input.
+ *
+ * @param html	some HTML content
+ * @param flags	xhtmlStripFlags selecting what to remove
+ *
+ * @return newly allocated stripped HTML string
+ */
+gchar * xhtml_strip (const gchar *html, guint flags);
+
 /**
  * Strips some DHTML constructs from the given HTML string.
  *